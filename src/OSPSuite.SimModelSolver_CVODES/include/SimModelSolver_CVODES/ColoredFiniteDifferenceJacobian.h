@@ -0,0 +1,66 @@
+#ifndef __ColoredFiniteDifferenceJacobian_H_
+#define __ColoredFiniteDifferenceJacobian_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolver_CVODES/SparsityPattern.h"
+
+#include <functional>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------------
+//Difference quotient approximation of a sparse jacobian df/dy (Curtis-Powell-Reid)
+//
+//Columns without a common nonzero row are structurally orthogonal and get the same color.
+//All columns of one color are perturbed at once, so the jacobian costs one RHS evaluation
+//per color instead of one per column
+//-----------------------------------------------------------------------------------------------------
+class ColoredFiniteDifferenceJacobian
+{
+private:
+	int _problemSize;
+
+	//row and column of the k-th nonzero of the pattern
+	std::vector<int> _rows;
+	std::vector<int> _columns;
+
+	//color of each column
+	std::vector<int> _columnColors;
+	int _numberOfColors;
+
+	//columns of color c: _colorColumns[_colorColumnPointers[c] .. _colorColumnPointers[c+1]-1]
+	std::vector<int> _colorColumnPointers;
+	std::vector<int> _colorColumns;
+
+	//nonzeros of color c: _colorNonZeros[_colorNonZeroPointers[c] .. _colorNonZeroPointers[c+1]-1]
+	std::vector<int> _colorNonZeroPointers;
+	std::vector<int> _colorNonZeros;
+
+	//increments actually applied (y_j + inc_j - y_j in floating point)
+	std::vector<double> _appliedIncrements;
+
+	void colorColumns(const std::vector<int> & columnPointers, const std::vector<int> & columnRows,
+		              const std::vector<int> & rowPointers, const std::vector<int> & rowColumns);
+
+public:
+	CVODES_EXPORT ColoredFiniteDifferenceJacobian();
+
+	//computes the column coloring for the given (valid) pattern in CSC or CSR format
+	CVODES_EXPORT void Init(const SparsityPattern & pattern);
+
+	CVODES_EXPORT bool IsInitialized() const;
+
+	CVODES_EXPORT int GetNumberOfColors() const;
+	CVODES_EXPORT const std::vector<int> & GetColumnColors() const;
+
+	//RHS function f(y) at fixed time and parameters
+	typedef std::function<Rhs_Return_Value(const double * y, double * ydot)> RhsFunction;
+
+	//Approximates the nonzeros of the jacobian at y with rhs(y) = fy
+	// - [IN] increments: increments[j] is the perturbation of y_j
+	// - [IN] yWork, fWork: work arrays of size problemSize
+	// - [OUT] jacobianValues: jacobianValues[k] is the value of the k-th nonzero of the pattern
+	CVODES_EXPORT Rhs_Return_Value Evaluate(const RhsFunction & rhs, const double * y, const double * fy, const double * increments,
+		                                    double * yWork, double * fWork, double * jacobianValues);
+};
+
+#endif //__ColoredFiniteDifferenceJacobian_H_
@@ -0,0 +1,169 @@
+#ifndef __ISolverCaller_CVODES_H_
+#define __ISolverCaller_CVODES_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolver_CVODES/SparsityPattern.h"
+
+enum Preconditioner_Return_Value { PRECONDITIONER_OK = 0, PRECONDITIONER_FAILED = -1, PRECONDITIONER_RECOVERABLE_ERROR = 1 };
+enum Root_Return_Value { ROOT_OK = 0, ROOT_FAILED = -1 };
+
+//-----------------------------------------------------------------------------------------------------
+//Optional CVODES specific extension of the ISolverCaller interface
+//
+//A solver caller which derives from ISolverCaller_CVODES instead of ISolverCaller can provide
+//additional information/callbacks used by SimModelSolver_CVODES (detected at runtime).
+//All methods have default implementations which switch the corresponding feature off,
+//so only the required ones have to be overridden.
+//-----------------------------------------------------------------------------------------------------
+class ISolverCaller_CVODES : public ISolverCaller
+{
+public:
+	//-------------------------------------------------------------------------------------------------
+	//Sparse direct linear solver (KLU)
+	//-------------------------------------------------------------------------------------------------
+
+	//returns true if the sparse linear solver should be used (has priority over UseBandLinearSolver)
+	virtual bool UseSparseLinearSolver() { return false; }
+
+	//Fills the structural nonzero pattern of the jacobian df/dy (CSC or CSR)
+	//Returns false if no pattern is available
+	virtual bool GetJacobianSparsityPattern(SparsityPattern & pattern) { return false; }
+
+	virtual bool IsSet_ODESparseJacFunction() { return false; }
+
+	//Calculates the nonzero values of the jacobian df/dy
+	// - [OUT] jacobianValues: jacobianValues[k] is the value of the k-th nonzero of the
+	//                         pattern returned by GetJacobianSparsityPattern
+	virtual Jacobian_Return_Value ODESparseJacFunction(double t, const double * y, const double * p, const double * fy, double * jacobianValues, void * Jac_data)
+	{
+		return JACOBIAN_FAILED;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	//Iterative (Krylov) linear solvers
+	//-------------------------------------------------------------------------------------------------
+
+	//if not set, jacobian-vector products are approximated by finite differences
+	virtual bool IsSet_ODEJacTimesVecFunction() { return false; }
+
+	//Calculates the jacobian-vector product Jv = (df/dy)*v
+	virtual Jacobian_Return_Value ODEJacTimesVecFunction(double t, const double * y, const double * p, const double * fy, const double * v, double * Jv, void * Jac_data)
+	{
+		return JACOBIAN_FAILED;
+	}
+
+	//if not set, the banded preconditioner of CVODES (CVBANDPRE) is used, built from
+	//difference quotients with the half bandwidths GetUpperHalfBandWidth/GetLowerHalfBandWidth
+	virtual bool IsSet_PreconditionerFunctions() { return false; }
+
+	//Prepares the preconditioner P which approximates the Newton matrix I-gamma*J
+	// - [IN]  jacobianOk: true if jacobian related data from a previous call can be reused
+	// - [OUT] jacobianUpdated: must be set to true if jacobian related data was recomputed
+	virtual Preconditioner_Return_Value PreconditionerSetupFunction(double t, const double * y, const double * p, const double * fy,
+		                                                            bool jacobianOk, bool & jacobianUpdated, double gamma, void * P_data)
+	{
+		return PRECONDITIONER_FAILED;
+	}
+
+	//Solves the preconditioner system P*z = r
+	// - [IN] delta: tolerance for the case of an iterative solution of P*z = r
+	// - [IN] leftPreconditioner: true for left, false for right preconditioning
+	virtual Preconditioner_Return_Value PreconditionerSolveFunction(double t, const double * y, const double * p, const double * fy,
+		                                                            const double * r, double * z, double gamma, double delta,
+		                                                            bool leftPreconditioner, void * P_data)
+	{
+		return PRECONDITIONER_FAILED;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	//Root finding (events like dosing, switches or thresholds)
+	//-------------------------------------------------------------------------------------------------
+
+	//number of root functions g_k(t,y) whose zero crossings are located by the solver (0: no root finding)
+	virtual int GetNumberOfRootFunctions() { return 0; }
+
+	//Calculates the values of all root functions
+	// - [OUT] g: g[k]=g_k(t,y), k=0..GetNumberOfRootFunctions()-1
+	virtual Root_Return_Value ODERootFunction(double t, const double * y, const double * p, double * g, void * Root_data)
+	{
+		return ROOT_FAILED;
+	}
+
+	//Fills the directions of the zero crossings to be located for each root function
+	//(+1: g_k increasing only, -1: g_k decreasing only, 0: both)
+	//Returns false if crossings in both directions should be located for all root functions
+	virtual bool GetRootDirections(int * directions) { return false; }
+
+	//-------------------------------------------------------------------------------------------------
+	//Sensitivity RHS of all sensitivity parameters in one call: ySdot_j = df/dy*yS_j + df/dp_j, j=0..Ns-1
+	//Work shared by all parameters (e.g. evaluating df/dy at (t,y)) is done once instead of Ns times.
+	//If set, it is used instead of ODESensitivityRhsFunction
+	//-------------------------------------------------------------------------------------------------
+
+	virtual bool IsSet_ODESensitivityRhsAllFunction() { return false; }
+
+	// - [IN]  yS: Ns pointers to yS_j (N values each)
+	// - [OUT] ySdot: Ns pointers to ySdot_j (N values each)
+	virtual Sensitivity_Rhs_Return_Value ODESensitivityRhsAllFunction(double t, const double * y, double * ydot, int Ns,
+		                                                              const double * const * yS, double * const * ySdot, void * f_data)
+	{
+		return SENSITIVITY_RHS_FAILED;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	//Quadratures q' = fQ(t,y) (integrals like AUC or cumulative excreted amounts)
+	//Quadratures are integrated alongside y, but do not enter the RHS function, the jacobian
+	//and the Newton system of the ODE solver
+	//-------------------------------------------------------------------------------------------------
+
+	//number of quadratures (0: no quadratures)
+	virtual int GetNumberOfQuadratures() { return 0; }
+
+	//Calculates the quadrature derivatives qdot[l]=fQ_l(t,y), l=0..GetNumberOfQuadratures()-1
+	virtual Rhs_Return_Value ODEQuadratureRhsFunction(double t, const double * y, const double * p, double * qdot, void * f_data)
+	{
+		return RHS_FAILED;
+	}
+
+	//Fills the initial values of the quadratures (default: 0)
+	virtual void GetQuadratureInitialValues(double * q0) {}
+
+	//-------------------------------------------------------------------------------------------------
+	//Adjoint sensitivities (solver option AdjointSensitivities)
+	//Gradient dG/dp of the objective G(p) = integral_{t0}^{T} g(t,y,p) dt with respect to the
+	//sensitivity parameters p (initial values are assumed not to depend on p).
+	//Only required for SimModelSolver_CVODES::ComputeAdjointGradient, not for least squares objectives
+	//-------------------------------------------------------------------------------------------------
+
+	virtual bool IsSet_ObjectiveDerivativeFunction() { return false; }
+
+	//Calculates the derivatives of the objective integrand g
+	// - [OUT] dgdy: dg/dy (N values)
+	// - [OUT] dgdp: dg/dp (Ns values)
+	virtual Rhs_Return_Value ObjectiveDerivativeFunction(double t, const double * y, const double * p, double * dgdy, double * dgdp)
+	{
+		return RHS_FAILED;
+	}
+
+	//if not set, the product is calculated from the dense jacobian (ODEJacFunction)
+	virtual bool IsSet_ODEJacTransposeTimesVecFunction() { return false; }
+
+	//Calculates the transposed jacobian-vector product JTv = (df/dy)^T*v
+	virtual Jacobian_Return_Value ODEJacTransposeTimesVecFunction(double t, const double * y, const double * p, const double * v, double * JTv, void * Jac_data)
+	{
+		return JACOBIAN_FAILED;
+	}
+
+	//if not set, the product is approximated by difference quotients (one RHS evaluation per parameter)
+	virtual bool IsSet_ODEParameterJacTransposeTimesVecFunction() { return false; }
+
+	//Calculates the transposed parameter jacobian-vector product fpTv = (df/dp)^T*v (Ns values)
+	virtual Jacobian_Return_Value ODEParameterJacTransposeTimesVecFunction(double t, const double * y, const double * p, const double * v, double * fpTv, void * Jac_data)
+	{
+		return JACOBIAN_FAILED;
+	}
+
+	virtual ~ISolverCaller_CVODES() {}
+};
+
+#endif //__ISolverCaller_CVODES_H_
@@ -0,0 +1,26 @@
+#ifndef __JacobianSparsityDetector_H_
+#define __JacobianSparsityDetector_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolver_CVODES/SparsityPattern.h"
+
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------------
+//Detects the structural nonzero pattern of the jacobian df/dy by probing the RHS function
+//
+//Each state y_j is probed separately (2 RHS evaluations per state):
+// - NaN propagation: y_j = NaN marks all f_i depending on y_j (also if df_i/dy_j is 0 at y0)
+// - finite perturbation: catches dependencies hidden from NaN (e.g. by comparisons or min/max)
+//The detected pattern is the union of both probes
+//-----------------------------------------------------------------------------------------------------
+class JacobianSparsityDetector
+{
+public:
+	//Returns false if the pattern cannot be detected (e.g. RHS fails at y0)
+	// - [OUT] pattern: detected pattern in CSC format
+	CVODES_EXPORT static bool Detect(ISolverCaller * solverCaller, double t, const std::vector<double> & y0, const double * p,
+		                             SparsityPattern & pattern);
+};
+
+#endif //__JacobianSparsityDetector_H_
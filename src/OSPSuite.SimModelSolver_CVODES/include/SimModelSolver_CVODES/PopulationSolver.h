@@ -0,0 +1,116 @@
+#ifndef __PopulationSolver_H_
+#define __PopulationSolver_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolver_CVODES/SparsityPattern.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class SimModelSolver_CVODES;
+
+//-----------------------------------------------------------------------------------------------------
+//Creates the model instances (solver callers) for the population solver
+//
+//One instance is created per worker thread and reused for all individuals solved by that thread,
+//so instances must not share mutable state
+//-----------------------------------------------------------------------------------------------------
+class IPopulationModelFactory
+{
+public:
+	virtual ISolverCaller * CreateSolverCaller() = 0;
+
+	//Applies the parameter set of the next individual to a model instance created by CreateSolverCaller.
+	//Called concurrently by all worker threads (each for its own model instance), so it must be thread safe.
+	//The jacobian sparsity pattern must not depend on the parameter values (the solver setup of the
+	//first individual of a worker is reused)
+	virtual void SetParameterValues(ISolverCaller * solverCaller, const double * parameterValues, int numberOfParameters) = 0;
+
+	virtual void DestroySolverCaller(ISolverCaller * solverCaller) { delete solverCaller; }
+
+	virtual ~IPopulationModelFactory() {}
+};
+
+//-----------------------------------------------------------------------------------------------------
+//Solves one model for many individuals (parameter/initial value sets) concurrently
+//
+//Each worker thread owns one model instance and one SimModelSolver_CVODES instance, which is
+//initialized for its first individual and only reinitialized (ReInit) for the following ones.
+//The individuals are distributed in contiguous blocks over the workers; a worker which has
+//finished its block steals the upper half of the largest remaining block of another worker.
+//
+//Public methods are virtual, so a population solver created by the exported GetPopulationSolver
+//can be used by dynamically loading clients (like solvers created by GetSolverInterface)
+//-----------------------------------------------------------------------------------------------------
+class PopulationSolver
+{
+private:
+	struct Worker;
+
+	IPopulationModelFactory * _modelFactory;
+	int _problemSize;
+	int _numberOfThreads;
+
+	double _relTol;
+	double _absTol;
+	long _mxStep;
+	std::vector<std::pair<std::string, double> > _solverOptions;
+
+	//per thread model/solver instances (created on first use, reused by subsequent Solve calls)
+	std::vector<Worker *> _workers;
+
+	//error message of each individual of the last Solve call (empty if successful)
+	std::vector<std::string> _errorMessages;
+
+	void createWorkers();
+	void destroyWorkers();
+
+	//solves all individuals of the worker's block and steals from other workers afterwards
+	void runWorker(int workerIndex, const double * parameterValues, int numberOfParameters,
+		           const double * initialValues, const std::vector<double> & outputTimes, double * results, int * resultFlags);
+
+	int solveIndividual(Worker & worker, int individual, const double * parameterValues, int numberOfParameters,
+		                const double * initialValues, const std::vector<double> & outputTimes, double * results);
+
+	bool stealIndividuals(int workerIndex);
+
+public:
+	//numberOfThreads <= 0: number of hardware threads
+	CVODES_EXPORT PopulationSolver(IPopulationModelFactory * modelFactory, int problemSize, int numberOfThreads = 0);
+	CVODES_EXPORT virtual ~PopulationSolver();
+
+	CVODES_EXPORT virtual int GetNumberOfThreads() const;
+
+	//settings applied to every solver instance (solver defaults if not set)
+	CVODES_EXPORT virtual void SetRelTol(double relTol);
+	CVODES_EXPORT virtual void SetAbsTol(double absTol);
+	CVODES_EXPORT virtual void SetMxStep(long mxStep);
+
+	//solver option (see SimModelSolver_CVODES::SetOption); solver instances use one OpenMP thread
+	//unless the option NumberOfThreads is set explicitly
+	CVODES_EXPORT virtual void SetOption(const std::string & name, double value);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Solves the model for all individuals, starting at outputTimes[0]
+	// - [IN]  parameterValues: numberOfIndividuals x numberOfParameters (row-major)
+	// - [IN]  initialValues: numberOfIndividuals x problemSize (row-major)
+	// - [IN]  outputTimes: increasing time points; the first one is the initial time
+	// - [OUT] results: numberOfIndividuals x outputTimes.size() x problemSize (row-major),
+	//                  results[(individual * outputTimes.size() + k) * problemSize + i] = y_i(outputTimes[k])
+	// - [OUT] resultFlags: one per individual; 0 if successful, positive if a recoverable error occurred,
+	//                      negative otherwise (see GetErrorMessage). Results after a failure are NaN
+	//Returns the number of individuals which were not solved successfully
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT virtual int Solve(int numberOfIndividuals, const double * parameterValues, int numberOfParameters,
+		                            const double * initialValues, const std::vector<double> & outputTimes,
+		                            double * results, int * resultFlags);
+
+	//error message of an individual of the last Solve call
+	CVODES_EXPORT virtual std::string GetErrorMessage(int individual) const;
+};
+
+//DLL export: creates a population solver (to be deleted by the caller)
+extern "C" CVODES_EXPORT PopulationSolver * GetPopulationSolver(IPopulationModelFactory * modelFactory, int problemSize, int numberOfThreads);
+
+#endif //__PopulationSolver_H_
@@ -6,12 +6,25 @@
 #endif
 
 #include "cvodes/cvodes.h"
+#include "cvodes/cvodes_bandpre.h"
 #include "sunlinsol/sunlinsol_dense.h"
 #include "sunlinsol/sunlinsol_band.h"
+#include "sunlinsol/sunlinsol_spgmr.h"
+#include "sunlinsol/sunlinsol_spbcgs.h"
+#include "sunlinsol/sunlinsol_sptfqmr.h"
+#include "sunmatrix/sunmatrix_sparse.h"
 #include "nvector/nvector_serial.h"
 
+#ifdef CVODES_WITH_KLU
+#include "sunlinsol/sunlinsol_klu.h"
+#endif
+
 #include "SimModelSolverBase/SimModelSolverBase.h"
 #include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolver_CVODES/ISolverCaller_CVODES.h"
+#include "SimModelSolver_CVODES/ColoredFiniteDifferenceJacobian.h"
+#include "SimModelSolver_CVODES/JacobianSparsityDetector.h"
+#include "SimModelSolver_CVODES/SolverInstrumentation.h"
 
 #ifdef _WINDOWS
 #define CVODES_EXPORT __declspec(dllexport)
@@ -27,7 +40,67 @@ class UserData;
 
 class SimModelSolver_CVODES : public SimModelSolverBase
 {
+public:
+	//linear solver used within the Newton iteration
+	// - LS_DIRECT: dense, band or sparse direct solver (as requested by the solver caller)
+	// - LS_SPGMR, LS_SPBCGS, LS_SPTFQMR: matrix-free Krylov solvers
+	enum LINEAR_SOLVER { LS_DIRECT = 0, LS_SPGMR = 1, LS_SPBCGS = 2, LS_SPTFQMR = 3 };
+
+	//checkpointing of the forward run for adjoint sensitivities (see GetAdjointStatistics)
+	struct AdjointStatistics
+	{
+		//integration steps between two checkpoints
+		long CheckpointSteps;
+		long NumberOfCheckpoints;
+		//estimated memory of the checkpoints and of the interpolation data of one checkpoint interval (bytes)
+		double EstimatedMemory;
+		//true if the estimated memory exceeds the solver option AdjointMemoryBudget
+		bool MemoryBudgetExceeded;
+		//RHS evaluations of the forward run and of its recomputation between the checkpoints
+		//during the backward solves (recomputation overhead)
+		long ForwardRhsEvaluations;
+		long RecomputationRhsEvaluations;
+	};
+
+	//work counters of CVODES (see GetSolverStatistics)
+	struct SolverStatistics
+	{
+		//internal steps, RHS evaluations (without those of the linear solver) and root function evaluations
+		long Steps;
+		long RhsEvaluations;
+		long RootFunctionEvaluations;
+		//local error test failures and nonlinear (Newton) iterations/convergence failures
+		long ErrorTestFailures;
+		long NonlinearIterations;
+		long NonlinearConvergenceFailures;
+		//linear solver setups (jacobian/preconditioner updates), jacobian evaluations and
+		//RHS evaluations of the linear solver (difference quotient jacobian or jacobian-vector products)
+		long LinearSolverSetups;
+		long JacobianEvaluations;
+		long LinearSolverRhsEvaluations;
+		//Krylov solvers only
+		long LinearIterations;
+		long LinearConvergenceFailures;
+		long JacobianTimesVectorEvaluations;
+		long PreconditionerEvaluations;
+		//step size and order of the last step and of the next one
+		double LastStepSize;
+		double CurrentStepSize;
+		int LastOrder;
+		int CurrentOrder;
+		//forward sensitivities (0 without): sensitivity RHS evaluations, RHS evaluations of the difference
+		//quotient sensitivity RHS, and error test failures, linear solver setups and nonlinear iterations/
+		//convergence failures of the sensitivity corrector (staggered methods)
+		long SensitivityRhsEvaluations;
+		long RhsEvaluationsForSensitivities;
+		long SensitivityErrorTestFailures;
+		long SensitivityLinearSolverSetups;
+		long SensitivityNonlinearIterations;
+		long SensitivityNonlinearConvergenceFailures;
+	};
+
 private:
+	enum MATRIX_TYPE { MATRIX_DENSE, MATRIX_BAND, MATRIX_SPARSE };
 
 	//type of linear multistep method to be used (ADAMS or BDF)
 	int _lmm;
@@ -57,8 +130,22 @@ private:
 	long _step;
 
 	//fill CVOde specific Solver options in datatypes required by CVODE
+	//(after CVodeCreate all options, afterwards only the changed ones)
 	void FillSolverOptions(void);
 
+	//solver options as last passed to CVODES (invalid after CVodeCreate)
+	struct PassedSolverOptions
+	{
+		bool Valid;
+		double RelTol;
+		std::vector<double> AbsTol;
+		int MaxOrd;
+		long MxStep;
+		int MxHNil;
+		double H0, HMax, HMin;
+	};
+	PassedSolverOptions _passedSolverOptions;
+
 	//Call to Rhs function
 	static int Rhs (realtype t, N_Vector y, N_Vector ydot, void * user_data);
 
@@ -66,23 +153,360 @@ private:
 	static int CVODE_JacFn(realtype t, N_Vector y, N_Vector fy, SUNMatrix J, 
 		                   void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
 
+	//Call to jacobian-vector product function for the iterative linear solvers
+	static int CVODE_JacTimesVecFn(N_Vector v, N_Vector Jv, realtype t, N_Vector y, N_Vector fy,
+		                           void *user_data, N_Vector tmp);
+
+	//Calls to preconditioner functions for the iterative linear solvers
+	static int CVODE_PrecSetupFn(realtype t, N_Vector y, N_Vector fy, booleantype jok, booleantype *jcurPtr,
+		                         realtype gamma, void *user_data);
+	static int CVODE_PrecSolveFn(realtype t, N_Vector y, N_Vector fy, N_Vector r, N_Vector z,
+		                         realtype gamma, realtype delta, int lr, void *user_data);
+
 	//Call to sensitivity RHS function
 	static int CVODE_SensitivityRhsFunction(int Ns, realtype t, N_Vector y, N_Vector ydot, int iS, 
 		                                    N_Vector yS, N_Vector ySdot, void *user_data,
 		                                    N_Vector tmp1, N_Vector tmp2);
 
+	//Call to sensitivity RHS function of all sensitivity parameters
+	static int CVODE_SensitivityRhsAllFunction(int Ns, realtype t, N_Vector y, N_Vector ydot,
+		                                       N_Vector *yS, N_Vector *ySdot, void *user_data,
+		                                       N_Vector tmp1, N_Vector tmp2);
+
+	//Calls to the functions of the backward (adjoint) problem
+	static int CVODE_AdjointRhsFn(realtype t, N_Vector y, N_Vector yB, N_Vector yBdot, void * user_dataB);
+	static int CVODE_AdjointQuadratureRhsFn(realtype t, N_Vector y, N_Vector yB, N_Vector qBdot, void * user_dataB);
+	static int CVODE_AdjointJacFn(realtype t, N_Vector y, N_Vector yB, N_Vector fyB, SUNMatrix JB,
+		                          void * user_dataB, N_Vector tmp1B, N_Vector tmp2B, N_Vector tmp3B);
+	static int CVODE_AdjointJacTimesVecFn(N_Vector vB, N_Vector JvB, realtype t, N_Vector y, N_Vector yB,
+		                                  N_Vector fyB, void * user_dataB, N_Vector tmpB);
+
+	//Calls to the functions of the second order problems (forward directional sensitivity, backward [lambda; mu])
+	static int CVODE_DirectionalSensitivityRhsFn(int Ns, realtype t, N_Vector y, N_Vector ydot, int iS,
+		                                         N_Vector yS, N_Vector ySdot, void * user_data,
+		                                         N_Vector tmp1, N_Vector tmp2);
+	static int CVODE_SecondOrderAdjointRhsFn(realtype t, N_Vector y, N_Vector * yS, N_Vector yB, N_Vector yBdot, void * user_dataB);
+	static int CVODE_SecondOrderAdjointQuadratureRhsFn(realtype t, N_Vector y, N_Vector * yS, N_Vector yB, N_Vector qBdot, void * user_dataB);
+	static int CVODE_SecondOrderAdjointJacFn(realtype t, N_Vector y, N_Vector * yS, N_Vector yB, N_Vector fyB, SUNMatrix JB,
+		                                     void * user_dataB, N_Vector tmp1B, N_Vector tmp2B, N_Vector tmp3B);
+	static int CVODE_SecondOrderAdjointJacTimesVecFn(N_Vector vB, N_Vector JvB, realtype t, N_Vector y, N_Vector * yS,
+		                                             N_Vector yB, N_Vector fyB, void * user_dataB, N_Vector tmpB);
+
+	//Call to quadrature RHS function
+	static int CVODE_QuadratureRhsFn(realtype t, N_Vector y, N_Vector qdot, void * user_data);
+
+	//Call to root function
+	static int CVODE_RootFn(realtype t, N_Vector y, realtype * gout, void * user_data);
+
 	std::string ToString (double dValue);
 
+	//common part of PerformSolverStep/PerformSolverStepContiguous
+	//sensitivitiesAvailable: true if _sensitivityValues were updated for tret
+	int performSolverStep(double tout, double * y, double & tret, SimModelSolverBase::STEP_MODE step_mode, bool & sensitivitiesAvailable);
+	const double * sensitivityData(int parameterIndex);
+
+	//---- observed output
+	//caller indices of the observed states / sensitivity parameters (empty: all)
+	std::vector<int> _observedStates;
+	std::vector<int> _observedSensitivityParameters;
+	//solver index of the observed state _observedStates[m]
+	std::vector<int> _observedSolverStates;
+	//sensitivity parameters which are retrieved and returned
+	std::vector<int> _outputSensitivityParameters;
+
+	void setupObservedOutput();
+	//copies the (observed) solution values from solver to caller order
+	void copySolution(const double * solverValues, double * y);
+	//retrieves the sensitivities of the output parameters at t into _sensitivityValues
+	int getSensitivities(double t);
+	//m-th output state (all or observed) in caller and in solver order
+	int numberOfOutputStates();
+	int outputCallerState(int m);
+	int outputSolverState(int m);
+
 	void setupSensitivityProblem();
+	//UserData::SensitivityParameters/ScalingFactors and pbar from _sensitivityParametersInitialValues
+	void setSensitivityParameterValues();
+	//sensitivity vectors and CVODES sensitivity memory of the forward sensitivity parameters
+	void setupForwardSensitivities();
+
+	//---- sensitivity switching and retrieval on demand
+	//false while the forward sensitivities are switched off (CVodeSensToggleOff)
+	bool _sensitivitiesActive;
+	//solver option SensitivitiesOnDemand: sensitivities are retrieved only by GetSensitivities/GetSensitivityValues
+	bool _sensitivitiesOnDemand;
+	//time returned by the last solver step and true if _sensitivityValues hold the output sensitivities at that time
+	double _lastOutputTime;
+	bool _sensitivitiesRetrieved;
+
+	//output sensitivities at _lastOutputTime into _sensitivityValues (if not done yet)
+	int retrieveSensitivities();
+	//copies the output sensitivities in the layout of PerformSolverStepContiguous
+	void copySensitivitiesContiguous(double * yS);
+
+	//---- solver statistics
+	//counters of the previous integration intervals of the current run (CVODES resets its counters on CVodeReInit)
+	SolverStatistics _cumulativeStatistics;
+	//sensitivity counters of the current interval before the sensitivities were switched off
+	//(not available from CVODES while switched off)
+	SolverStatistics _inactiveSensitivityStatistics;
+
+	//counters of the current integration interval
+	SolverStatistics currentSolverStatistics();
+	//adds the counters of the current integration interval to _cumulativeStatistics (before CVodeReInit/CVodeFree)
+	void accumulateSolverStatistics();
+	//adds the counters; step sizes and orders are taken from statistics
+	static void addSolverStatistics(SolverStatistics & sum, const SolverStatistics & statistics);
+	void resetSolverStatistics();
+
+	//---- root finding
+	//number of root functions of the solver caller (0: no root finding)
+	int _numberOfRootFunctions;
+
+	void setupRootFinding();
+
+	//---- sensitivity method and parameter list
+	//solver option SensitivityMethod: CV_SIMULTANEOUS, CV_STAGGERED, CV_STAGGERED1 or 0 (selected by trial integrations)
+	int _sensitivityMethod;
+	//method passed to CVODES (after automatic selection)
+	int _usedSensitivityMethod;
+	//internal steps of each trial integration of the automatic selection
+	static const int SENSITIVITY_METHOD_TRIAL_STEPS = 20;
+	//solver option SensitivityErrorControl: include the sensitivities in the local error test
+	bool _sensitivityErrorControl;
+	//parameters with forward sensitivities set by the caller (plist; empty: all)
+	std::vector<int> _sensitivityParameterList;
+	//parameter of the k-th forward sensitivity and scaling factor (pbar) passed to CVODES
+	std::vector<int> _forwardSensitivityParameters;
+	std::vector<double> _forwardSensitivityScalingFactors;
+	//index k of the forward sensitivity of each parameter (-1: no forward sensitivities)
+	std::vector<int> _forwardSensitivityIndex;
+
+	void setupSensitivityParameterList();
+	int numberOfForwardSensitivities();
+	//trial integration from the initial values with each sensitivity method; continues with the one
+	//with the least work per integrated time
+	void selectSensitivityMethod();
+	//work of the last trial integration: RHS and sensitivity RHS evaluations (per parameter), linear solves
+	//and linear solver setups, each counted as one unit (deterministic, unlike the wall time)
+	double sensitivityMethodTrialWork(int sensitivityMethod);
+	//restarts the integration (and the sensitivities from 0) at the initial values with the given sensitivity method
+	int restartIntegration(int sensitivityMethod);
+
+	//---- sensitivity RHS of all parameters
+	//solver option ParallelSensitivityRhs: per parameter sensitivity RHS of the solver caller
+	//evaluated concurrently for all parameters: blocks of parameters on NumberOfThreads threads (std::thread,
+	//independent of OpenMP), the calling thread evaluates the first block
+	bool _parallelSensitivityRhs;
+	//yS_j/ySdot_j passed to the solver caller; caller state order buffers (Ns x N) if states are reordered
+	std::vector<const double *> _sensitivityRhsYS;
+	std::vector<double *> _sensitivityRhsYSdot;
+	std::vector<double> _callerSensitivities, _callerSensitivitiesDot;
+
+	//true if all sensitivity RHS are evaluated in one call (CVSensRhsFn)
+	bool useSensitivityRhsAllFunction();
+	//per parameter sensitivity RHS of the solver caller, parameters distributed over the threads
+	Sensitivity_Rhs_Return_Value parallelSensitivityRhs(double t, const double * y, double * ydot);
+
+	//---- quadratures
+	int _numberOfQuadratures;
+	//quadrature values at the time returned by the last solver step
+	N_Vector _quadratures;
+	//include quadratures in the local error test (solver option QuadratureErrorControl)
+	bool _quadratureErrorControl;
+
+	void setupQuadratures();
+
+	//---- adjoint sensitivities
+	//solver option AdjointSensitivities: gradient by a backward solve instead of forward sensitivities
+	bool _adjointSensitivities;
+	//number of integration steps between two checkpoints of the forward solution
+	long _adjointCheckpointSteps;
+	//solver options AdjointMemoryBudget (bytes, 0: no budget) and AdjointInterpolation (CV_HERMITE or CV_POLYNOMIAL)
+	double _adjointMemoryBudget;
+	int _adjointInterpolation;
+	//number of checkpoints of the forward run
+	int _adjointNumberOfCheckpoints;
+	//RHS evaluations of the forward problem (including recomputations during backward solves)
+	long _forwardRhsEvaluations;
+	long _adjointRecomputationRhsEvaluations;
+	//index of the backward problem (-1: not created yet)
+	int _adjointProblem;
+	//time interval of the forward run since Init/ReInit
+	double _adjointStartTime, _adjointFinalTime;
+	//backward problem with the objective integrand of the solver caller (ComputeAdjointGradient)
+	//or with discrete measurement terms only (ComputeLeastSquaresObjective)
+	bool _adjointIntegralObjective;
+	//adjoint variables lambda (N) and backward quadratures dG/dp (Ns)
+	N_Vector _adjointValues;
+	N_Vector _adjointQuadratures;
+	SUNMatrix _adjointMatrix;
+	SUNLinearSolver _adjointLinearSolver;
+	//buffers of the backward callbacks
+	std::vector<double> _adjointJacobian;
+	std::vector<double *> _adjointJacobianColumns;
+	//point (t, y, p) of _adjointJacobian (reused while unchanged)
+	bool _adjointJacobianValid;
+	double _adjointJacobianTime;
+	std::vector<double> _adjointJacobianY, _adjointJacobianP;
+	std::vector<double> _adjointObjectiveDerivativeY, _adjointObjectiveDerivativeP;
+	std::vector<double> _adjointParameters, _adjointYdot, _adjointPerturbedYdot;
+
+	void setupAdjointSensitivities();
+	//gradient (and Hessian-vector product) of the objective of the solver caller by one backward solve
+	int adjointObjectiveDerivatives(const char * ERROR_SOURCE, double * gradient, double * hessianVector);
+	//copies dG/dp and (second order) d2G/dp2*u from the backward quadratures
+	void copyAdjointQuadratures(double * gradient, double * hessianVector);
+	//estimated memory per checkpoint and per stored step of a checkpoint interval (bytes)
+	void adjointMemoryRequirements(double & checkpointMemory, double & stepMemory);
+	void setupAdjointProblem();
+	//backward linear solver of the type of the forward one (dense, band or matrix-free Krylov)
+	void setupAdjointLinearSolver(int adjointBlocks);
+	void freeAdjointProblem();
+	//backward solve to tBout; lambda and dG/dp at tBout into _adjointValues/_adjointQuadratures
+	int integrateAdjointProblem(double tBout);
+	//gradient of the least squares objective by a backward solve with jumps of lambda at the measurement times
+	//(second order: with jumps of mu by the directional derivatives 2*w*s of the residual derivatives)
+	int leastSquaresAdjointGradient(const std::vector<double> & measurementTimes, const std::vector<int> & solverStates,
+		                            const std::vector<double> & residualDerivatives, const std::vector<double> & directionalResidualDerivatives,
+		                            double * gradient, double * hessianVector);
+	//(df/dy)^T*v and (df/dp)^T*v
+	Jacobian_Return_Value adjointJacobian(double t, const double * y, const double * p);
+	Jacobian_Return_Value jacobianTransposeTimesVector(double t, const double * y, const double * p, const double * v, double * JTv);
+	Jacobian_Return_Value parameterJacobianTransposeTimesVector(double t, const double * y, const double * p, const double * v, double * fpTv);
+
+	//---- second order adjoint sensitivities (Hessian-vector products)
+	//direction u of the Hessian-vector product (empty: first order adjoint only)
+	std::vector<double> _hessianDirection;
+	//forward directional sensitivity s=(dy/dp)*u (the only forward sensitivity in adjoint mode)
+	N_Vector * _directionalSensitivity;
+	//perturbed point (y+epsilon*s, p+epsilon*u) of the directional difference quotients
+	std::vector<double> _secondOrderY, _secondOrderP;
+	//buffers of the backward callbacks at the perturbed point
+	std::vector<double> _secondOrderProduct;
+	std::vector<double> _secondOrderObjectiveDerivativeY, _secondOrderObjectiveDerivativeP;
+
+	//true if the backward problem is extended by mu=d(lambda)/dp*u
+	bool useSecondOrderAdjoint();
+	void setupDirectionalSensitivity();
+	//fills _secondOrderY/_secondOrderP and returns epsilon (0: s and u are zero)
+	double directionalPerturbation(const double * y, const double * s, const double * p);
+	//RHS of [lambda; mu] and of the quadratures [dG/dp; d2G/dp2*u]
+	int secondOrderAdjointRhs(double t, const double * y, const double * s, const double * p, const double * yB, double * yBdot);
+	int secondOrderAdjointQuadratureRhs(double t, const double * y, const double * s, const double * p, const double * yB, double * qBdot);
+
+	//CVode or (with adjoint sensitivities) CVodeF which stores the checkpoints
+	int advance(double tout, double & tret, int itask);
+
+	//---- stop time schedule
+	//sorted hard stop times (e.g. dosing times) and index of the next one passed to CVodeSetStopTime
+	std::vector<double> _stopTimes;
+	size_t _nextStopTime;
+
+	//passes the first stop time after t (if any) to CVODES
+	void setNextStopTime(double t);
 
 	SUNMatrix _linearSolverMatrix;
 	SUNLinearSolver _linearSolver;
 
+	LINEAR_SOLVER _linearSolverType;
+
+	//maximum dimension of the Krylov subspace (0: CVODES default)
+	int _maxKrylovDimension;
+
+	//preconditioning of the iterative linear solvers (PREC_NONE, PREC_LEFT or PREC_RIGHT)
+	int _preconditioning;
+
+	//sets the preconditioner functions of the caller or the banded preconditioner of CVODES
+	void setupPreconditioner();
+
+	//creates and attaches the linear solver (and matrix, if any) and sets the jacobian functions
+	void setupLinearSolver();
+
+	//CVODES specific solver caller interface (NULL if the solver caller implements only ISolverCaller)
+	ISolverCaller_CVODES * _solverCallerCVODES;
+
+	//---- sparse linear solver and colored jacobian
+	//normalized jacobian pattern of the caller
+	SparsityPattern _sparseJacobianPattern;
+	//position of the k-th nonzero of the caller pattern in _sparseJacobianPattern (empty if identical)
+	std::vector<int> _sparseJacobianValueMap;
+	//buffer for the jacobian values returned by the caller (used only if _sparseJacobianValueMap is not empty)
+	std::vector<double> _sparseJacobianCallerValues;
+
+	bool useSparseLinearSolver();
+	bool isAnalyticJacobianAvailable();
+
+	//returns false if the caller provides no sparsity pattern
+	bool setupSparseJacobianPattern();
+	void setSparseMatrixPattern(SUNMatrix J);
+	Jacobian_Return_Value fillSparseJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J);
+
+	//colored difference quotient approximation of the jacobian (dense, band or sparse matrix)
+	bool _coloredJacobianEnabled;
+	bool _useColoredJacobian;
+	ColoredFiniteDifferenceJacobian _coloredJacobian;
+	//jacobian values (ordered like the nonzeros of _sparseJacobianPattern) and increments of y
+	std::vector<double> _coloredJacobianValues;
+	std::vector<double> _coloredJacobianIncrements;
+
+	Jacobian_Return_Value fillColoredJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+		                                      N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+
+	//---- jacobian sparsity detection
+	bool _jacobianSparsityDetection;
+	//true if _sparseJacobianPattern was detected (and not provided by the caller)
+	bool _jacobianPatternDetected;
+	//detected pattern, reused by subsequent initializations
+	SparsityPattern _detectedJacobianPattern;
+
+	bool detectJacobianSparsityPattern();
+
+	//selects band, sparse or dense matrix for the detected (or reordered) pattern
+	MATRIX_TYPE selectMatrixType(int & mu, int & ml);
+	bool isBandStorageEfficient(int mu, int ml);
+
+	//---- state reordering
+	//the solver integrates the states in the order _statePermutation (bandwidth reducing permutation
+	//of the jacobian pattern); all values exchanged with the caller remain in caller state order
+	bool _stateReordering;
+	//_statePermutation[i] is the caller index of the i-th solver state (empty if no reordering)
+	std::vector<int> _statePermutation;
+	//buffers for calls to the solver caller in caller state order
+	std::vector<double> _callerY, _callerYdot, _callerYS, _callerYSdot;
+	//dense jacobian of the caller (only for analytic jacobians with state reordering)
+	std::vector<double> _callerJacobian;
+	std::vector<double *> _callerJacobianColumns;
+
+	bool isStateReorderingApplicable();
+	void setupStateOrdering();
+	int callerStateIndex(int i);
+	void toCallerOrder(const double * solverValues, double * callerValues);
+	void toSolverOrder(const double * callerValues, double * solverValues);
+	Jacobian_Return_Value fillReorderedJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J);
+
+	//calls the RHS function of the solver caller (y and ydot in solver state order)
+	Rhs_Return_Value callRhs(double t, const double * y, const double * p, double * ydot);
+
 	//number of threads to be used for parallel execution (e.g. OpenMP - if enabled)
 	int _numThreads;
 	int getNumberOfThreads();
 	void setNumberOfThreads(int numberOfThreads);
 
+	//---- instrumentation
+	//solver option Instrumentation
+	bool _instrumentationEnabled;
+	//report written by Terminate (empty: none) and error of the last write (empty: successful)
+	std::string _instrumentationOutput;
+	std::string _instrumentationReportError;
+	//timings of this instance; NULL if disabled (the timers do not query the clock then)
+	SolverInstrumentation * _instrumentation;
+	//linear solver attached to CVODES which times setup and solve of _linearSolver (instrumentation only)
+	SUNLinearSolver _timedLinearSolver;
+
+	//linear solver passed to CVODES: _linearSolver or its timing wrapper
+	SUNLinearSolver attachedLinearSolver();
+
 public:
 	UserData * CVODES_UserData;
 
@@ -114,16 +538,220 @@ public:
 	// - [OUT] yS: Parameter sensitivities at time tret. yS[i][j]=dy_i/dp_j
 	//Returns:
 	// - 0 if successful
+	// - CV_ROOT_RETURN if a root of a root function was found at tret < tout (see GetRootInfo);
+	//   the integration can be continued by the next call
+	// - CV_TSTOP_RETURN if a stop time (see SetStopTimes) was reached at tret <= tout
 	// - positive value if a recoverable error occurred (e.g. max. no. of internal solver steps reached)
 	// - negative value if an unrecoverable error occurred (e.g. illegal input)
 	//-----------------------------------------------------------------------------------------------------
 	CVODES_EXPORT int PerformSolverStep(double tout, double * y, double ** yS, double & tret, SimModelSolverBase::STEP_MODE step_mode);
 
+	//-----------------------------------------------------------------------------------------------------
+	//Same as PerformSolverStep, but sensitivities are returned as one contiguous parameter-major block
+	// - [OUT] yS: Parameter sensitivities at time tret (size N*Ns). yS[j*N+i]=dy_i/dp_j
+	//             (may be NULL, e.g. if the sensitivities are accessed via GetSensitivityValues)
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int PerformSolverStepContiguous(double tout, double * y, double * yS, double & tret, SimModelSolverBase::STEP_MODE step_mode);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Read-only view (no copy) of the sensitivities dy/dp_j (N values) returned by the last
+	//PerformSolverStep/PerformSolverStepContiguous call. Valid until the next solver call.
+	//Returns NULL if not available (e.g. no sensitivities or internal state reordering active)
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT const double * GetSensitivityValues(int parameterIndex);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Sensitivities at the time tret returned by the last solver step, in the layout of PerformSolverStepContiguous
+	//(yS[j*N+i]=dy_i/dp_j). With the solver option SensitivitiesOnDemand, the solver steps do not retrieve
+	//the sensitivities from CVODES: only this function and GetSensitivityValues do (once per solver step)
+	//Returns 0 if successful, CV_NO_SENS if no forward sensitivities are calculated or if they are switched off
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int GetSensitivities(double * yS);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Switches the forward sensitivities off or on at the time tret of the last solver step (the initial time
+	//before the first step), e.g. to calculate sensitivities only after the last dose or within a measurement
+	//window. SetStopTimes stops the integration exactly at the window boundaries.
+	// - off: only the states are integrated (cost of a solve without sensitivities). Sensitivity outputs
+	//        are not written and GetSensitivityValues returns NULL
+	// - on:  the integration is restarted at tret with the sensitivities set to 0 (resetSensitivities, default)
+	//        or to their values at the time they were switched off (carried over). Carried over values
+	//        ignore the window switched off: they are not the sensitivities of the full integration
+	//Switching to the current state does nothing. Not available with adjoint sensitivities.
+	//Returns 0 if successful
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int SetSensitivitiesActive(bool active, bool resetSensitivities = true);
+	CVODES_EXPORT bool GetSensitivitiesActive();
+
+	//-----------------------------------------------------------------------------------------------------
+	//Integrates over all output times in one call (instead of one PerformSolverStep call per output time).
+	//The solution at the output times is interpolated from the integration history, so the internal
+	//steps are not shortened to hit the output times.
+	// - [IN]  outputTimes: ascending output times, not before the last returned time. Output times
+	//                      already passed by the internal integration (previous call, root inside
+	//                      the last step) are interpolated first
+	// - [OUT] y: solution (size numberOfOutputTimes*N), y[k*N+i]=y_i(outputTimes[k])
+	// - [OUT] yS: sensitivities (size numberOfOutputTimes*N*Ns), yS[(k*N+i)*Ns+j]=dy_i/dp_j(outputTimes[k])
+	//             (may be NULL)
+	// - [OUT] numberOfOutputTimesReached: number of output times filled (< numberOfOutputTimes on error)
+	// - [OUT] quadratures: quadratures (size numberOfOutputTimes*NQ), quadratures[k*NQ+l]=q_l(outputTimes[k])
+	//                      (may be NULL)
+	//Returns 0 if successful, negative value otherwise (see PerformSolverStep).
+	//Returns CV_ROOT_RETURN/CV_TSTOP_RETURN if a root/stop time was reached: all output times up to it
+	//are filled, the remaining ones can be requested by the next call
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int PerformSolverSteps(const double * outputTimes, int numberOfOutputTimes, double * y, double * yS,
+		                                 int & numberOfOutputTimesReached, double * quadratures = NULL);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Root functions which had a root at the last CV_ROOT_RETURN of PerformSolverStep/PerformSolverSteps
+	// - [OUT] rootsFound: one entry per root function of the solver caller:
+	//                     0: no root, +1: root with g_k increasing, -1: root with g_k decreasing
+	//Returns 0 if successful
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int GetRootInfo(std::vector<int> & rootsFound);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Gradient of the objective of the solver caller (see ISolverCaller_CVODES::ObjectiveDerivativeFunction)
+	//with respect to the sensitivity parameters over the interval integrated since Init/ReInit,
+	//calculated by one backward (adjoint) solve. Requires the solver option AdjointSensitivities.
+	//The cost is roughly independent of the number of sensitivity parameters.
+	// - [OUT] gradient: Ns values
+	//After the call, the forward integration can only be continued after ReInit
+	//Returns 0 if successful
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int ComputeAdjointGradient(double * gradient);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Direction u (Ns values) of the Hessian-vector products (d2G/dp2)*u. With the solver option
+	//AdjointSensitivities, the directional sensitivity s=(dy/dp)*u is integrated forward and the backward
+	//problem is extended by the second order adjoint variables mu (forward-over-adjoint), so that
+	//one forward and one backward solve return both the gradient and the Hessian-vector product.
+	//Second derivatives of the solver caller are not required: the directional derivatives of f, of the
+	//(transposed) jacobian products and of the objective derivatives along (s,u) are difference quotients.
+	//Empty vector: first order only (the default). Must be set before Init
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT void SetHessianDirection(const std::vector<double> & direction);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Gradient and Hessian-vector product of the objective of the solver caller (see ComputeAdjointGradient)
+	//with respect to the sensitivity parameters, in the direction set by SetHessianDirection
+	// - [OUT] gradient: Ns values (may be NULL)
+	// - [OUT] hessianVector: Ns values, (d2G/dp2)*u
+	//After the call, the forward integration can only be continued after ReInit
+	//Returns 0 if successful
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int ComputeAdjointHessianVectorProduct(double * gradient, double * hessianVector);
+
+	//checkpoint counts, memory and recomputation overhead of the current forward run and its backward solves
+	CVODES_EXPORT AdjointStatistics GetAdjointStatistics();
+
+	//-----------------------------------------------------------------------------------------------------
+	//Work counters, step size and order of CVODES, e.g. to tune tolerances and the linear solver
+	//GetSolverStatistics: since the last Init/ReInit (or switching the sensitivities on)
+	//GetCumulativeSolverStatistics: since Init/UpdateSensitivityParameters, summed over all ReInit calls
+	//(also after Terminate). Includes the trial integrations of the automatic sensitivity method selection
+	//Step sizes and orders are those of the current integration interval
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT SolverStatistics GetSolverStatistics();
+	CVODES_EXPORT SolverStatistics GetCumulativeSolverStatistics();
+
+	//-----------------------------------------------------------------------------------------------------
+	//Wall time and number of calls of RHS, jacobian, sensitivity RHS, linear solver and solver steps
+	//(see SolverInstrumentation). Enabled by the solver option Instrumentation or by an output file; must
+	//be set before Init. The timings are accumulated over all runs of this instance and written
+	//to the output file (".csv": CSV, JSON otherwise) by each Terminate
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT void SetInstrumentationOutput(const std::string & fileName);
+	//NULL if instrumentation is disabled
+	CVODES_EXPORT const SolverInstrumentation * GetInstrumentation();
+	//error message if the last Terminate could not write the report to the output file (empty otherwise)
+	CVODES_EXPORT std::string GetInstrumentationReportError();
+
+	//-----------------------------------------------------------------------------------------------------
+	//Weighted least squares objective sum_k sum_m w_km*(y_{i_m}(t_k)-d_km)^2 and its gradient with respect
+	//to the sensitivity parameters, e.g. for parameter estimation against observed data.
+	//Integrates from the current solver time to the last measurement time.
+	// - [IN]  measurementTimes: K ascending time points, not before the current solver time
+	// - [IN]  stateIndices: M (caller) indices of the measured states
+	// - [IN]  observedValues: d_km at [k*M+m]; NaN for missing measurements
+	// - [IN]  weights: w_km at [k*M+m] (NULL: all weights are 1)
+	// - [OUT] objective
+	// - [OUT] gradient: Ns values (NULL: objective only). Calculated from the forward sensitivities
+	//         or, with the solver option AdjointSensitivities, by one backward solve. In the latter case
+	//         the forward integration can only be continued after ReInit
+	// - [OUT] hessianVector: Ns values (NULL: not required), Hessian-vector product (d2F/dp2)*u in the direction
+	//         set by SetHessianDirection. Requires the solver option AdjointSensitivities
+	//Initial values are assumed not to depend on the sensitivity parameters.
+	//Roots and stop times before the last measurement time are passed without interrupting the calculation.
+	//Returns 0 if successful, negative value otherwise
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int ComputeLeastSquaresObjective(const std::vector<double> & measurementTimes, const std::vector<int> & stateIndices,
+		                                           const double * observedValues, const double * weights,
+		                                           double & objective, double * gradient, double * hessianVector = NULL);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Quadratures of the solver caller (see ISolverCaller_CVODES::GetNumberOfQuadratures) at the time tret
+	//returned by the last PerformSolverStep/PerformSolverStepContiguous call
+	// - [OUT] q: NQ values
+	//Quadratures are continued by ReInit
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int GetNumberOfQuadratures();
+	CVODES_EXPORT void GetQuadratures(double * q);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Hard stop times (e.g. known dosing times) which the solver must not integrate past.
+	//The solver stops exactly at each of them and returns CV_TSTOP_RETURN, so the caller can apply
+	//the event (e.g. via ReInit) at the boundary. The next stop time is set automatically afterwards
+	//and after Init/ReInit. Must be set before Init
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT void SetStopTimes(const std::vector<double> & stopTimes);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Restricts the output of PerformSolverStep/PerformSolverStepContiguous/PerformSolverSteps to the
+	//given states / sensitivity parameters (caller indices; empty vector: all, the default).
+	//The output buffers keep their size and layout, only the entries of observed states/parameters
+	//are written. Sensitivities of parameters not observed are not retrieved from CVODES at all
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT void SetObservedStates(const std::vector<int> & stateIndices);
+	CVODES_EXPORT void SetObservedSensitivityParameters(const std::vector<int> & parameterIndices);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Sensitivity parameters for which forward sensitivities are calculated (CVODES plist; empty: all).
+	//The sensitivities of the other parameters are neither calculated nor returned. The k-th sensitivity
+	//passed to ISolverCaller_CVODES::ODESensitivityRhsAllFunction belongs to parameterIndices[k].
+	//Must be set before Init (afterwards: UpdateSensitivityParameters)
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT void SetSensitivityParameterList(const std::vector<int> & parameterIndices);
+
+	//-----------------------------------------------------------------------------------------------------
+	//New sensitivity parameter values and parameter subset (see SetSensitivityParameterList) for the next
+	//solve of the same model, e.g. in an optimization loop. The scaling factors are derived from the new values.
+	//The integration is restarted at the initial time from the initial values (SetInitialValues may be
+	//called before) with all sensitivities 0. Vectors, jacobian matrix and linear solver are reused;
+	//only a changed number of forward sensitivities reallocates the sensitivity vectors.
+	// - [IN] parameterValues: Ns values
+	// - [IN] parameterIndices: parameters with forward sensitivities (empty: all; ignored with adjoint sensitivities)
+	//Returns 0 if successful
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT int UpdateSensitivityParameters(const std::vector<double> & parameterValues,
+		                                          const std::vector<int> & parameterIndices = std::vector<int>());
+
+	//sensitivity method used by CVODES (CV_SIMULTANEOUS, CV_STAGGERED or CV_STAGGERED1), e.g. after the
+	//automatic selection of the solver option SensitivityMethod
+	CVODES_EXPORT int GetSensitivityMethod();
+
+	//matrix of the direct linear solver (SUNMATRIX_DENSE, SUNMATRIX_BAND or SUNMATRIX_SPARSE), e.g. after
+	//the automatic selection of the solver option JacobianSparsityDetection. -1 for Krylov solvers or if not initialized
+	CVODES_EXPORT int GetLinearSolverMatrixType();
+
 	//-----------------------------------------------------------------------------------------------------
 	//Reinitialize DE system (e.g. in case of bigger discontinuities)
 	//New relative / absolute tolerance should be set by caller prior to ReInit (if required)
 	// - [IN] t0: continue integration from this time point
 	// - [IN] y0: new initial value at t0
+	//Sensitivities dy/dp are continued at t0 (y0 is assumed not to depend on the sensitivity parameters).
+	//Existing vectors are reused and only changed solver options are passed to CVODES
 	//Returns:
 	// - 0 if successful
 	// - positive value if a recoverable error occurred 
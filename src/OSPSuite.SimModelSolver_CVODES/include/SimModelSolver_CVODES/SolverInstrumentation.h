@@ -0,0 +1,109 @@
+#ifndef __SolverInstrumentation_H_
+#define __SolverInstrumentation_H_
+
+#include "sundials/sundials_linearsolver.h"
+
+#include <chrono>
+#include <string>
+
+#ifndef CVODES_EXPORT
+#ifdef _WINDOWS
+#define CVODES_EXPORT __declspec(dllexport)
+#endif
+#ifdef linux
+#define CVODES_EXPORT 
+#endif
+#ifdef __APPLE__
+#define CVODES_EXPORT 
+#endif
+#endif
+
+//-----------------------------------------------------------------------------------------------------
+//Wall time and number of calls of the hot paths of one solver instance (solver option Instrumentation)
+//
+//Sections are timed inclusively and may be nested: INTEGRATION (CVode calls) contains all callbacks
+//and the linear solver, SOLVER_STEP (PerformSolverStep* calls) contains INTEGRATION; the difference
+//is the overhead of the wrapper (output copy, sensitivity and quadrature retrieval).
+//Not thread safe: the callbacks of one solver instance are called sequentially
+//-----------------------------------------------------------------------------------------------------
+class SolverInstrumentation
+{
+public:
+	enum SECTION
+	{
+		RHS = 0,                 //ODE RHS (Rhs -> ODERhsFunction)
+		JACOBIAN = 1,            //jacobian (CVODE_JacFn)
+		SENSITIVITY_RHS = 2,     //sensitivity RHS (per parameter or all at once)
+		LINEAR_SOLVER_SETUP = 3, //linear solver setup (e.g. LU factorization)
+		LINEAR_SOLVE = 4,        //linear solves
+		INTEGRATION = 5,         //CVode/CVodeF calls
+		SOLVER_STEP = 6,         //PerformSolverStep, PerformSolverStepContiguous and PerformSolverSteps calls
+		NUMBER_OF_SECTIONS = 7
+	};
+
+	//-----------------------------------------------------------------------------------------------------
+	//Times one call of a section; does nothing (no clock query) if instrumentation is NULL
+	//-----------------------------------------------------------------------------------------------------
+	class ScopedTimer
+	{
+	private:
+		SolverInstrumentation * _instrumentation;
+		SECTION _section;
+		std::chrono::steady_clock::time_point _start;
+
+	public:
+		ScopedTimer(SolverInstrumentation * instrumentation, SECTION section)
+		{
+			_instrumentation = instrumentation;
+			_section = section;
+			if (_instrumentation)
+				_start = std::chrono::steady_clock::now();
+		}
+
+		~ScopedTimer()
+		{
+			if (_instrumentation)
+				_instrumentation->AddCall(_section, std::chrono::steady_clock::now() - _start);
+		}
+	};
+
+private:
+	long _numberOfCalls[NUMBER_OF_SECTIONS];
+	std::chrono::steady_clock::duration _times[NUMBER_OF_SECTIONS];
+
+public:
+	CVODES_EXPORT SolverInstrumentation();
+
+	CVODES_EXPORT void Reset();
+
+	void AddCall(SECTION section, std::chrono::steady_clock::duration time)
+	{
+		_numberOfCalls[section]++;
+		_times[section] += time;
+	}
+
+	CVODES_EXPORT long GetNumberOfCalls(SECTION section) const;
+	//wall time (s)
+	CVODES_EXPORT double GetTime(SECTION section) const;
+
+	//name of the section in the report (e.g. "rhs")
+	CVODES_EXPORT static const char * GetSectionName(SECTION section);
+
+	//-----------------------------------------------------------------------------------------------------
+	//Report with calls, total and mean time (s) of each section
+	// - CSV: header "section,calls,time_s,mean_time_s", one line per section and the line "wrapper_overhead,,time_s,"
+	// - JSON: {"sections":{"rhs":{"calls":...,"time_s":...,"mean_time_s":...},...},"wrapper_overhead_s":...}
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT std::string GetReport(bool csv) const;
+
+	//writes the report as CSV if the file name ends with ".csv", as JSON otherwise. Returns false on failure
+	CVODES_EXPORT bool WriteReport(const std::string & fileName) const;
+
+	//-----------------------------------------------------------------------------------------------------
+	//Linear solver forwarding all operations to linearSolver and timing setup and solve.
+	//Freeing the returned linear solver does not free linearSolver
+	//-----------------------------------------------------------------------------------------------------
+	CVODES_EXPORT SUNLinearSolver CreateTimedLinearSolver(SUNLinearSolver linearSolver);
+};
+
+#endif //__SolverInstrumentation_H_
@@ -0,0 +1,65 @@
+#ifndef __SparsityPattern_H_
+#define __SparsityPattern_H_
+
+#include <vector>
+
+#ifndef CVODES_EXPORT
+#ifdef _WINDOWS
+#define CVODES_EXPORT __declspec(dllexport)
+#endif
+#ifdef linux
+#define CVODES_EXPORT 
+#endif
+#ifdef __APPLE__
+#define CVODES_EXPORT 
+#endif
+#endif
+
+//-----------------------------------------------------------------------------------------------------
+//Structural nonzero pattern of a square (problemSize x problemSize) matrix in compressed format
+//
+// - CSC (compressed sparse column):
+//      IndexPointers[j] .. IndexPointers[j+1]-1 are the positions of the nonzeros of column j,
+//      IndexValues[k] is the row index of the k-th nonzero
+// - CSR (compressed sparse row): the same with rows and columns swapped
+//
+//IndexPointers has (problemSize+1) entries, IndexPointers[0]=0 and IndexPointers[problemSize]=number of nonzeros
+//-----------------------------------------------------------------------------------------------------
+class SparsityPattern
+{
+public:
+	//values correspond to the CVODES constants CSC_MAT/CSR_MAT
+	enum Format { CSC = 0, CSR = 1 };
+
+	Format PatternFormat;
+	std::vector<int> IndexPointers;
+	std::vector<int> IndexValues;
+
+	CVODES_EXPORT SparsityPattern();
+	CVODES_EXPORT SparsityPattern(int problemSize, Format format);
+
+	CVODES_EXPORT int GetProblemSize() const;
+	CVODES_EXPORT int GetNumberOfNonZeros() const;
+
+	//checks the consistency of index pointers and index values for the given problem size
+	CVODES_EXPORT bool IsValid(int problemSize) const;
+
+	//lower (max. i-j) and upper (max. j-i) half bandwidth of all nonzeros (i,j)
+	CVODES_EXPORT void GetHalfBandWidths(int & lowerHalfBandWidth, int & upperHalfBandWidth) const;
+
+	//Returns the pattern with indices sorted within each column (row) and without duplicates,
+	//extended by all diagonal entries (required for the Newton matrix I-gamma*J).
+	//valueMap[k] is the position of the k-th entry of THIS pattern in the returned one.
+	//valueMap is empty if both patterns are identical
+	CVODES_EXPORT SparsityPattern Normalized(std::vector<int> & valueMap) const;
+
+	//Returns the symmetric permutation P*A*P^T of the pattern (same format, indices not sorted)
+	//permutation[k] is the original index of the k-th state of the permuted ordering
+	CVODES_EXPORT SparsityPattern Permuted(const std::vector<int> & permutation) const;
+
+	//Bandwidth reducing permutation (reverse Cuthill-McKee on the structure of A+A^T)
+	//permutation[k] is the original index of the k-th state of the new ordering
+	CVODES_EXPORT std::vector<int> ReverseCuthillMcKee() const;
+};
+
+#endif //__SparsityPattern_H_
@@ -0,0 +1,182 @@
+#include "SimModelSolver_CVODES/ColoredFiniteDifferenceJacobian.h"
+#include <algorithm>
+
+using namespace std;
+
+ColoredFiniteDifferenceJacobian::ColoredFiniteDifferenceJacobian()
+{
+   _problemSize = 0;
+   _numberOfColors = 0;
+}
+
+bool ColoredFiniteDifferenceJacobian::IsInitialized() const
+{
+   return _problemSize > 0;
+}
+
+int ColoredFiniteDifferenceJacobian::GetNumberOfColors() const
+{
+   return _numberOfColors;
+}
+
+const vector<int> & ColoredFiniteDifferenceJacobian::GetColumnColors() const
+{
+   return _columnColors;
+}
+
+void ColoredFiniteDifferenceJacobian::Init(const SparsityPattern & pattern)
+{
+   int i, j, k;
+
+   _problemSize = pattern.GetProblemSize();
+   int nnz = pattern.GetNumberOfNonZeros();
+
+   //row and column of each nonzero
+   _rows.resize(nnz);
+   _columns.resize(nnz);
+
+   for (j = 0; j < _problemSize; j++)
+   {
+      for (k = pattern.IndexPointers[j]; k < pattern.IndexPointers[j + 1]; k++)
+      {
+         if (pattern.PatternFormat == SparsityPattern::CSC)
+         {
+            _rows[k] = pattern.IndexValues[k];
+            _columns[k] = j;
+         }
+         else
+         {
+            _rows[k] = j;
+            _columns[k] = pattern.IndexValues[k];
+         }
+      }
+   }
+
+   //column and row structure (counting sort of the nonzeros)
+   vector<int> columnPointers(_problemSize + 1, 0), rowPointers(_problemSize + 1, 0);
+   for (k = 0; k < nnz; k++)
+   {
+      columnPointers[_columns[k] + 1]++;
+      rowPointers[_rows[k] + 1]++;
+   }
+   for (i = 0; i < _problemSize; i++)
+   {
+      columnPointers[i + 1] += columnPointers[i];
+      rowPointers[i + 1] += rowPointers[i];
+   }
+
+   vector<int> columnRows(nnz), rowColumns(nnz), columnFill(columnPointers), rowFill(rowPointers);
+   for (k = 0; k < nnz; k++)
+   {
+      columnRows[columnFill[_columns[k]]++] = _rows[k];
+      rowColumns[rowFill[_rows[k]]++] = _columns[k];
+   }
+
+   colorColumns(columnPointers, columnRows, rowPointers, rowColumns);
+
+   //columns and nonzeros grouped by color
+   _colorColumnPointers.assign(_numberOfColors + 1, 0);
+   _colorNonZeroPointers.assign(_numberOfColors + 1, 0);
+
+   for (j = 0; j < _problemSize; j++)
+      _colorColumnPointers[_columnColors[j] + 1]++;
+   for (k = 0; k < nnz; k++)
+      _colorNonZeroPointers[_columnColors[_columns[k]] + 1]++;
+
+   for (int c = 0; c < _numberOfColors; c++)
+   {
+      _colorColumnPointers[c + 1] += _colorColumnPointers[c];
+      _colorNonZeroPointers[c + 1] += _colorNonZeroPointers[c];
+   }
+
+   vector<int> colorColumnFill(_colorColumnPointers), colorNonZeroFill(_colorNonZeroPointers);
+
+   _colorColumns.resize(_problemSize);
+   for (j = 0; j < _problemSize; j++)
+      _colorColumns[colorColumnFill[_columnColors[j]]++] = j;
+
+   _colorNonZeros.resize(nnz);
+   for (k = 0; k < nnz; k++)
+      _colorNonZeros[colorNonZeroFill[_columnColors[_columns[k]]]++] = k;
+
+   _appliedIncrements.resize(_problemSize);
+}
+
+void ColoredFiniteDifferenceJacobian::colorColumns(const vector<int> & columnPointers, const vector<int> & columnRows,
+                                                   const vector<int> & rowPointers, const vector<int> & rowColumns)
+{
+   //greedy (first fit) coloring of the column intersection graph:
+   //column j gets the smallest color not used by any column sharing a row with j
+   _columnColors.assign(_problemSize, -1);
+   _numberOfColors = 0;
+
+   //forbiddenColors[c] == j: color c is already used by a neighbour of column j
+   vector<int> forbiddenColors;
+
+   for (int j = 0; j < _problemSize; j++)
+   {
+      for (int k = columnPointers[j]; k < columnPointers[j + 1]; k++)
+      {
+         int row = columnRows[k];
+         for (int l = rowPointers[row]; l < rowPointers[row + 1]; l++)
+         {
+            int color = _columnColors[rowColumns[l]];
+            if (color >= 0)
+               forbiddenColors[color] = j;
+         }
+      }
+
+      int color = 0;
+      while (color < _numberOfColors && forbiddenColors[color] == j)
+         color++;
+
+      if (color == _numberOfColors)
+      {
+         _numberOfColors++;
+         forbiddenColors.push_back(-1);
+      }
+
+      _columnColors[j] = color;
+   }
+}
+
+Rhs_Return_Value ColoredFiniteDifferenceJacobian::Evaluate(const RhsFunction & rhs, const double * y, const double * fy, const double * increments,
+                                                           double * yWork, double * fWork, double * jacobianValues)
+{
+   int j, k;
+
+   copy(y, y + _problemSize, yWork);
+
+   for (int c = 0; c < _numberOfColors; c++)
+   {
+      //perturb all columns of the current color
+      for (k = _colorColumnPointers[c]; k < _colorColumnPointers[c + 1]; k++)
+      {
+         j = _colorColumns[k];
+         yWork[j] = y[j] + increments[j];
+         _appliedIncrements[j] = yWork[j] - y[j];
+      }
+
+      Rhs_Return_Value RetVal = rhs(yWork, fWork);
+      if (RetVal != RHS_OK)
+         return RetVal;
+
+      //each row of the current color belongs to exactly one perturbed column
+      for (k = _colorNonZeroPointers[c]; k < _colorNonZeroPointers[c + 1]; k++)
+      {
+         int nz = _colorNonZeros[k];
+         int row = _rows[nz];
+         j = _columns[nz];
+
+         jacobianValues[nz] = (fWork[row] - fy[row]) / _appliedIncrements[j];
+      }
+
+      for (k = _colorColumnPointers[c]; k < _colorColumnPointers[c + 1]; k++)
+      {
+         j = _colorColumns[k];
+         yWork[j] = y[j];
+      }
+   }
+
+   return RHS_OK;
+}
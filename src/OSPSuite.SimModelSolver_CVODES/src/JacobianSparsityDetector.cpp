@@ -0,0 +1,73 @@
+#include "SimModelSolver_CVODES/JacobianSparsityDetector.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+using namespace std;
+
+bool JacobianSparsityDetector::Detect(ISolverCaller * solverCaller, double t, const vector<double> & y0, const double * p,
+                                      SparsityPattern & pattern)
+{
+   int i, j;
+   int problemSize = (int)y0.size();
+
+   if (problemSize == 0)
+      return false;
+
+   vector<double> f0(problemSize), fProbe(problemSize), yProbe(y0);
+
+   if (solverCaller->ODERhsFunction(t, &y0[0], p, &f0[0], NULL) != RHS_OK)
+      return false;
+
+   pattern = SparsityPattern(problemSize, SparsityPattern::CSC);
+
+   //rowMarker[i] == j: f_i depends on y_j
+   vector<int> rowMarker(problemSize, -1);
+   vector<int> rows;
+
+   for (j = 0; j < problemSize; j++)
+   {
+      bool probed = false;
+
+      //NaN propagation
+      yProbe[j] = numeric_limits<double>::quiet_NaN();
+      if (solverCaller->ODERhsFunction(t, &yProbe[0], p, &fProbe[0], NULL) == RHS_OK)
+      {
+         probed = true;
+         for (i = 0; i < problemSize; i++)
+         {
+            if (isnan(fProbe[i]) && !isnan(f0[i]))
+               rowMarker[i] = j;
+         }
+      }
+
+      //finite perturbation (positive direction to keep nonnegative states nonnegative)
+      yProbe[j] = y0[j] + 1e-3 * max(fabs(y0[j]), 1.0);
+      if (solverCaller->ODERhsFunction(t, &yProbe[0], p, &fProbe[0], NULL) == RHS_OK)
+      {
+         probed = true;
+         for (i = 0; i < problemSize; i++)
+         {
+            if (fProbe[i] != f0[i])
+               rowMarker[i] = j;
+         }
+      }
+
+      yProbe[j] = y0[j];
+
+      if (!probed)
+         return false;
+
+      rows.clear();
+      for (i = 0; i < problemSize; i++)
+      {
+         if (rowMarker[i] == j)
+            rows.push_back(i);
+      }
+
+      pattern.IndexValues.insert(pattern.IndexValues.end(), rows.begin(), rows.end());
+      pattern.IndexPointers[j + 1] = pattern.GetNumberOfNonZeros();
+   }
+
+   return true;
+}
@@ -0,0 +1,359 @@
+#include "SimModelSolver_CVODES/PopulationSolver.h"
+#include "SimModelSolver_CVODES/SimModelSolver_CVODES.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+struct PopulationSolver::Worker
+{
+   ISolverCaller* SolverCaller;
+   SimModelSolver_CVODES* Solver;
+   vector<double> InitialValues;
+
+   //solver was initialized by a previous individual: the next one only needs ReInit
+   bool Initialized;
+
+   //remaining individuals [Next, End) of this worker; guarded by Mutex
+   mutex Mutex;
+   int Next;
+   int End;
+
+   Worker()
+   {
+      SolverCaller = NULL;
+      Solver = NULL;
+      Initialized = false;
+      Next = 0;
+      End = 0;
+   }
+};
+
+PopulationSolver::PopulationSolver(IPopulationModelFactory* modelFactory, int problemSize, int numberOfThreads)
+{
+   const char* ERROR_SOURCE = "PopulationSolver::PopulationSolver";
+
+   if (!modelFactory)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Model factory not set");
+   if (problemSize <= 0)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid problem size passed");
+
+   _modelFactory = modelFactory;
+   _problemSize = problemSize;
+
+   _numberOfThreads = numberOfThreads;
+   if (_numberOfThreads <= 0)
+      _numberOfThreads = max((int)thread::hardware_concurrency(), 1);
+
+   //0: solver defaults
+   _relTol = 0.0;
+   _absTol = 0.0;
+   _mxStep = 0;
+}
+
+PopulationSolver::~PopulationSolver()
+{
+   destroyWorkers();
+}
+
+int PopulationSolver::GetNumberOfThreads() const
+{
+   return _numberOfThreads;
+}
+
+void PopulationSolver::SetRelTol(double relTol)
+{
+   _relTol = relTol;
+}
+
+void PopulationSolver::SetAbsTol(double absTol)
+{
+   _absTol = absTol;
+}
+
+void PopulationSolver::SetMxStep(long mxStep)
+{
+   _mxStep = mxStep;
+}
+
+void PopulationSolver::SetOption(const string& name, double value)
+{
+   _solverOptions.push_back(make_pair(name, value));
+}
+
+string PopulationSolver::GetErrorMessage(int individual) const
+{
+   if ((individual < 0) || (individual >= (int)_errorMessages.size()))
+      return "";
+
+   return _errorMessages[individual];
+}
+
+void PopulationSolver::createWorkers()
+{
+   while ((int)_workers.size() < _numberOfThreads)
+   {
+      Worker* worker = new Worker();
+      _workers.push_back(worker);
+
+      worker->SolverCaller = _modelFactory->CreateSolverCaller();
+      worker->Solver = new SimModelSolver_CVODES(worker->SolverCaller, _problemSize, 0);
+      worker->InitialValues.resize(_problemSize);
+   }
+
+   //(re)apply the current settings; invalid options are reported to the caller of Solve
+   for (Worker* worker : _workers)
+   {
+      SimModelSolver_CVODES* solver = worker->Solver;
+
+      //settings may have changed since the last Solve call: first individual is initialized again
+      if (worker->Initialized)
+      {
+         solver->Terminate();
+         worker->Initialized = false;
+      }
+
+      //parallelism is across individuals
+      solver->SetOption("NumberOfThreads", 1);
+
+      if (_relTol > 0.0)
+         solver->SetRelTol(_relTol);
+      if (_absTol > 0.0)
+         solver->SetAbsTol(_absTol);
+      if (_mxStep > 0)
+         solver->SetMxStep(_mxStep);
+
+      for (const pair<string, double>& option : _solverOptions)
+         solver->SetOption(option.first, option.second);
+   }
+}
+
+void PopulationSolver::destroyWorkers()
+{
+   for (Worker* worker : _workers)
+   {
+      if (worker->Solver)
+      {
+         worker->Solver->Terminate();
+         delete worker->Solver;
+      }
+
+      if (worker->SolverCaller)
+         _modelFactory->DestroySolverCaller(worker->SolverCaller);
+
+      delete worker;
+   }
+
+   _workers.clear();
+}
+
+int PopulationSolver::Solve(int numberOfIndividuals, const double* parameterValues, int numberOfParameters,
+                            const double* initialValues, const vector<double>& outputTimes,
+                            double* results, int* resultFlags)
+{
+   const char* ERROR_SOURCE = "PopulationSolver::Solve";
+   int i;
+
+   if (numberOfIndividuals <= 0)
+      return 0;
+
+   if (!initialValues || !results || !resultFlags || ((numberOfParameters > 0) && !parameterValues))
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing input or output buffer");
+   if (outputTimes.empty())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "No output time points passed");
+
+   createWorkers();
+
+   int numberOfWorkers = min(_numberOfThreads, numberOfIndividuals);
+
+   _errorMessages.assign(numberOfIndividuals, "");
+
+   //contiguous blocks of (almost) equal size
+   for (i = 0; i < numberOfWorkers; i++)
+   {
+      _workers[i]->Next = (int)((long long)numberOfIndividuals * i / numberOfWorkers);
+      _workers[i]->End = (int)((long long)numberOfIndividuals * (i + 1) / numberOfWorkers);
+   }
+   for (i = numberOfWorkers; i < (int)_workers.size(); i++)
+   {
+      _workers[i]->Next = 0;
+      _workers[i]->End = 0;
+   }
+
+   vector<thread> threads;
+   for (i = 1; i < numberOfWorkers; i++)
+      threads.push_back(thread(&PopulationSolver::runWorker, this, i, parameterValues, numberOfParameters,
+                               initialValues, cref(outputTimes), results, resultFlags));
+
+   //the calling thread is the first worker
+   runWorker(0, parameterValues, numberOfParameters, initialValues, outputTimes, results, resultFlags);
+
+   for (thread& workerThread : threads)
+      workerThread.join();
+
+   int numberOfFailures = 0;
+   for (i = 0; i < numberOfIndividuals; i++)
+   {
+      if (resultFlags[i] != 0)
+         numberOfFailures++;
+   }
+
+   return numberOfFailures;
+}
+
+void PopulationSolver::runWorker(int workerIndex, const double* parameterValues, int numberOfParameters,
+                                 const double* initialValues, const vector<double>& outputTimes, double* results, int* resultFlags)
+{
+   Worker& worker = *_workers[workerIndex];
+
+   for (;;)
+   {
+      int individual = -1;
+      {
+         lock_guard<mutex> lock(worker.Mutex);
+         if (worker.Next < worker.End)
+            individual = worker.Next++;
+      }
+
+      if (individual < 0)
+      {
+         if (!stealIndividuals(workerIndex))
+            return;
+         continue;
+      }
+
+      resultFlags[individual] = solveIndividual(worker, individual, parameterValues, numberOfParameters, initialValues, outputTimes, results);
+   }
+}
+
+bool PopulationSolver::stealIndividuals(int workerIndex)
+{
+   //victim: worker with the largest number of remaining individuals
+   int victimIndex = -1, victimRemaining = 0;
+
+   for (int i = 0; i < (int)_workers.size(); i++)
+   {
+      if (i == workerIndex)
+         continue;
+
+      lock_guard<mutex> lock(_workers[i]->Mutex);
+      int remaining = _workers[i]->End - _workers[i]->Next;
+      if (remaining > victimRemaining)
+      {
+         victimIndex = i;
+         victimRemaining = remaining;
+      }
+   }
+
+   if (victimIndex < 0)
+      return false;
+
+   //take the upper half (the victim continues with the lower one)
+   int begin, end;
+   {
+      Worker& victim = *_workers[victimIndex];
+      lock_guard<mutex> lock(victim.Mutex);
+
+      if (victim.Next >= victim.End)
+         return true; //emptied in the meantime: try again
+
+      end = victim.End;
+      begin = victim.Next + (victim.End - victim.Next) / 2;
+      victim.End = begin;
+   }
+
+   Worker& worker = *_workers[workerIndex];
+   lock_guard<mutex> lock(worker.Mutex);
+   worker.Next = begin;
+   worker.End = end;
+
+   return true;
+}
+
+int PopulationSolver::solveIndividual(Worker& worker, int individual, const double* parameterValues, int numberOfParameters,
+                                      const double* initialValues, const vector<double>& outputTimes, double* results)
+{
+   int numberOfOutputTimes = (int)outputTimes.size();
+   double* individualResults = results + (size_t)individual * numberOfOutputTimes * _problemSize;
+   const double* y0 = initialValues + (size_t)individual * _problemSize;
+
+   SimModelSolver_CVODES* solver = worker.Solver;
+   int resultFlag = 0;
+   int k = 0;
+
+   try
+   {
+      _modelFactory->SetParameterValues(worker.SolverCaller, (numberOfParameters > 0) ? parameterValues + (size_t)individual * numberOfParameters : NULL,
+                                        numberOfParameters);
+
+      worker.InitialValues.assign(y0, y0 + _problemSize);
+
+      //CVODES memory, linear solver and jacobian setup of the first individual are reused
+      if (worker.Initialized)
+      {
+         resultFlag = solver->ReInit(outputTimes[0], worker.InitialValues);
+         if (resultFlag != 0)
+            _errorMessages[individual] = solver->GetSolverErrMsg(resultFlag);
+      }
+      else
+      {
+         solver->SetInitialTime(outputTimes[0]);
+         solver->SetInitialValues(worker.InitialValues);
+         solver->Init();
+         worker.Initialized = true;
+      }
+
+      copy(y0, y0 + _problemSize, individualResults);
+
+      for (k = 1; (k < numberOfOutputTimes) && (resultFlag == 0); k++)
+      {
+         double tret;
+         resultFlag = solver->PerformSolverStep(outputTimes[k], individualResults + (size_t)k * _problemSize, NULL, tret, SimModelSolverBase::NORMAL);
+         if (resultFlag != 0)
+         {
+            _errorMessages[individual] = solver->GetSolverErrMsg(resultFlag);
+            break;
+         }
+      }
+
+      if (resultFlag == 0)
+         k = numberOfOutputTimes;
+   }
+   catch (SimModelSolverErrorData& ED)
+   {
+      _errorMessages[individual] = ED.GetDescription();
+      resultFlag = -1;
+   }
+   catch (exception& e)
+   {
+      _errorMessages[individual] = e.what();
+      resultFlag = -1;
+   }
+   catch (...)
+   {
+      _errorMessages[individual] = "Unknown error occured during solving individual " + to_string(individual);
+      resultFlag = -1;
+   }
+
+   //no valid results after a failure; the next individual starts with a new Init
+   if (resultFlag != 0)
+   {
+      solver->Terminate();
+      worker.Initialized = false;
+
+      fill(individualResults + (size_t)k * _problemSize, individualResults + (size_t)numberOfOutputTimes * _problemSize,
+           numeric_limits<double>::quiet_NaN());
+   }
+
+   return resultFlag;
+}
+
+// DLL export function
+extern "C" CVODES_EXPORT PopulationSolver* GetPopulationSolver(IPopulationModelFactory* modelFactory, int problemSize, int numberOfThreads)
+{
+   return new PopulationSolver(modelFactory, problemSize, numberOfThreads);
+}
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <algorithm>
 #include <math.h>
+#include <string.h>
+#include <thread>
 #include <nvector/nvector_openmp.h>
 
 #ifdef _OPENMP
@@ -28,12 +30,61 @@ SimModelSolver_CVODES::SimModelSolver_CVODES(ISolverCaller* pSolverCaller, int p
    _solution = NULL;
 
    _cvodeMem = NULL;
+   _passedSolverOptions.Valid = false;
 
    CVODES_UserData = new UserData();
    CVODES_UserData->Solver = this;
 
    _linearSolverMatrix = NULL;
    _linearSolver = NULL;
+   _linearSolverType = LS_DIRECT;
+   _maxKrylovDimension = 0;
+   _preconditioning = PREC_LEFT;
+   _coloredJacobianEnabled = true;
+   _useColoredJacobian = false;
+   _jacobianSparsityDetection = false;
+   _jacobianPatternDetected = false;
+   _stateReordering = false;
+   _numberOfRootFunctions = 0;
+   _nextStopTime = 0;
+   _numberOfQuadratures = 0;
+   _quadratures = NULL;
+   _quadratureErrorControl = false;
+
+   _parallelSensitivityRhs = false;
+   _sensitivityValues = NULL;
+   _sensitivityMethod = CV_STAGGERED;
+   _usedSensitivityMethod = CV_STAGGERED;
+   _sensitivityErrorControl = false;
+   _sensitivitiesActive = true;
+   _sensitivitiesOnDemand = false;
+   _lastOutputTime = 0.0;
+   _sensitivitiesRetrieved = false;
+   resetSolverStatistics();
+
+   _adjointSensitivities = false;
+   _adjointCheckpointSteps = 100;
+   _adjointIntegralObjective = true;
+   _adjointMemoryBudget = 0.0;
+   _adjointInterpolation = CV_HERMITE;
+   _adjointNumberOfCheckpoints = 0;
+   _forwardRhsEvaluations = 0;
+   _adjointRecomputationRhsEvaluations = 0;
+   _adjointProblem = -1;
+   _adjointJacobianValid = false;
+   _adjointStartTime = 0.0;
+   _adjointFinalTime = 0.0;
+   _adjointValues = NULL;
+   _adjointQuadratures = NULL;
+   _adjointMatrix = NULL;
+   _adjointLinearSolver = NULL;
+   _directionalSensitivity = NULL;
+
+   _instrumentationEnabled = false;
+   _instrumentation = NULL;
+   _timedLinearSolver = NULL;
+
+   _solverCallerCVODES = dynamic_cast<ISolverCaller_CVODES*>(pSolverCaller);
 
    _numThreads = 0;
 }
@@ -47,7 +98,8 @@ int SimModelSolver_CVODES::getNumberOfThreads()
       if (_numThreads == 0)
          _numThreads = 1;
 #else
-      _numThreads = 1;
+      //worker threads of the solver itself (e.g. ParallelSensitivityRhs): same default
+      _numThreads = max((int)thread::hardware_concurrency() - 1, 1);
 #endif
    }
 
@@ -64,6 +116,7 @@ SimModelSolver_CVODES::~SimModelSolver_CVODES()
    //clear memory
    this->Terminate();
    delete CVODES_UserData;
+   delete _instrumentation;
 }
 
 std::vector < OptionInfo > SimModelSolver_CVODES::GetSolverOptionsInfo()
@@ -81,6 +134,163 @@ std::vector < OptionInfo > SimModelSolver_CVODES::GetSolverOptionsInfo()
 
    CVODE_Options.push_back(optionInfo);
 
+   OptionInfo linearSolverInfo;
+
+   linearSolverInfo.SetName("LinearSolver");
+   linearSolverInfo.SetDescription("Linear solver used in the Newton iteration");
+   linearSolverInfo.SetDefaultValue(LS_DIRECT);
+   linearSolverInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   linearSolverInfo.AddOptionValue(OptionValueInfo(LS_DIRECT, "Direct (dense, band or sparse)"));
+   linearSolverInfo.AddOptionValue(OptionValueInfo(LS_SPGMR, "SPGMR (matrix-free)"));
+   linearSolverInfo.AddOptionValue(OptionValueInfo(LS_SPBCGS, "SPBCGS (matrix-free)"));
+   linearSolverInfo.AddOptionValue(OptionValueInfo(LS_SPTFQMR, "SPTFQMR (matrix-free)"));
+
+   CVODE_Options.push_back(linearSolverInfo);
+
+   OptionInfo preconditionerInfo;
+
+   preconditionerInfo.SetName("Preconditioner");
+   preconditionerInfo.SetDescription("Preconditioning of the iterative linear solvers");
+   preconditionerInfo.SetDefaultValue(PREC_LEFT);
+   preconditionerInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   preconditionerInfo.AddOptionValue(OptionValueInfo(PREC_NONE, "None"));
+   preconditionerInfo.AddOptionValue(OptionValueInfo(PREC_LEFT, "Left"));
+   preconditionerInfo.AddOptionValue(OptionValueInfo(PREC_RIGHT, "Right"));
+
+   CVODE_Options.push_back(preconditionerInfo);
+
+   OptionInfo coloredJacobianInfo;
+
+   coloredJacobianInfo.SetName("ColoredFiniteDifferenceJacobian");
+   coloredJacobianInfo.SetDescription("Approximate the jacobian by colored difference quotients if the sparsity pattern but no analytic jacobian is available");
+   coloredJacobianInfo.SetDefaultValue(1);
+   coloredJacobianInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   coloredJacobianInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   coloredJacobianInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(coloredJacobianInfo);
+
+   OptionInfo sparsityDetectionInfo;
+
+   sparsityDetectionInfo.SetName("JacobianSparsityDetection");
+   sparsityDetectionInfo.SetDescription("Detect the jacobian sparsity pattern by probing the RHS function if no analytic jacobian is available and select band, sparse or dense matrix automatically");
+   sparsityDetectionInfo.SetDefaultValue(0);
+   sparsityDetectionInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   sparsityDetectionInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   sparsityDetectionInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(sparsityDetectionInfo);
+
+   OptionInfo stateReorderingInfo;
+
+   stateReorderingInfo.SetName("StateReordering");
+   stateReorderingInfo.SetDescription("Reorder the states internally to reduce the jacobian bandwidth and use the band linear solver");
+   stateReorderingInfo.SetDefaultValue(0);
+   stateReorderingInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   stateReorderingInfo.AddOptionValue(OptionValueInfo(0, "None"));
+   stateReorderingInfo.AddOptionValue(OptionValueInfo(1, "Reverse Cuthill-McKee"));
+
+   CVODE_Options.push_back(stateReorderingInfo);
+
+   OptionInfo quadratureErrorControlInfo;
+
+   quadratureErrorControlInfo.SetName("QuadratureErrorControl");
+   quadratureErrorControlInfo.SetDescription("Include the quadratures of the solver caller in the local error test (relative tolerance of the solver, smallest absolute tolerance of the states)");
+   quadratureErrorControlInfo.SetDefaultValue(0);
+   quadratureErrorControlInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   quadratureErrorControlInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   quadratureErrorControlInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(quadratureErrorControlInfo);
+
+   OptionInfo sensitivityMethodInfo;
+
+   sensitivityMethodInfo.SetName("SensitivityMethod");
+   sensitivityMethodInfo.SetDescription("Corrector method of the forward sensitivities. Automatic: method with the least work (RHS evaluations, linear solves) in short trial integrations from the initial values");
+   sensitivityMethodInfo.SetDefaultValue(CV_STAGGERED);
+   sensitivityMethodInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   sensitivityMethodInfo.AddOptionValue(OptionValueInfo(0, "Automatic"));
+   sensitivityMethodInfo.AddOptionValue(OptionValueInfo(CV_SIMULTANEOUS, "Simultaneous"));
+   sensitivityMethodInfo.AddOptionValue(OptionValueInfo(CV_STAGGERED, "Staggered"));
+   sensitivityMethodInfo.AddOptionValue(OptionValueInfo(CV_STAGGERED1, "Staggered1"));
+
+   CVODE_Options.push_back(sensitivityMethodInfo);
+
+   OptionInfo sensitivityErrorControlInfo;
+
+   sensitivityErrorControlInfo.SetName("SensitivityErrorControl");
+   sensitivityErrorControlInfo.SetDescription("Include the forward sensitivities in the local error test");
+   sensitivityErrorControlInfo.SetDefaultValue(0);
+   sensitivityErrorControlInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   sensitivityErrorControlInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   sensitivityErrorControlInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(sensitivityErrorControlInfo);
+
+   OptionInfo parallelSensitivityRhsInfo;
+
+   parallelSensitivityRhsInfo.SetName("ParallelSensitivityRhs");
+   parallelSensitivityRhsInfo.SetDescription("Evaluate the sensitivity RHS function of the solver caller concurrently for all sensitivity parameters (NumberOfThreads threads). The function must be thread safe");
+   parallelSensitivityRhsInfo.SetDefaultValue(0);
+   parallelSensitivityRhsInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   parallelSensitivityRhsInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   parallelSensitivityRhsInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(parallelSensitivityRhsInfo);
+
+   OptionInfo sensitivitiesOnDemandInfo;
+
+   sensitivitiesOnDemandInfo.SetName("SensitivitiesOnDemand");
+   sensitivitiesOnDemandInfo.SetDescription("Retrieve the forward sensitivities only when requested by GetSensitivities/GetSensitivityValues instead of at every output time");
+   sensitivitiesOnDemandInfo.SetDefaultValue(0);
+   sensitivitiesOnDemandInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   sensitivitiesOnDemandInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   sensitivitiesOnDemandInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(sensitivitiesOnDemandInfo);
+
+   OptionInfo adjointSensitivitiesInfo;
+
+   adjointSensitivitiesInfo.SetName("AdjointSensitivities");
+   adjointSensitivitiesInfo.SetDescription("Calculate the gradient of the objective of the solver caller by a backward (adjoint) solve instead of the forward sensitivities dy/dp");
+   adjointSensitivitiesInfo.SetDefaultValue(0);
+   adjointSensitivitiesInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   adjointSensitivitiesInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   adjointSensitivitiesInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(adjointSensitivitiesInfo);
+
+   OptionInfo adjointMemoryBudgetInfo;
+
+   adjointMemoryBudgetInfo.SetName("AdjointMemoryBudget");
+   adjointMemoryBudgetInfo.SetDescription("Memory ceiling for the checkpoints of the forward run in MB (adjoint sensitivities). The checkpoint interval is derived from it. 0: checkpoint every 100 steps");
+   adjointMemoryBudgetInfo.SetDefaultValue(0);
+   adjointMemoryBudgetInfo.SetDataType(OptionInfo::SODT_Double);
+
+   CVODE_Options.push_back(adjointMemoryBudgetInfo);
+
+   OptionInfo adjointInterpolationInfo;
+
+   adjointInterpolationInfo.SetName("AdjointInterpolation");
+   adjointInterpolationInfo.SetDescription("Interpolation of the forward solution between the checkpoints (adjoint sensitivities). Polynomial interpolation needs about half the memory per step");
+   adjointInterpolationInfo.SetDefaultValue(0);
+   adjointInterpolationInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   adjointInterpolationInfo.AddOptionValue(OptionValueInfo(0, "Hermite"));
+   adjointInterpolationInfo.AddOptionValue(OptionValueInfo(1, "Polynomial"));
+
+   CVODE_Options.push_back(adjointInterpolationInfo);
+
+   OptionInfo instrumentationInfo;
+
+   instrumentationInfo.SetName("Instrumentation");
+   instrumentationInfo.SetDescription("Record wall time and number of calls of RHS, jacobian, sensitivity RHS, linear solver and solver steps (see SetInstrumentationOutput)");
+   instrumentationInfo.SetDefaultValue(0);
+   instrumentationInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+   instrumentationInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+   instrumentationInfo.AddOptionValue(OptionValueInfo(1, "On"));
+
+   CVODE_Options.push_back(instrumentationInfo);
+
    return CVODE_Options;
 }
 
@@ -98,6 +308,33 @@ void SimModelSolver_CVODES::Init()
       if (!_solverCaller->IsSet_ODERhsFunction())
          throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "ODE RHS function not set");
 
+      //jacobian sparsity pattern and state ordering (required for initial data and tolerances)
+      if (_linearSolverType == LS_DIRECT)
+         setupSparseJacobianPattern();
+      setupStateOrdering();
+      setupSensitivityParameterList();
+      setupObservedOutput();
+
+      //sensitivities are active from the initial time (initial values 0)
+      _sensitivitiesActive = true;
+      _lastOutputTime = _initialTime;
+      _sensitivitiesRetrieved = true;
+
+      //new run
+      resetSolverStatistics();
+
+      //timings are kept over all runs of this instance
+      if (_instrumentationEnabled || !_instrumentationOutput.empty())
+      {
+         if (!_instrumentation)
+            _instrumentation = new SolverInstrumentation();
+      }
+      else
+      {
+         delete _instrumentation;
+         _instrumentation = NULL;
+      }
+
       // Initial data
       if (_initialData)
       {
@@ -118,7 +355,7 @@ void SimModelSolver_CVODES::Init()
 
       //Set Initial Data and resize value vectors
       for (i = 0; i < _problemSize; i++)
-         NV_Ith_S(_initialData, i) = _initialValues[i];
+         NV_Ith_S(_initialData, i) = _initialValues[callerStateIndex(i)];
 
       //Get memory for solution vector 
 #ifdef _OPENMP
@@ -131,6 +368,7 @@ void SimModelSolver_CVODES::Init()
 
       //Instantiate CVODE solver and specify the solution method
       _cvodeMem = CVodeCreate(_lmm);
+      _passedSolverOptions.Valid = false;
       if (_cvodeMem == NULL)
          throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Could not reserve memory for CVODE!");
 
@@ -153,40 +391,20 @@ void SimModelSolver_CVODES::Init()
       //fill solver options 
       this->FillSolverOptions();
 
-      //---- create CVODE linear solver (band or dense)
-      if (_solverCaller->UseBandLinearSolver())
-      {
-         _linearSolverMatrix = SUNBandMatrix(_problemSize, _solverCaller->GetUpperHalfBandWidth(), _solverCaller->GetLowerHalfBandWidth());
-         if (_linearSolverMatrix)
-            _linearSolver = SUNLinSol_Band(_initialData, _linearSolverMatrix);
-      }
-      else
-      {
-         _linearSolverMatrix = SUNDenseMatrix(_problemSize, _problemSize);
-         if (_linearSolverMatrix)
-            _linearSolver = SUNLinSol_Dense(_initialData, _linearSolverMatrix);
-      }
+      //---- create CVODE linear solver
+      setupLinearSolver();
 
-      if (!_linearSolverMatrix)
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver matrix");
-      if (!_linearSolver)
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver");
+      setupSensitivityProblem();
 
-      //Attach the matrix and linear solver
-      flag = CVodeSetLinearSolver(_cvodeMem, _linearSolver, _linearSolverMatrix);
-      if (flag != CVLS_SUCCESS)
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetLinearSolver failed.");
+      setupAdjointSensitivities();
 
-      //set jacobian function (if defined)
-      if (_solverCaller->IsSet_ODEJacFunction())
-         flag = CVodeSetJacFn(_cvodeMem, CVODE_JacFn);
-      else
-         flag = CVodeSetJacFn(_cvodeMem, NULL);
+      setupRootFinding();
 
-      if (flag != CVLS_SUCCESS)
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacFn failed.");
+      setupQuadratures();
 
-      setupSensitivityProblem();
+      setNextStopTime(_initialTime);
+
+      selectSensitivityMethod();
    }
    catch (SimModelSolverErrorData& ED)
    {
@@ -202,519 +420,3780 @@ void SimModelSolver_CVODES::Init()
    _initialized = true;
 }
 
-void SimModelSolver_CVODES::setupSensitivityProblem()
+void SimModelSolver_CVODES::setupLinearSolver()
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupSensitivityProblem";
-
-   if (_numberOfSensitivityParameters == 0)
-      return; //nothing to do
-
-   int i;
-
-   //---- initial sensitivity parameter values and scaling factors
-   CVODES_UserData->SensitivityParameters = new double[_numberOfSensitivityParameters];
-   CVODES_UserData->ScalingFactors = new double[_numberOfSensitivityParameters];
-   if (!CVODES_UserData->SensitivityParameters || !CVODES_UserData->ScalingFactors)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for user data");
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupLinearSolver";
+   int flag;
 
-   for (i = 0; i < _numberOfSensitivityParameters; i++)
+   //---- matrix-free Krylov solver: memory O(N*maxl) instead of O(N^2)
+   if (_linearSolverType != LS_DIRECT)
    {
-      CVODES_UserData->SensitivityParameters[i] = _sensitivityParametersInitialValues[i];
-
-      //set sensitivity parameter scaling factor to:
-      //   - fabs(initial parameter value), if it's !=0
-      //   - 1, if it's <=0
-      // (compare CVODES help, p. 94)
-      if (_sensitivityParametersInitialValues[i] != 0.0)
+      switch (_linearSolverType)
       {
-         CVODES_UserData->ScalingFactors[i] = fabs(_sensitivityParametersInitialValues[i]);
+      case LS_SPGMR:
+         _linearSolver = SUNLinSol_SPGMR(_initialData, _preconditioning, _maxKrylovDimension);
+         break;
+      case LS_SPBCGS:
+         _linearSolver = SUNLinSol_SPBCGS(_initialData, _preconditioning, _maxKrylovDimension);
+         break;
+      default:
+         _linearSolver = SUNLinSol_SPTFQMR(_initialData, _preconditioning, _maxKrylovDimension);
+         break;
       }
-      else
+
+      if (!_linearSolver)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver");
+
+      flag = CVodeSetLinearSolver(_cvodeMem, attachedLinearSolver(), NULL);
+      if (flag != CVLS_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetLinearSolver failed.");
+
+      //jacobian-vector product provided by caller. If not set, CVODE uses difference quotients
+      if (_solverCallerCVODES && _solverCallerCVODES->IsSet_ODEJacTimesVecFunction())
       {
-         CVODES_UserData->ScalingFactors[i] = 1.0;
+         flag = CVodeSetJacTimes(_cvodeMem, NULL, CVODE_JacTimesVecFn);
+         if (flag != CVLS_SUCCESS)
+            throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacTimes failed.");
       }
+
+      if (_preconditioning != PREC_NONE)
+         setupPreconditioner();
+
+      return;
    }
 
-   //create matrix for storing of the sensitivity values dy_i/dp_j
-#ifdef _OPENMP
-   _sensitivityValues = N_VCloneVectorArray_OpenMP(_numberOfSensitivityParameters, _initialData);
-#else
-   _sensitivityValues = N_VCloneVectorArray_Serial(_numberOfSensitivityParameters, _initialData);
-#endif
-   if (_sensitivityValues == NULL)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for ODE sensitivities initial data vector");
+   //---- direct solver (sparse, band or dense)
+   bool sparsityPatternAvailable = (_sparseJacobianPattern.GetProblemSize() == _problemSize);
 
-   //set initial values of sensitivities (dy_i/dp_j(0)) to zero
-   for (i = 0; i < _numberOfSensitivityParameters; i++)
-      N_VConst(0.0, _sensitivityValues[i]);
+   //no analytic jacobian: use colored difference quotients instead of one RHS evaluation per column
+   _useColoredJacobian = _coloredJacobianEnabled && sparsityPatternAvailable && !isAnalyticJacobianAvailable();
+   if (_useColoredJacobian)
+   {
+      _coloredJacobian.Init(_sparseJacobianPattern);
+      _coloredJacobianValues.resize(_sparseJacobianPattern.GetNumberOfNonZeros());
+      _coloredJacobianIncrements.resize(_problemSize);
+   }
 
-   //ODE RHS Sensitivity function provided by caller. If not set, pass NULL to the sensitivity init function
-   CVSensRhs1Fn sensitivityRHS_Function = _solverCaller->IsSet_ODESensitivityRhsFunction() ? CVODE_SensitivityRhsFunction : NULL;
+   //matrix type requested by the caller or selected from the detected pattern
+   MATRIX_TYPE matrixType = MATRIX_DENSE;
+   int mu = 0, ml = 0;
 
-   //----- main sensitivity initialization routine
-   //
-   //Notes: 
-   //
-   //At the moment, always use CV STAGGERED for sensitivity solution method. 
-   //Might be defined as user option in the future
-   //
-   //In the CV STAGGERED approach, the correction step for the sensitivity variables takes place at the same time 
-   //for all sensitivity equations, but only after the correction of the state variables has converged and the
-   //state variables have passed the local error test
-   if (CVodeSensInit1(_cvodeMem, _numberOfSensitivityParameters, CV_STAGGERED, sensitivityRHS_Function, _sensitivityValues) != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensInit1 failed");
+   if (useSparseLinearSolver())
+      matrixType = MATRIX_SPARSE;
+   else if (_solverCaller->UseBandLinearSolver())
+   {
+      matrixType = MATRIX_BAND;
+      mu = _solverCaller->GetUpperHalfBandWidth();
+      ml = _solverCaller->GetLowerHalfBandWidth();
+   }
+   else if (_jacobianPatternDetected || !_statePermutation.empty())
+      matrixType = selectMatrixType(mu, ml);
 
-   //When CVodeSensEEtolerances is called, cvodes will estimate tolerances for sensitivity
-   //variables based on the tolerances supplied for states variables and the scaling factors of sensitivity parameters
-   if (CVodeSensEEtolerances(_cvodeMem) != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensEEtolerances failed");
+   if (matrixType == MATRIX_SPARSE)
+   {
+      if (!sparsityPatternAvailable)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sparse linear solver requires the jacobian sparsity pattern");
 
-   //The function CVodeSetSensErrCon specifies the error control strategy for sensitivity variables.
-   //2nd argument specifies whether sensitivity variables are to be included (TRUE) or not(FALSE) in the error control mechanism.
-   //Default CVODES value is false
-   //Might be defined as user option in the future
-   if (CVodeSetSensErrCon(_cvodeMem, false) != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensErrCon failed");
+      //sparse matrices cannot be approximated by CVODE
+      if (!_useColoredJacobian && !isAnalyticJacobianAvailable())
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sparse linear solver requires the sparse jacobian function or the colored finite difference jacobian");
 
-   //CVodeSetSensParams(cvode mem, p, pbar, plist) specifies problem parameter information for sensitivity calculations.
-   //
-   //	p is a pointer to the array of real problem parameters used to evaluate f(t, y, p).
-   //  If non - NULL, p must point to a field in the user's data structure user_data passed to the RHS function
-    //
-   //  pbar is an array of NO_OF_SENSITIVITIES positive scaling factors.
-   //	
-   //  plist is an array of NO_OF_SENSITIVITIES indices to specify which components p[i] to use
-   if (CVodeSetSensParams(_cvodeMem, CVODES_UserData->SensitivityParameters, CVODES_UserData->ScalingFactors, NULL) != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensParams failed");
+#ifdef CVODES_WITH_KLU
+      _linearSolverMatrix = SUNSparseMatrix(_problemSize, _problemSize, _sparseJacobianPattern.GetNumberOfNonZeros(), _sparseJacobianPattern.PatternFormat);
+      if (_linearSolverMatrix)
+         _linearSolver = SUNLinSol_KLU(_initialData, _linearSolverMatrix);
+#else
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sparse linear solver is not available (solver was built without KLU support)");
+#endif
+   }
+   else if (matrixType == MATRIX_BAND)
+   {
+      _linearSolverMatrix = SUNBandMatrix(_problemSize, mu, ml);
+      if (_linearSolverMatrix)
+         _linearSolver = SUNLinSol_Band(_initialData, _linearSolverMatrix);
+   }
+   else
+   {
+      _linearSolverMatrix = SUNDenseMatrix(_problemSize, _problemSize);
+      if (_linearSolverMatrix)
+         _linearSolver = SUNLinSol_Dense(_initialData, _linearSolverMatrix);
+   }
+
+   if (!_linearSolverMatrix)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver matrix");
+   if (!_linearSolver)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver");
+
+   //Attach the matrix and linear solver
+   flag = CVodeSetLinearSolver(_cvodeMem, attachedLinearSolver(), _linearSolverMatrix);
+   if (flag != CVLS_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetLinearSolver failed.");
+
+   //set jacobian function (if defined). Otherwise CVODE uses its own difference quotient jacobian
+   if (_solverCaller->IsSet_ODEJacFunction() || _useColoredJacobian || SUNMatGetID(_linearSolverMatrix) == SUNMATRIX_SPARSE)
+      flag = CVodeSetJacFn(_cvodeMem, CVODE_JacFn);
+   else
+      flag = CVodeSetJacFn(_cvodeMem, NULL);
+
+   if (flag != CVLS_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacFn failed.");
 }
 
-int SimModelSolver_CVODES::PerformSolverStep(double tout, double* y, double** yS, double& tret, STEP_MODE step_mode)
+SUNLinearSolver SimModelSolver_CVODES::attachedLinearSolver()
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::PerformSolverStep";
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::attachedLinearSolver";
 
-   int iResultflag;
-   //check the solver was initialized
-   if (!_initialized)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+   if (!_instrumentation)
+      return _linearSolver;
 
-   if (step_mode == SINGLE)
-   {
-      // perform next solver step
-      iResultflag = CVode(_cvodeMem, tout, _solution, &tret, CV_ONE_STEP);
+   _timedLinearSolver = _instrumentation->CreateTimedLinearSolver(_linearSolver);
+   if (!_timedLinearSolver)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the linear solver");
 
-   	_step++;
-      if (_mxStep != 0 && _step > _mxStep)
-         return CV_TOO_MUCH_WORK;
+   return _timedLinearSolver;
+}
 
-      // After a single internal step return to the caller
-      if (iResultflag == CV_SUCCESS && tret < tout)
-         return CV_SUCCESS;
+void SimModelSolver_CVODES::setupPreconditioner()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupPreconditioner";
+   int flag;
 
-      // After tout has been reached, call CVode with CV_NORMAL to ensure consistent _cvodeMem
-      // it returns early after adjusting tret
-      if (iResultflag == CV_SUCCESS)
-      {
-         _step = 0;
-         iResultflag = CVode(_cvodeMem, tout, _solution, &tret, CV_NORMAL);
-      }
-   }
-   else
+   //preconditioner provided by caller
+   if (_solverCallerCVODES && _solverCallerCVODES->IsSet_PreconditionerFunctions())
    {
-      iResultflag = CVode(_cvodeMem, tout, _solution, &tret, CV_NORMAL);
+      flag = CVodeSetPreconditioner(_cvodeMem, CVODE_PrecSetupFn, CVODE_PrecSolveFn);
+      if (flag != CVLS_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetPreconditioner failed.");
+
+      return;
    }
 
+   //banded preconditioner of CVODES (bandwidths 0 result in a diagonal preconditioner)
+   int mu = _solverCaller->GetUpperHalfBandWidth();
+   int ml = _solverCaller->GetLowerHalfBandWidth();
 
-   //copy new solution vector
-#ifdef _OPENMP
-   double* _SolutionData = NV_DATA_OMP(_solution);
-#else
-   double* _SolutionData = NV_DATA_S(_solution);
-#endif
+   if ((mu < 0) || (ml < 0))
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid half bandwidths for the banded preconditioner");
 
-   int i;
-   for (i = 0; i < _problemSize; i++)
-      y[i] = _SolutionData[i];
+   mu = min(mu, _problemSize - 1);
+   ml = min(ml, _problemSize - 1);
 
-   //if no sensitivity calculation is required or if CVode call was not successful - return
-   if ((iResultflag != CV_SUCCESS) || (_numberOfSensitivityParameters == 0))
-      return iResultflag;
+   flag = CVBandPrecInit(_cvodeMem, _problemSize, mu, ml);
+   switch (flag)
+   {
+   case CVLS_SUCCESS:
+      break;
+   case CVLS_MEM_FAIL:
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the banded preconditioner");
+   default:
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVBandPrecInit failed.");
+   }
+}
 
-   iResultflag = CVodeGetSens(_cvodeMem, &tret, _sensitivityValues);
+bool SimModelSolver_CVODES::useSparseLinearSolver()
+{
+   return _solverCallerCVODES && _solverCallerCVODES->UseSparseLinearSolver();
+}
 
-   //copy sensitivity values 
-   //at the end; yS[i][j]=dy_i/dp_j
-   for (int j = 0; j < _numberOfSensitivityParameters; j++)
-   {
-#ifdef _OPENMP
-      double* data = NV_DATA_OMP(_sensitivityValues[j]);
-#else
-      double* data = NV_DATA_S(_sensitivityValues[j]);
-#endif
+bool SimModelSolver_CVODES::isAnalyticJacobianAvailable()
+{
+   if (useSparseLinearSolver())
+      return _solverCallerCVODES->IsSet_ODESparseJacFunction();
 
-      for (i = 0; i < _problemSize; i++)
-      {
-         yS[i][j] = data[i];
-      }
-   }
+   return _solverCaller->IsSet_ODEJacFunction();
+}
 
-   //return value of CVode call
-   return iResultflag;
+bool SimModelSolver_CVODES::isBandStorageEfficient(int mu, int ml)
+{
+   //storage of the band LU factorization (incl. fill-in) compared to the dense matrix
+   double bandSize = (double)_problemSize * (min(_problemSize - 1, mu + ml) + ml + 1);
+   double denseSize = (double)_problemSize * _problemSize;
+
+   return 4.0 * bandSize <= denseSize;
 }
 
-//TODO Reinitialization of sensitivity problem might be required as well!!! to be checked
-int SimModelSolver_CVODES::ReInit(double t0, const vector < double >& y0)
+SimModelSolver_CVODES::MATRIX_TYPE SimModelSolver_CVODES::selectMatrixType(int& mu, int& ml)
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::ReInit";
+   _sparseJacobianPattern.GetHalfBandWidths(ml, mu);
 
-   int iResultFlag;
+   if (isBandStorageEfficient(mu, ml))
+      return MATRIX_BAND;
 
-   //call basis class ReInit first (common part)
-   iResultFlag = SimModelSolverBase::ReInit(t0, y0);
-   if (iResultFlag != SimModelSolverErrorData::err_OK)
-      return iResultFlag;
+#ifdef CVODES_WITH_KLU
+   double denseSize = (double)_problemSize * _problemSize;
 
-   //fill new initial data vector
-   if (_initialData)
-   {
-#ifdef _OPENMP
-      N_VDestroy_OpenMP(_initialData);
-#else
-      N_VDestroy_Serial(_initialData);
-#endif
-      _initialData = NULL;
-   }
-#ifdef _OPENMP
-   _initialData = N_VNew_OpenMP(_problemSize, getNumberOfThreads());
-#else
-   _initialData = N_VNew_Serial(_problemSize);
+   //sparse jacobian can only be evaluated by colored difference quotients
+   if (_useColoredJacobian && (10.0 * _sparseJacobianPattern.GetNumberOfNonZeros() <= denseSize))
+      return MATRIX_SPARSE;
 #endif
-   if (!_initialData)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for ODE initial data vector");
 
-   for (int i = 0; i < _problemSize; i++)
-      NV_Ith_S(_initialData, i) = y0[i];
+   return MATRIX_DENSE;
+}
 
+bool SimModelSolver_CVODES::detectJacobianSparsityPattern()
+{
+   //pattern detected during the previous initialization is reused
+   if (_detectedJacobianPattern.GetProblemSize() == _problemSize)
+      return true;
 
-   //fill solver options
-   this->FillSolverOptions();
+   const double* p = (_numberOfSensitivityParameters > 0) ? &_sensitivityParametersInitialValues[0] : NULL;
 
-   //call CVode ReInit routine
-   iResultFlag = CVodeReInit(_cvodeMem, t0, _initialData);
+   if (JacobianSparsityDetector::Detect(_solverCaller, _initialTime, _initialValues, p, _detectedJacobianPattern))
+      return true;
 
-   return iResultFlag;
-}
+   _detectedJacobianPattern = SparsityPattern();
 
+   return false;
+}
 
-void SimModelSolver_CVODES::Terminate()
+bool SimModelSolver_CVODES::setupSparseJacobianPattern()
 {
-   if (_solution)
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupSparseJacobianPattern";
+
+   _sparseJacobianPattern = SparsityPattern();
+   _sparseJacobianValueMap.clear();
+   _sparseJacobianCallerValues.clear();
+   _jacobianPatternDetected = false;
+
+   SparsityPattern callerPattern;
+   if (!_solverCallerCVODES || !_solverCallerCVODES->GetJacobianSparsityPattern(callerPattern))
    {
-#ifdef _OPENMP
-      N_VDestroy_OpenMP(_solution);
-#else
-      N_VDestroy_Serial(_solution);
-#endif
-      _solution = NULL;
+      //no pattern from the caller: detect it if required
+      //(analytic jacobians need a pattern only for the state reordering)
+      bool patternRequired = isStateReorderingApplicable() || (_jacobianSparsityDetection && !isAnalyticJacobianAvailable());
+      if (!patternRequired || !detectJacobianSparsityPattern())
+         return false;
+
+      callerPattern = _detectedJacobianPattern;
+      _jacobianPatternDetected = true;
    }
 
-   if (_initialData)
-   {
-#ifdef _OPENMP
-      N_VDestroy_OpenMP(_initialData);
-#else
-      N_VDestroy_Serial(_initialData);
+   if (!callerPattern.IsValid(_problemSize))
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid jacobian sparsity pattern passed");
+
+   //KLU requires sorted indices without duplicates; the Newton matrix I-gamma*J requires all diagonal entries
+   _sparseJacobianPattern = callerPattern.Normalized(_sparseJacobianValueMap);
+
+   if (_sparseJacobianValueMap.empty())
+      _sparseJacobianCallerValues.clear();
+   else
+      _sparseJacobianCallerValues.resize(callerPattern.GetNumberOfNonZeros());
+
+   return true;
+}
+
+bool SimModelSolver_CVODES::isStateReorderingApplicable()
+{
+   //sparse solver orders the states itself; band solver requested by the caller is used as is
+   return _stateReordering && (_linearSolverType == LS_DIRECT) && !useSparseLinearSolver() && !_solverCaller->UseBandLinearSolver();
+}
+
+void SimModelSolver_CVODES::setupStateOrdering()
+{
+   _statePermutation.clear();
+
+   if (!isStateReorderingApplicable() || (_sparseJacobianPattern.GetProblemSize() != _problemSize))
+      return;
+
+   vector<int> permutation = _sparseJacobianPattern.ReverseCuthillMcKee();
+   vector<int> valueMap;
+   SparsityPattern permutedPattern = _sparseJacobianPattern.Permuted(permutation).Normalized(valueMap);
+
+   //keep the new ordering only if it reduces the bandwidth and the band solver pays off
+   int ml, mu, permutedMl, permutedMu;
+   _sparseJacobianPattern.GetHalfBandWidths(ml, mu);
+   permutedPattern.GetHalfBandWidths(permutedMl, permutedMu);
+
+   if ((2 * permutedMl + permutedMu >= 2 * ml + mu) || !isBandStorageEfficient(permutedMu, permutedMl))
+      return;
+
+   _statePermutation = permutation;
+   _sparseJacobianPattern = permutedPattern;
+   _sparseJacobianValueMap.clear();
+   _sparseJacobianCallerValues.clear();
+
+   _callerY.resize(_problemSize);
+   _callerYdot.resize(_problemSize);
+   _callerYS.resize(_problemSize);
+   _callerYSdot.resize(_problemSize);
+
+   //analytic (dense) jacobian of the caller is evaluated into a buffer and permuted into the band matrix
+   if (isAnalyticJacobianAvailable())
+   {
+      _callerJacobian.assign((size_t)_problemSize * _problemSize, 0.0);
+      _callerJacobianColumns.resize(_problemSize);
+      for (int j = 0; j < _problemSize; j++)
+         _callerJacobianColumns[j] = &_callerJacobian[(size_t)j * _problemSize];
+   }
+   else
+   {
+      _callerJacobian.clear();
+      _callerJacobianColumns.clear();
+   }
+}
+
+int SimModelSolver_CVODES::callerStateIndex(int i)
+{
+   return _statePermutation.empty() ? i : _statePermutation[i];
+}
+
+void SimModelSolver_CVODES::toCallerOrder(const double* solverValues, double* callerValues)
+{
+   for (int i = 0; i < _problemSize; i++)
+      callerValues[_statePermutation[i]] = solverValues[i];
+}
+
+void SimModelSolver_CVODES::toSolverOrder(const double* callerValues, double* solverValues)
+{
+   for (int i = 0; i < _problemSize; i++)
+      solverValues[i] = callerValues[_statePermutation[i]];
+}
+
+Rhs_Return_Value SimModelSolver_CVODES::callRhs(double t, const double* y, const double* p, double* ydot)
+{
+   if (_statePermutation.empty())
+      return _solverCaller->ODERhsFunction(t, y, p, ydot, NULL);
+
+   toCallerOrder(y, &_callerY[0]);
+
+   Rhs_Return_Value RetVal = _solverCaller->ODERhsFunction(t, &_callerY[0], p, &_callerYdot[0], NULL);
+
+   toSolverOrder(&_callerYdot[0], ydot);
+
+   return RetVal;
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::fillReorderedJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J)
+{
+#ifdef _OPENMP
+   toCallerOrder(NV_DATA_OMP(y), &_callerY[0]);
+   toCallerOrder(NV_DATA_OMP(fy), &_callerYdot[0]);
+#else
+   toCallerOrder(NV_DATA_S(y), &_callerY[0]);
+   toCallerOrder(NV_DATA_S(fy), &_callerYdot[0]);
+#endif
+
+   fill(_callerJacobian.begin(), _callerJacobian.end(), 0.0);
+
+   Jacobian_Return_Value RetVal = _solverCaller->ODEJacFunction(t, &_callerY[0], CVODES_UserData->SensitivityParameters, &_callerYdot[0],
+                                                                &_callerJacobianColumns[0], NULL);
+   if (RetVal != JACOBIAN_OK)
+      return RetVal;
+
+   //J(k,l) = df_perm[k]/dy_perm[l]
+   bool isBand = SUNMatGetID(J) == SUNMATRIX_BAND;
+   int mu = isBand ? (int)SUNBandMatrix_UpperBandwidth(J) : _problemSize;
+   int ml = isBand ? (int)SUNBandMatrix_LowerBandwidth(J) : _problemSize;
+
+   for (int l = 0; l < _problemSize; l++)
+   {
+      const double* callerColumn = _callerJacobianColumns[_statePermutation[l]];
+
+      if (isBand)
+      {
+         realtype* column = SUNBandMatrix_Column(J, l);
+         for (int k = max(0, l - mu); k <= min(_problemSize - 1, l + ml); k++)
+            column[k - l] = callerColumn[_statePermutation[k]];
+      }
+      else
+      {
+         realtype* column = SUNDenseMatrix_Column(J, l);
+         for (int k = 0; k < _problemSize; k++)
+            column[k] = callerColumn[_statePermutation[k]];
+      }
+   }
+
+   return JACOBIAN_OK;
+}
+
+void SimModelSolver_CVODES::setSparseMatrixPattern(SUNMatrix J)
+{
+   //SUNMatZero (called by CVODE prior to the jacobian evaluation) resets the pattern as well
+   sunindextype* indexPointers = SUNSparseMatrix_IndexPointers(J);
+   sunindextype* indexValues = SUNSparseMatrix_IndexValues(J);
+
+   int i, nnz = _sparseJacobianPattern.GetNumberOfNonZeros();
+
+   for (i = 0; i <= _problemSize; i++)
+      indexPointers[i] = _sparseJacobianPattern.IndexPointers[i];
+   for (i = 0; i < nnz; i++)
+      indexValues[i] = _sparseJacobianPattern.IndexValues[i];
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::fillSparseJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J)
+{
+   setSparseMatrixPattern(J);
+
+   realtype* values = SUNSparseMatrix_Data(J);
+
+   int i, nnz = _sparseJacobianPattern.GetNumberOfNonZeros();
+
+   //caller pattern is already normalized: caller writes directly into the matrix
+   double* callerValues = _sparseJacobianValueMap.empty() ? values : &_sparseJacobianCallerValues[0];
+
+#ifdef _OPENMP
+   Jacobian_Return_Value RetVal = _solverCallerCVODES->ODESparseJacFunction(t, NV_DATA_OMP(y), CVODES_UserData->SensitivityParameters, NV_DATA_OMP(fy), callerValues, NULL);
+#else
+   Jacobian_Return_Value RetVal = _solverCallerCVODES->ODESparseJacFunction(t, NV_DATA_S(y), CVODES_UserData->SensitivityParameters, NV_DATA_S(fy), callerValues, NULL);
+#endif
+
+   if (RetVal != JACOBIAN_OK || _sparseJacobianValueMap.empty())
+      return RetVal;
+
+   //scatter caller values into the normalized pattern (duplicate entries are summed up)
+   for (i = 0; i < nnz; i++)
+      values[i] = 0.0;
+   for (size_t k = 0; k < _sparseJacobianValueMap.size(); k++)
+      values[_sparseJacobianValueMap[k]] += callerValues[k];
+
+   return RetVal;
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::fillColoredJacobian(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+                                                                 N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+   int i, j, k;
+
+#ifdef _OPENMP
+   double* yData = NV_DATA_OMP(y);
+   double* fyData = NV_DATA_OMP(fy);
+   double* ewt = NV_DATA_OMP(tmp1);
+   double* yWork = NV_DATA_OMP(tmp2);
+   double* fWork = NV_DATA_OMP(tmp3);
+#else
+   double* yData = NV_DATA_S(y);
+   double* fyData = NV_DATA_S(fy);
+   double* ewt = NV_DATA_S(tmp1);
+   double* yWork = NV_DATA_S(tmp2);
+   double* fWork = NV_DATA_S(tmp3);
+#endif
+
+   //increments as used by the difference quotient jacobians of CVODE:
+   //inc_j = max(sqrt(uround)*|y_j|, minInc/ewt_j), minInc = 1000*|h|*uround*N*||fy||_wrms
+   realtype h = 0.0;
+   CVodeGetErrWeights(_cvodeMem, tmp1);
+   CVodeGetCurrentStep(_cvodeMem, &h);
+
+   realtype fnorm = N_VWrmsNorm(fy, tmp1);
+   realtype srur = sqrt(UNIT_ROUNDOFF);
+   realtype minInc = (fnorm != 0.0) ? (1000.0 * fabs(h) * UNIT_ROUNDOFF * _problemSize * fnorm) : 1.0;
+
+   for (j = 0; j < _problemSize; j++)
+      _coloredJacobianIncrements[j] = max(srur * fabs(yData[j]), minInc / ewt[j]);
+
+   const double* p = CVODES_UserData->SensitivityParameters;
+   ColoredFiniteDifferenceJacobian::RhsFunction rhs = [this, t, p](const double* yPerturbed, double* fPerturbed)
+   {
+      return callRhs(t, yPerturbed, p, fPerturbed);
+   };
+
+   Rhs_Return_Value rhsRetVal = _coloredJacobian.Evaluate(rhs, yData, fyData, &_coloredJacobianIncrements[0], yWork, fWork, &_coloredJacobianValues[0]);
+   if (rhsRetVal == RHS_RECOVERABLE_ERROR)
+      return JACOBIAN_RECOVERABLE_ERROR;
+   if (rhsRetVal != RHS_OK)
+      return JACOBIAN_FAILED;
+
+   int nnz = _sparseJacobianPattern.GetNumberOfNonZeros();
+
+   if (SUNMatGetID(J) == SUNMATRIX_SPARSE)
+   {
+      setSparseMatrixPattern(J);
+
+      realtype* values = SUNSparseMatrix_Data(J);
+      for (k = 0; k < nnz; k++)
+         values[k] = _coloredJacobianValues[k];
+
+      return JACOBIAN_OK;
+   }
+
+   //dense or band matrix (already set to zero by CVODE). Entries outside of the band are skipped
+   bool isBand = SUNMatGetID(J) == SUNMATRIX_BAND;
+   int mu = isBand ? (int)SUNBandMatrix_UpperBandwidth(J) : _problemSize;
+   int ml = isBand ? (int)SUNBandMatrix_LowerBandwidth(J) : _problemSize;
+   bool isCSC = _sparseJacobianPattern.PatternFormat == SparsityPattern::CSC;
+
+   for (int l = 0; l < _problemSize; l++)
+   {
+      for (k = _sparseJacobianPattern.IndexPointers[l]; k < _sparseJacobianPattern.IndexPointers[l + 1]; k++)
+      {
+         i = isCSC ? _sparseJacobianPattern.IndexValues[k] : l;
+         j = isCSC ? l : _sparseJacobianPattern.IndexValues[k];
+
+         if (isBand)
+         {
+            if ((i - j <= ml) && (j - i <= mu))
+               SUNBandMatrix_Column(J, j)[i - j] = _coloredJacobianValues[k];
+         }
+         else
+            SUNDenseMatrix_Column(J, j)[i] = _coloredJacobianValues[k];
+      }
+   }
+
+   return JACOBIAN_OK;
+}
+
+void SimModelSolver_CVODES::setupSensitivityProblem()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupSensitivityProblem";
+
+   if (_numberOfSensitivityParameters == 0)
+      return; //nothing to do
+
+   //---- initial sensitivity parameter values and scaling factors
+   CVODES_UserData->SensitivityParameters = new double[_numberOfSensitivityParameters];
+   CVODES_UserData->ScalingFactors = new double[_numberOfSensitivityParameters];
+   if (!CVODES_UserData->SensitivityParameters || !CVODES_UserData->ScalingFactors)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for user data");
+
+   setSensitivityParameterValues();
+
+   //adjoint mode: parameters only (no forward sensitivities)
+   if (_adjointSensitivities)
+      return;
+
+   //CV_STAGGERED1 calls the sensitivity RHS per parameter; the automatic selection starts with CV_STAGGERED
+   if ((_sensitivityMethod == CV_STAGGERED1) && useSensitivityRhsAllFunction())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sensitivity method Staggered1 cannot be combined with the sensitivity RHS of all parameters");
+   _usedSensitivityMethod = (_sensitivityMethod != 0) ? _sensitivityMethod : CV_STAGGERED;
+
+   setupForwardSensitivities();
+}
+
+void SimModelSolver_CVODES::setSensitivityParameterValues()
+{
+   int i;
+
+   for (i = 0; i < _numberOfSensitivityParameters; i++)
+   {
+      CVODES_UserData->SensitivityParameters[i] = _sensitivityParametersInitialValues[i];
+
+      //set sensitivity parameter scaling factor to:
+      //   - fabs(initial parameter value), if it's !=0
+      //   - 1, if it's <=0
+      // (compare CVODES help, p. 94)
+      if (_sensitivityParametersInitialValues[i] != 0.0)
+      {
+         CVODES_UserData->ScalingFactors[i] = fabs(_sensitivityParametersInitialValues[i]);
+      }
+      else
+      {
+         CVODES_UserData->ScalingFactors[i] = 1.0;
+      }
+   }
+
+   //pbar of the parameters with forward sensitivities
+   _forwardSensitivityScalingFactors.resize(numberOfForwardSensitivities());
+   for (i = 0; i < numberOfForwardSensitivities(); i++)
+      _forwardSensitivityScalingFactors[i] = CVODES_UserData->ScalingFactors[_forwardSensitivityParameters[i]];
+}
+
+void SimModelSolver_CVODES::setupForwardSensitivities()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupForwardSensitivities";
+
+   int i;
+   int numberOfSensitivities = numberOfForwardSensitivities();
+
+   //create matrix for storing of the sensitivity values dy_i/dp_j (one vector per parameter of the list)
+#ifdef _OPENMP
+   _sensitivityValues = N_VCloneVectorArray_OpenMP(numberOfSensitivities, _initialData);
+#else
+   _sensitivityValues = N_VCloneVectorArray_Serial(numberOfSensitivities, _initialData);
+#endif
+   if (_sensitivityValues == NULL)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for ODE sensitivities initial data vector");
+
+   //set initial values of sensitivities (dy_i/dp_j(0)) to zero
+   for (i = 0; i < numberOfSensitivities; i++)
+      N_VConst(0.0, _sensitivityValues[i]);
+
+   //----- main sensitivity initialization routine
+   //
+   //Notes: 
+   //
+   //Sensitivity solution method (solver option SensitivityMethod, default CV_STAGGERED):
+   // - CV_SIMULTANEOUS: states and sensitivities are corrected together in one Newton iteration
+   // - CV_STAGGERED: the correction step for the sensitivity variables takes place at the same time
+   //   for all sensitivity equations, but only after the correction of the state variables has converged and the
+   //   state variables have passed the local error test
+   // - CV_STAGGERED1: as CV_STAGGERED, but the sensitivity equations are corrected one parameter at a time
+   //
+   //Sensitivity RHS of all parameters in one call (CVodeSensInit) if the solver caller provides it or if the
+   //per parameter function is evaluated in parallel; otherwise one call per parameter (CVodeSensInit1)
+   if (useSensitivityRhsAllFunction())
+   {
+      _sensitivityRhsYS.resize(numberOfSensitivities);
+      _sensitivityRhsYSdot.resize(numberOfSensitivities);
+      if (!_statePermutation.empty())
+      {
+         _callerSensitivities.resize((size_t)numberOfSensitivities * _problemSize);
+         _callerSensitivitiesDot.resize((size_t)numberOfSensitivities * _problemSize);
+      }
+
+      if (CVodeSensInit(_cvodeMem, numberOfSensitivities, _usedSensitivityMethod, CVODE_SensitivityRhsAllFunction, _sensitivityValues) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensInit failed");
+   }
+   else
+   {
+      //ODE RHS Sensitivity function provided by caller. If not set, pass NULL to the sensitivity init function
+      CVSensRhs1Fn sensitivityRHS_Function = _solverCaller->IsSet_ODESensitivityRhsFunction() ? CVODE_SensitivityRhsFunction : NULL;
+
+      if (CVodeSensInit1(_cvodeMem, numberOfSensitivities, _usedSensitivityMethod, sensitivityRHS_Function, _sensitivityValues) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensInit1 failed");
+   }
+
+   //When CVodeSensEEtolerances is called, cvodes will estimate tolerances for sensitivity
+   //variables based on the tolerances supplied for states variables and the scaling factors of sensitivity parameters
+   if (CVodeSensEEtolerances(_cvodeMem) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensEEtolerances failed");
+
+   //The function CVodeSetSensErrCon specifies the error control strategy for sensitivity variables.
+   //2nd argument specifies whether sensitivity variables are to be included (TRUE) or not(FALSE) in the error control mechanism.
+   //Default CVODES value is false (solver option SensitivityErrorControl)
+   if (CVodeSetSensErrCon(_cvodeMem, _sensitivityErrorControl) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensErrCon failed");
+
+   //CVodeSetSensParams(cvode mem, p, pbar, plist) specifies problem parameter information for sensitivity calculations.
+   //
+   //	p is a pointer to the array of real problem parameters used to evaluate f(t, y, p).
+   //  If non - NULL, p must point to a field in the user's data structure user_data passed to the RHS function
+    //
+   //  pbar is an array of NO_OF_SENSITIVITIES positive scaling factors.
+   //	
+   //  plist is an array of NO_OF_SENSITIVITIES indices to specify which components p[i] to use
+   //  (solver caller's parameter list, see SetSensitivityParameterList)
+   if (CVodeSetSensParams(_cvodeMem, CVODES_UserData->SensitivityParameters, &_forwardSensitivityScalingFactors[0], &_forwardSensitivityParameters[0]) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensParams failed");
+}
+
+void SimModelSolver_CVODES::SetSensitivityParameterList(const vector<int>& parameterIndices)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetSensitivityParameterList";
+
+   if (_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sensitivity parameter list must be set before Init");
+
+   _sensitivityParameterList = parameterIndices;
+}
+
+int SimModelSolver_CVODES::GetSensitivityMethod()
+{
+   return _usedSensitivityMethod;
+}
+
+int SimModelSolver_CVODES::GetLinearSolverMatrixType()
+{
+   if (!_linearSolverMatrix)
+      return -1;
+
+   return SUNMatGetID(_linearSolverMatrix);
+}
+
+int SimModelSolver_CVODES::numberOfForwardSensitivities()
+{
+   return (int)_forwardSensitivityParameters.size();
+}
+
+void SimModelSolver_CVODES::setupSensitivityParameterList()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupSensitivityParameterList";
+
+   _forwardSensitivityParameters.clear();
+   _forwardSensitivityIndex.assign(_numberOfSensitivityParameters, -1);
+
+   //adjoint sensitivities: gradient with respect to all parameters
+   if (_sensitivityParameterList.empty() || _adjointSensitivities)
+   {
+      for (int j = 0; j < _numberOfSensitivityParameters; j++)
+         _forwardSensitivityParameters.push_back(j);
+   }
+   else
+      _forwardSensitivityParameters = _sensitivityParameterList;
+
+   for (int k = 0; k < numberOfForwardSensitivities(); k++)
+   {
+      int j = _forwardSensitivityParameters[k];
+      if ((j < 0) || (j >= _numberOfSensitivityParameters) || (_forwardSensitivityIndex[j] >= 0))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid or duplicate sensitivity parameter index passed");
+      _forwardSensitivityIndex[j] = k;
+   }
+}
+
+int SimModelSolver_CVODES::restartIntegration(int sensitivityMethod)
+{
+   accumulateSolverStatistics();
+
+   int iResultflag = CVodeReInit(_cvodeMem, _initialTime, _initialData);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   //sensitivities (also if switched off) and directional sensitivity restart at 0
+   //(adjoint mode: parameter list only, no forward sensitivity vectors)
+   if ((numberOfForwardSensitivities() > 0) && !_adjointSensitivities)
+   {
+      for (int k = 0; k < numberOfForwardSensitivities(); k++)
+         N_VConst(0.0, _sensitivityValues[k]);
+
+      iResultflag = CVodeSensReInit(_cvodeMem, sensitivityMethod, _sensitivityValues);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   if (_directionalSensitivity)
+   {
+      N_VConst(0.0, _directionalSensitivity[0]);
+
+      iResultflag = CVodeSensReInit(_cvodeMem, CV_STAGGERED, _directionalSensitivity);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   if (_numberOfQuadratures > 0)
+   {
+#ifdef _OPENMP
+      double* q0 = NV_DATA_OMP(_quadratures);
+#else
+      double* q0 = NV_DATA_S(_quadratures);
+#endif
+      for (int l = 0; l < _numberOfQuadratures; l++)
+         q0[l] = 0.0;
+      _solverCallerCVODES->GetQuadratureInitialValues(q0);
+
+      iResultflag = CVodeQuadReInit(_cvodeMem, _quadratures);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   //new forward run for the adjoint sensitivities
+   if (_adjointSensitivities)
+   {
+      iResultflag = CVodeAdjReInit(_cvodeMem);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+
+      _adjointStartTime = _initialTime;
+      _adjointFinalTime = _initialTime;
+      _adjointNumberOfCheckpoints = 0;
+      _forwardRhsEvaluations = 0;
+      _adjointRecomputationRhsEvaluations = 0;
+   }
+
+   //the stop time may have been reached before (e.g. by a trial of the sensitivity method selection)
+   setNextStopTime(_initialTime);
+
+   _step = 0;
+   _sensitivitiesActive = true;
+   _lastOutputTime = _initialTime;
+   _sensitivitiesRetrieved = true;
+
+   return CV_SUCCESS;
+}
+
+int SimModelSolver_CVODES::UpdateSensitivityParameters(const vector<double>& parameterValues, const vector<int>& parameterIndices)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::UpdateSensitivityParameters";
+   int i;
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if ((int)parameterValues.size() != _numberOfSensitivityParameters)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of parameter values does not match the number of sensitivity parameters");
+
+   if ((int)_initialValues.size() != _problemSize)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of initial values does not match the problem size");
+
+   if (_numberOfSensitivityParameters == 0)
+      return CV_SUCCESS;
+
+   //---- new parameter subset (adjoint sensitivities: always all parameters)
+   if (!_adjointSensitivities && (parameterIndices != _sensitivityParameterList))
+   {
+      vector<bool> selected(_numberOfSensitivityParameters, false);
+      for (int j : parameterIndices)
+      {
+         if ((j < 0) || (j >= _numberOfSensitivityParameters) || selected[j])
+            throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid or duplicate sensitivity parameter index passed");
+         selected[j] = true;
+      }
+
+      int previousNumberOfSensitivities = numberOfForwardSensitivities();
+
+      _sensitivityParameterList = parameterIndices;
+      setupSensitivityParameterList();
+      setupObservedOutput();
+
+      //CVODES cannot change the number of sensitivities: only the sensitivity vectors and the sensitivity
+      //memory of CVODES are recreated (CVODES memory, matrix and linear solver are kept)
+      if (numberOfForwardSensitivities() != previousNumberOfSensitivities)
+      {
+#ifdef _OPENMP
+         N_VDestroyVectorArray_OpenMP(_sensitivityValues, previousNumberOfSensitivities);
+#else
+         N_VDestroyVectorArray_Serial(_sensitivityValues, previousNumberOfSensitivities);
+#endif
+         _sensitivityValues = NULL;
+         CVodeSensFree(_cvodeMem);
+
+         setSensitivityParameterValues();
+         setupForwardSensitivities();
+      }
+   }
+
+   //---- parameter values, scaling factors (pbar) and parameter list (plist) passed to CVODES
+   for (i = 0; i < _numberOfSensitivityParameters; i++)
+      _sensitivityParametersInitialValues[i] = parameterValues[i];
+   setSensitivityParameterValues();
+
+   if ((numberOfForwardSensitivities() > 0) && !_adjointSensitivities)
+   {
+      if (CVodeSetSensParams(_cvodeMem, CVODES_UserData->SensitivityParameters, &_forwardSensitivityScalingFactors[0], &_forwardSensitivityParameters[0]) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensParams failed");
+   }
+
+   //---- restart at the initial time with the (possibly changed) initial values
+   for (i = 0; i < _problemSize; i++)
+      NV_Ith_S(_initialData, i) = _initialValues[callerStateIndex(i)];
+
+   int iResultflag = restartIntegration(_usedSensitivityMethod);
+
+   //new run
+   resetSolverStatistics();
+
+   return iResultflag;
+}
+
+void SimModelSolver_CVODES::selectSensitivityMethod()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::selectSensitivityMethod";
+
+   //no forward sensitivities (none requested or adjoint mode): nothing to select
+   if ((numberOfForwardSensitivities() == 0) || _adjointSensitivities || !_sensitivityValues)
+      return;
+
+   if (_sensitivityMethod != 0)
+      return;
+
+   vector<int> sensitivityMethods;
+   sensitivityMethods.push_back(CV_SIMULTANEOUS);
+   sensitivityMethods.push_back(CV_STAGGERED);
+   if (!useSensitivityRhsAllFunction())
+      sensitivityMethods.push_back(CV_STAGGERED1);
+
+   //tout only limits the initial step size: the trials make SENSITIVITY_METHOD_TRIAL_STEPS internal steps
+   double tout = _initialTime + max(1.0, fabs(_initialTime));
+   double bestCost = 0.0;
+   int bestSensitivityMethod = CV_STAGGERED;
+
+   for (int sensitivityMethod : sensitivityMethods)
+   {
+      if (restartIntegration(sensitivityMethod) != CV_SUCCESS)
+         continue;
+
+      double tret = _initialTime;
+      int iResultflag = CV_SUCCESS;
+      for (int step = 0; (step < SENSITIVITY_METHOD_TRIAL_STEPS) && (iResultflag == CV_SUCCESS); step++)
+         iResultflag = CVode(_cvodeMem, tout, _solution, &tret, CV_ONE_STEP);
+
+      //work per integrated time (roots and stop times end the trial early)
+      if ((iResultflag < 0) || (tret <= _initialTime))
+         continue;
+
+      double cost = sensitivityMethodTrialWork(sensitivityMethod) / (tret - _initialTime);
+      if ((bestCost == 0.0) || (cost < bestCost))
+      {
+         bestCost = cost;
+         bestSensitivityMethod = sensitivityMethod;
+      }
+   }
+
+   _usedSensitivityMethod = bestSensitivityMethod;
+
+   if (restartIntegration(_usedSensitivityMethod) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot restart the sensitivity problem after the selection of the sensitivity method");
+}
+
+double SimModelSolver_CVODES::sensitivityMethodTrialWork(int sensitivityMethod)
+{
+   //counters were reset by restartIntegration
+   SolverStatistics statistics = currentSolverStatistics();
+   int numberOfSensitivities = numberOfForwardSensitivities();
+
+   //RHS evaluations; one sensitivity RHS call covers all parameters (CVodeSensInit) or one (CVodeSensInit1)
+   double rhsEvaluations = (double)statistics.RhsEvaluations + statistics.LinearSolverRhsEvaluations + statistics.RhsEvaluationsForSensitivities +
+                           (double)statistics.SensitivityRhsEvaluations * (useSensitivityRhsAllFunction() ? numberOfSensitivities : 1);
+
+   //linear solves: one per state and sensitivity of each nonlinear iteration of the simultaneous corrector,
+   //one per sensitivity of each iteration of the staggered sensitivity corrector (CV_STAGGERED1: counted per sensitivity)
+   double linearSolves = (double)statistics.NonlinearIterations * (sensitivityMethod == CV_SIMULTANEOUS ? numberOfSensitivities + 1 : 1) +
+                         (double)statistics.SensitivityNonlinearIterations * (sensitivityMethod == CV_STAGGERED ? numberOfSensitivities : 1);
+
+   return rhsEvaluations + linearSolves + statistics.LinearSolverSetups + statistics.SensitivityLinearSolverSetups;
+}
+
+bool SimModelSolver_CVODES::useSensitivityRhsAllFunction()
+{
+   if (_solverCallerCVODES && _solverCallerCVODES->IsSet_ODESensitivityRhsAllFunction())
+      return true;
+
+   return _parallelSensitivityRhs && _solverCaller->IsSet_ODESensitivityRhsFunction();
+}
+
+Sensitivity_Rhs_Return_Value SimModelSolver_CVODES::parallelSensitivityRhs(double t, const double* y, double* ydot)
+{
+   const double* const* yS = &_sensitivityRhsYS[0];
+   double* const* ySdot = &_sensitivityRhsYSdot[0];
+   const int* parameters = &_forwardSensitivityParameters[0];
+   int numberOfSensitivities = numberOfForwardSensitivities();
+   ISolverCaller* pSolverCaller = _solverCaller;
+
+   int numberOfThreads = max(min(getNumberOfThreads(), numberOfSensitivities), 1);
+
+   //number of failed parameters (unrecoverable and recoverable) per thread
+   vector<int> failures(numberOfThreads, 0), recoverableErrors(numberOfThreads, 0);
+
+   //thread k evaluates the contiguous block of parameters [k*Ns/threads, (k+1)*Ns/threads)
+   auto evaluateBlock = [&](int k)
+   {
+      int first = (int)((long)k * numberOfSensitivities / numberOfThreads);
+      int last = (int)((long)(k + 1) * numberOfSensitivities / numberOfThreads);
+
+      for (int iS = first; iS < last; iS++)
+      {
+         Sensitivity_Rhs_Return_Value RetVal = pSolverCaller->ODESensitivityRhsFunction(t, y, ydot, parameters[iS], yS[iS], ySdot[iS], NULL);
+
+         if (RetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+            recoverableErrors[k]++;
+         else if (RetVal != SENSITIVITY_RHS_OK)
+            failures[k]++;
+      }
+   };
+
+   vector<thread> threads;
+   for (int k = 1; k < numberOfThreads; k++)
+      threads.push_back(thread(evaluateBlock, k));
+
+   //the calling thread evaluates the first block
+   evaluateBlock(0);
+
+   for (thread& blockThread : threads)
+      blockThread.join();
+
+   int totalFailures = 0, totalRecoverableErrors = 0;
+   for (int k = 0; k < numberOfThreads; k++)
+   {
+      totalFailures += failures[k];
+      totalRecoverableErrors += recoverableErrors[k];
+   }
+
+   if (totalFailures > 0)
+      return SENSITIVITY_RHS_FAILED;
+
+   return (totalRecoverableErrors > 0) ? SENSITIVITY_RHS_RECOVERABLE_ERROR : SENSITIVITY_RHS_OK;
+}
+
+int SimModelSolver_CVODES::performSolverStep(double tout, double* y, double& tret, STEP_MODE step_mode, bool& sensitivitiesAvailable)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::PerformSolverStep";
+
+   int iResultflag;
+   sensitivitiesAvailable = false;
+   //check the solver was initialized
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (step_mode == SINGLE)
+   {
+      // perform next solver step
+      iResultflag = advance(tout, tret, CV_ONE_STEP);
+
+   	_step++;
+      if (_mxStep != 0 && _step > _mxStep)
+         return CV_TOO_MUCH_WORK;
+
+      // After a single internal step return to the caller
+      if (iResultflag == CV_SUCCESS && tret < tout)
+         return CV_SUCCESS;
+
+      // After tout has been reached, call CVode with CV_NORMAL to ensure consistent _cvodeMem
+      // it returns early after adjusting tret
+      if (iResultflag == CV_SUCCESS)
+      {
+         _step = 0;
+         iResultflag = advance(tout, tret, CV_NORMAL);
+      }
+   }
+   else
+   {
+      iResultflag = advance(tout, tret, CV_NORMAL);
+   }
+
+
+   //copy new solution vector
+#ifdef _OPENMP
+   double* _SolutionData = NV_DATA_OMP(_solution);
+#else
+   double* _SolutionData = NV_DATA_S(_solution);
+#endif
+
+   copySolution(_SolutionData, y);
+
+   _lastOutputTime = tret;
+   _sensitivitiesRetrieved = false;
+
+   if (iResultflag == CV_TSTOP_RETURN)
+      setNextStopTime(tret);
+
+   //quadratures at tret into _quadratures
+   if ((_numberOfQuadratures > 0) && ((iResultflag == CV_SUCCESS) || (iResultflag == CV_ROOT_RETURN) || (iResultflag == CV_TSTOP_RETURN)))
+   {
+      int quadratureResultflag = CVodeGetQuadDky(_cvodeMem, tret, 0, _quadratures);
+      if (quadratureResultflag != CV_SUCCESS)
+         return quadratureResultflag;
+   }
+
+   //no forward sensitivities (none requested or adjoint mode) - return
+   if ((_numberOfSensitivityParameters == 0) || _adjointSensitivities)
+      return iResultflag;
+
+   //if CVode call was not successful - return
+   //(sensitivities switched off or retrieved on demand only: no CVODES call)
+   if (((iResultflag != CV_SUCCESS) && (iResultflag != CV_ROOT_RETURN) && (iResultflag != CV_TSTOP_RETURN)) ||
+       !_sensitivityValues || !_sensitivitiesActive || _sensitivitiesOnDemand)
+      return iResultflag;
+
+   //sensitivities at tret into _sensitivityValues
+   int sensitivityResultflag = retrieveSensitivities();
+   sensitivitiesAvailable = (sensitivityResultflag == CV_SUCCESS);
+
+   return sensitivitiesAvailable ? iResultflag : sensitivityResultflag;
+}
+
+void SimModelSolver_CVODES::setupRootFinding()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupRootFinding";
+
+   _numberOfRootFunctions = _solverCallerCVODES ? _solverCallerCVODES->GetNumberOfRootFunctions() : 0;
+   if (_numberOfRootFunctions <= 0)
+   {
+      _numberOfRootFunctions = 0;
+      return;
+   }
+
+   if (CVodeRootInit(_cvodeMem, _numberOfRootFunctions, CVODE_RootFn) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeRootInit failed");
+
+   vector<int> directions(_numberOfRootFunctions, 0);
+   if (_solverCallerCVODES->GetRootDirections(&directions[0]))
+   {
+      if (CVodeSetRootDirection(_cvodeMem, &directions[0]) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetRootDirection failed");
+   }
+}
+
+void SimModelSolver_CVODES::setupQuadratures()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupQuadratures";
+
+   _numberOfQuadratures = _solverCallerCVODES ? max(_solverCallerCVODES->GetNumberOfQuadratures(), 0) : 0;
+   if (_numberOfQuadratures == 0)
+      return;
+
+#ifdef _OPENMP
+   _quadratures = N_VNew_OpenMP(_numberOfQuadratures, getNumberOfThreads());
+#else
+   _quadratures = N_VNew_Serial(_numberOfQuadratures);
+#endif
+   if (!_quadratures)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for quadratures");
+
+#ifdef _OPENMP
+   double* q0 = NV_DATA_OMP(_quadratures);
+#else
+   double* q0 = NV_DATA_S(_quadratures);
+#endif
+   for (int l = 0; l < _numberOfQuadratures; l++)
+      q0[l] = 0.0;
+   _solverCallerCVODES->GetQuadratureInitialValues(q0);
+
+   if (CVodeQuadInit(_cvodeMem, CVODE_QuadratureRhsFn, _quadratures) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeQuadInit failed");
+
+   //without error control the quadratures do not influence the step size selection
+   if (!_quadratureErrorControl)
+      return;
+
+   double absTol = *min_element(_absTol.begin(), _absTol.end());
+
+   if (CVodeQuadSStolerances(_cvodeMem, _relTol_CVODE, absTol) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeQuadSStolerances failed");
+
+   if (CVodeSetQuadErrCon(_cvodeMem, true) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetQuadErrCon failed");
+}
+
+int SimModelSolver_CVODES::GetNumberOfQuadratures()
+{
+   return _numberOfQuadratures;
+}
+
+void SimModelSolver_CVODES::GetQuadratures(double* q)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::GetQuadratures";
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (_numberOfQuadratures == 0)
+      return;
+
+#ifdef _OPENMP
+   memcpy(q, NV_DATA_OMP(_quadratures), _numberOfQuadratures * sizeof(double));
+#else
+   memcpy(q, NV_DATA_S(_quadratures), _numberOfQuadratures * sizeof(double));
+#endif
+}
+
+int SimModelSolver_CVODES::advance(double tout, double& tret, int itask)
+{
+   SolverInstrumentation::ScopedTimer timer(_instrumentation, SolverInstrumentation::INTEGRATION);
+
+   if (!_adjointSensitivities)
+      return CVode(_cvodeMem, tout, _solution, &tret, itask);
+
+   int iResultflag = CVodeF(_cvodeMem, tout, _solution, &tret, itask, &_adjointNumberOfCheckpoints);
+
+   if (iResultflag >= 0)
+      _adjointFinalTime = tret;
+
+   return iResultflag;
+}
+
+void SimModelSolver_CVODES::setupAdjointSensitivities()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupAdjointSensitivities";
+
+   if (!_adjointSensitivities)
+      return;
+
+   if (_numberOfSensitivityParameters == 0)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint sensitivities require sensitivity parameters");
+
+   if (!_solverCallerCVODES)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint sensitivities require a solver caller of type ISolverCaller_CVODES");
+
+   if (!_solverCallerCVODES->IsSet_ODEJacTransposeTimesVecFunction() && !_solverCaller->IsSet_ODEJacFunction())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint sensitivities require the jacobian or the transposed jacobian-vector product function");
+
+   //callbacks of the backward problem work in caller state order
+   if (!_statePermutation.empty())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint sensitivities cannot be combined with state reordering");
+
+   if (useSecondOrderAdjoint() && ((int)_hessianDirection.size() != _numberOfSensitivityParameters))
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Size of the Hessian direction does not match the number of sensitivity parameters");
+
+   //Memory: one Nordsieck history per checkpoint plus the interpolation data of the steps of ONE
+   //checkpoint interval (only the current interval is stored, earlier ones are recomputed during
+   //the backward solve). Half of the budget is used for the interpolation data, which determines the
+   //checkpoint interval; the other half limits the number of checkpoints to budget/2/checkpointMemory
+   if (_adjointMemoryBudget > 0.0)
+   {
+      double checkpointMemory, stepMemory;
+      adjointMemoryRequirements(checkpointMemory, stepMemory);
+
+      _adjointCheckpointSteps = (long)(0.5 * _adjointMemoryBudget / stepMemory);
+      if (_adjointCheckpointSteps < 1)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint memory budget is too small for the problem size");
+   }
+
+   //forward solution is stored every _adjointCheckpointSteps steps and interpolated in between
+   if (CVodeAdjInit(_cvodeMem, _adjointCheckpointSteps, _adjointInterpolation) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeAdjInit failed");
+
+   setupDirectionalSensitivity();
+
+   _adjointStartTime = _initialTime;
+   _adjointFinalTime = _initialTime;
+   _adjointNumberOfCheckpoints = 0;
+   _forwardRhsEvaluations = 0;
+   _adjointRecomputationRhsEvaluations = 0;
+}
+
+void SimModelSolver_CVODES::adjointMemoryRequirements(double& checkpointMemory, double& stepMemory)
+{
+   //the directional sensitivity (second order) is stored like y
+   double storedStates = (useSecondOrderAdjoint() ? 2.0 : 1.0) * _problemSize;
+
+   //checkpoint: Nordsieck array (maxOrd+1 vectors) and error weights of y and of the forward quadratures
+   checkpointMemory = (_maxOrd + 2.0) * (storedStates + _numberOfQuadratures) * sizeof(double);
+
+   //step: y and y' (Hermite) or y only (polynomial)
+   stepMemory = (_adjointInterpolation == CV_HERMITE ? 2.0 : 1.0) * storedStates * sizeof(double);
+}
+
+SimModelSolver_CVODES::AdjointStatistics SimModelSolver_CVODES::GetAdjointStatistics()
+{
+   AdjointStatistics statistics;
+
+   statistics.CheckpointSteps = _adjointCheckpointSteps;
+   statistics.NumberOfCheckpoints = _adjointNumberOfCheckpoints;
+
+   double checkpointMemory, stepMemory;
+   adjointMemoryRequirements(checkpointMemory, stepMemory);
+   statistics.EstimatedMemory = _adjointNumberOfCheckpoints * checkpointMemory + (_adjointCheckpointSteps + 1) * stepMemory;
+   statistics.MemoryBudgetExceeded = (_adjointMemoryBudget > 0.0) && (statistics.EstimatedMemory > _adjointMemoryBudget);
+
+   statistics.ForwardRhsEvaluations = _forwardRhsEvaluations - _adjointRecomputationRhsEvaluations;
+   statistics.RecomputationRhsEvaluations = _adjointRecomputationRhsEvaluations;
+
+   return statistics;
+}
+
+void SimModelSolver_CVODES::setupAdjointProblem()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupAdjointProblem";
+
+   //the solver caller may have changed since the last backward solve
+   _adjointJacobianValid = false;
+
+   //lambda(T)=0, dG/dp(T)=0
+   if (_adjointProblem >= 0)
+   {
+      N_VConst(0.0, _adjointValues);
+      N_VConst(0.0, _adjointQuadratures);
+
+      if (CVodeReInitB(_cvodeMem, _adjointProblem, _adjointFinalTime, _adjointValues) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeReInitB failed");
+      if (CVodeQuadReInitB(_cvodeMem, _adjointProblem, _adjointQuadratures) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeQuadReInitB failed");
+
+      return;
+   }
+
+   //second order: [lambda; mu] and [dG/dp; d2G/dp2*u]
+   int adjointBlocks = useSecondOrderAdjoint() ? 2 : 1;
+
+#ifdef _OPENMP
+   _adjointValues = N_VNew_OpenMP(adjointBlocks * _problemSize, getNumberOfThreads());
+   _adjointQuadratures = N_VNew_OpenMP(adjointBlocks * _numberOfSensitivityParameters, getNumberOfThreads());
+#else
+   _adjointValues = N_VNew_Serial(adjointBlocks * _problemSize);
+   _adjointQuadratures = N_VNew_Serial(adjointBlocks * _numberOfSensitivityParameters);
+#endif
+   if (!_adjointValues || !_adjointQuadratures)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for adjoint variables");
+
+   N_VConst(0.0, _adjointValues);
+   N_VConst(0.0, _adjointQuadratures);
+
+   _adjointObjectiveDerivativeY.resize(_problemSize);
+   _adjointObjectiveDerivativeP.resize(_numberOfSensitivityParameters);
+   _adjointParameters.resize(_numberOfSensitivityParameters);
+   _adjointYdot.resize(_problemSize);
+   _adjointPerturbedYdot.resize(_problemSize);
+
+   if (useSecondOrderAdjoint())
+   {
+      _secondOrderProduct.resize(max(_problemSize, _numberOfSensitivityParameters));
+      _secondOrderObjectiveDerivativeY.resize(_problemSize);
+      _secondOrderObjectiveDerivativeP.resize(_numberOfSensitivityParameters);
+   }
+
+   //dense jacobian of the caller for the dense backward jacobian and (if no caller product is set) for (df/dy)^T*v.
+   //Band and matrix-free backward solvers with the caller product need no N*N storage
+   if (_solverCaller->IsSet_ODEJacFunction() &&
+       ((GetLinearSolverMatrixType() == SUNMATRIX_DENSE) || !_solverCallerCVODES->IsSet_ODEJacTransposeTimesVecFunction()))
+   {
+      _adjointJacobian.resize((size_t)_problemSize * _problemSize);
+      _adjointJacobianColumns.resize(_problemSize);
+      for (int j = 0; j < _problemSize; j++)
+         _adjointJacobianColumns[j] = &_adjointJacobian[(size_t)j * _problemSize];
+      _adjointJacobianY.resize(_problemSize);
+      _adjointJacobianP.resize(_numberOfSensitivityParameters);
+   }
+
+   if (CVodeCreateB(_cvodeMem, _lmm, &_adjointProblem) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeCreateB failed");
+
+   //the second order RHS depend on the (interpolated) directional sensitivity
+   if (useSecondOrderAdjoint())
+   {
+      if (CVodeInitBS(_cvodeMem, _adjointProblem, CVODE_SecondOrderAdjointRhsFn, _adjointFinalTime, _adjointValues) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeInitBS failed");
+   }
+   else if (CVodeInitB(_cvodeMem, _adjointProblem, CVODE_AdjointRhsFn, _adjointFinalTime, _adjointValues) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeInitB failed");
+
+   if (CVodeSetUserDataB(_cvodeMem, _adjointProblem, CVODES_UserData) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetUserDataB failed");
+
+   //tolerances of the forward problem (scalar absolute tolerance: the adjoint variables have other units than y)
+   double absTol = *min_element(_absTol.begin(), _absTol.end());
+   if (CVodeSStolerancesB(_cvodeMem, _adjointProblem, _relTol_CVODE, absTol) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSStolerancesB failed");
+
+   if (CVodeSetMaxNumStepsB(_cvodeMem, _adjointProblem, _mxStep) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxNumStepsB failed");
+
+   setupAdjointLinearSolver(adjointBlocks);
+
+   if (useSecondOrderAdjoint())
+   {
+      if (CVodeQuadInitBS(_cvodeMem, _adjointProblem, CVODE_SecondOrderAdjointQuadratureRhsFn, _adjointQuadratures) != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeQuadInitBS failed");
+   }
+   else if (CVodeQuadInitB(_cvodeMem, _adjointProblem, CVODE_AdjointQuadratureRhsFn, _adjointQuadratures) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeQuadInitB failed");
+}
+
+void SimModelSolver_CVODES::setupAdjointLinearSolver(int adjointBlocks)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupAdjointLinearSolver";
+
+   //backward Newton matrix I+gamma*J^T (second order: block diagonal, see CVODE_AdjointJacFn)
+   //in the storage of the forward problem: dense, band (J^T: half bandwidths swapped) or,
+   //for Krylov and sparse forward solvers, matrix-free with the products -(df/dy)^T*v
+   int N = adjointBlocks * _problemSize;
+   int matrixType = GetLinearSolverMatrixType();
+
+   if (matrixType == SUNMATRIX_DENSE)
+   {
+      _adjointMatrix = SUNDenseMatrix(N, N);
+      if (_adjointMatrix)
+         _adjointLinearSolver = SUNLinSol_Dense(_adjointValues, _adjointMatrix);
+   }
+   else if (matrixType == SUNMATRIX_BAND)
+   {
+      _adjointMatrix = SUNBandMatrix(N, SUNBandMatrix_LowerBandwidth(_linearSolverMatrix), SUNBandMatrix_UpperBandwidth(_linearSolverMatrix));
+      if (_adjointMatrix)
+         _adjointLinearSolver = SUNLinSol_Band(_adjointValues, _adjointMatrix);
+   }
+   else
+   {
+      switch (_linearSolverType)
+      {
+      case LS_SPBCGS:
+         _adjointLinearSolver = SUNLinSol_SPBCGS(_adjointValues, _preconditioning, _maxKrylovDimension);
+         break;
+      case LS_SPTFQMR:
+         _adjointLinearSolver = SUNLinSol_SPTFQMR(_adjointValues, _preconditioning, _maxKrylovDimension);
+         break;
+      default:
+         _adjointLinearSolver = SUNLinSol_SPGMR(_adjointValues, _preconditioning, _maxKrylovDimension);
+         break;
+      }
+   }
+
+   if (((matrixType == SUNMATRIX_DENSE) || (matrixType == SUNMATRIX_BAND)) && !_adjointMatrix)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the adjoint jacobian");
+
+   if (!_adjointLinearSolver)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the adjoint linear solver");
+
+   if (CVodeSetLinearSolverB(_cvodeMem, _adjointProblem, _adjointLinearSolver, _adjointMatrix) != CVLS_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetLinearSolverB failed");
+
+   if (_adjointMatrix)
+   {
+      //without the dense jacobian of the caller, the backward jacobian is approximated by CVODES
+      if (_adjointJacobianColumns.empty())
+         return;
+
+      if (useSecondOrderAdjoint())
+      {
+         if (CVodeSetJacFnBS(_cvodeMem, _adjointProblem, CVODE_SecondOrderAdjointJacFn) != CVLS_SUCCESS)
+            throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacFnBS failed");
+      }
+      else if (CVodeSetJacFnB(_cvodeMem, _adjointProblem, CVODE_AdjointJacFn) != CVLS_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacFnB failed");
+
+      return;
+   }
+
+   //the backward RHS is linear in lambda: its jacobian-vector product is exact
+   if (useSecondOrderAdjoint())
+   {
+      if (CVodeSetJacTimesBS(_cvodeMem, _adjointProblem, NULL, CVODE_SecondOrderAdjointJacTimesVecFn) != CVLS_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacTimesBS failed");
+   }
+   else if (CVodeSetJacTimesB(_cvodeMem, _adjointProblem, NULL, CVODE_AdjointJacTimesVecFn) != CVLS_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetJacTimesB failed");
+
+   if (_preconditioning == PREC_NONE)
+      return;
+
+   //banded preconditioner of CVODES with the half bandwidths of the caller, swapped for J^T
+   //(the preconditioner functions of the caller approximate the forward Newton matrix)
+   int mu = min(max(_solverCaller->GetLowerHalfBandWidth(), 0), N - 1);
+   int ml = min(max(_solverCaller->GetUpperHalfBandWidth(), 0), N - 1);
+
+   switch (CVBandPrecInitB(_cvodeMem, _adjointProblem, N, mu, ml))
+   {
+   case CVLS_SUCCESS:
+      break;
+   case CVLS_MEM_FAIL:
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the adjoint banded preconditioner");
+   default:
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVBandPrecInitB failed");
+   }
+}
+
+void SimModelSolver_CVODES::freeAdjointProblem()
+{
+   //backward problems themselves are freed with the CVODES memory
+   _adjointProblem = -1;
+
+   if (_adjointValues)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_adjointValues);
+#else
+      N_VDestroy_Serial(_adjointValues);
+#endif
+      _adjointValues = NULL;
+   }
+
+   if (_adjointQuadratures)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_adjointQuadratures);
+#else
+      N_VDestroy_Serial(_adjointQuadratures);
+#endif
+      _adjointQuadratures = NULL;
+   }
+
+   if (_adjointLinearSolver)
+   {
+      SUNLinSolFree(_adjointLinearSolver);
+      _adjointLinearSolver = NULL;
+   }
+
+   if (_adjointMatrix)
+   {
+      SUNMatDestroy(_adjointMatrix);
+      _adjointMatrix = NULL;
+   }
+}
+
+int SimModelSolver_CVODES::ComputeAdjointGradient(double* gradient)
+{
+   return adjointObjectiveDerivatives("SimModelSolver_CVODES::ComputeAdjointGradient", gradient, NULL);
+}
+
+int SimModelSolver_CVODES::ComputeAdjointHessianVectorProduct(double* gradient, double* hessianVector)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::ComputeAdjointHessianVectorProduct";
+
+   if (!useSecondOrderAdjoint())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Hessian-vector product requires the solver option AdjointSensitivities and a Hessian direction");
+
+   return adjointObjectiveDerivatives(ERROR_SOURCE, gradient, hessianVector);
+}
+
+void SimModelSolver_CVODES::SetHessianDirection(const vector<double>& direction)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetHessianDirection";
+
+   if (_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Hessian direction must be set before Init");
+
+   _hessianDirection = direction;
+}
+
+int SimModelSolver_CVODES::adjointObjectiveDerivatives(const char* ERROR_SOURCE, double* gradient, double* hessianVector)
+{
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (!_adjointSensitivities)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver option AdjointSensitivities is not set");
+
+   if (!_solverCallerCVODES->IsSet_ObjectiveDerivativeFunction())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint gradient requires the objective derivative function");
+
+   //nothing integrated yet
+   if (_adjointFinalTime <= _adjointStartTime)
+   {
+      if (gradient)
+         fill(gradient, gradient + _numberOfSensitivityParameters, 0.0);
+      if (hessianVector)
+         fill(hessianVector, hessianVector + _numberOfSensitivityParameters, 0.0);
+      return CV_SUCCESS;
+   }
+
+   _adjointIntegralObjective = true;
+   setupAdjointProblem();
+
+   //backward from the last forward time to the start of the forward run
+   int iResultflag = integrateAdjointProblem(_adjointStartTime);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   copyAdjointQuadratures(gradient, hessianVector);
+
+   return CV_SUCCESS;
+}
+
+void SimModelSolver_CVODES::copyAdjointQuadratures(double* gradient, double* hessianVector)
+{
+#ifdef _OPENMP
+   const double* quadratures = NV_DATA_OMP(_adjointQuadratures);
+#else
+   const double* quadratures = NV_DATA_S(_adjointQuadratures);
+#endif
+
+   if (gradient)
+      copy(quadratures, quadratures + _numberOfSensitivityParameters, gradient);
+
+   //second order quadratures follow the gradient
+   if (hessianVector)
+      copy(quadratures + _numberOfSensitivityParameters, quadratures + 2 * _numberOfSensitivityParameters, hessianVector);
+}
+
+int SimModelSolver_CVODES::integrateAdjointProblem(double tBout)
+{
+   //the forward solution between the checkpoints is recomputed
+   long rhsEvaluations = _forwardRhsEvaluations;
+
+   int iResultflag = CVodeB(_cvodeMem, tBout, CV_NORMAL);
+
+   _adjointRecomputationRhsEvaluations += _forwardRhsEvaluations - rhsEvaluations;
+
+   if (iResultflag < 0)
+      return iResultflag;
+
+   double tret;
+   iResultflag = CVodeGetB(_cvodeMem, _adjointProblem, &tret, _adjointValues);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   return CVodeGetQuadB(_cvodeMem, _adjointProblem, &tret, _adjointQuadratures);
+}
+
+int SimModelSolver_CVODES::ComputeLeastSquaresObjective(const vector<double>& measurementTimes, const vector<int>& stateIndices,
+                                                        const double* observedValues, const double* weights,
+                                                        double& objective, double* gradient, double* hessianVector)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::ComputeLeastSquaresObjective";
+
+   int i, j, k, m;
+   int iResultflag;
+
+   objective = 0.0;
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (gradient && !_sensitivityValues && !_adjointSensitivities)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Objective gradient requires sensitivity parameters");
+
+   if (gradient && _sensitivityValues && !_sensitivitiesActive)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Objective gradient requires active forward sensitivities");
+
+   if (hessianVector && !useSecondOrderAdjoint())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Hessian-vector product requires the solver option AdjointSensitivities and a Hessian direction");
+
+   int numberOfTimes = (int)measurementTimes.size();
+   int numberOfStates = (int)stateIndices.size();
+
+   if (gradient)
+      fill(gradient, gradient + _numberOfSensitivityParameters, 0.0);
+   if (hessianVector)
+      fill(hessianVector, hessianVector + _numberOfSensitivityParameters, 0.0);
+
+   if ((numberOfTimes == 0) || (numberOfStates == 0))
+      return CV_SUCCESS;
+
+   if (!observedValues)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Observed values not set");
+
+   for (k = 1; k < numberOfTimes; k++)
+   {
+      if (measurementTimes[k] < measurementTimes[k - 1])
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Measurement times must be sorted in ascending order");
+   }
+
+   double currentTime;
+   long numberOfSteps;
+   iResultflag = CVodeGetCurrentTime(_cvodeMem, &currentTime);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   iResultflag = CVodeGetNumSteps(_cvodeMem, &numberOfSteps);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   if (measurementTimes[0] < currentTime)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Measurement times must not be before the current solver time");
+
+   //solver index of each measured state
+   vector<int> solverStates(stateIndices);
+   vector<int> solverIndices(_statePermutation.size());
+   for (i = 0; i < (int)_statePermutation.size(); i++)
+      solverIndices[_statePermutation[i]] = i;
+
+   for (m = 0; m < numberOfStates; m++)
+   {
+      if ((stateIndices[m] < 0) || (stateIndices[m] >= _problemSize))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid measured state index passed");
+      if (!_statePermutation.empty())
+         solverStates[m] = solverIndices[stateIndices[m]];
+   }
+
+   bool forwardGradient = gradient && _sensitivityValues;
+
+   //d(w*(y-d)^2)/dy of each measurement (adjoint: jumps of lambda at the measurement times)
+   vector<double> residualDerivatives((size_t)numberOfTimes * numberOfStates, 0.0);
+
+   //second order: 2*w*s, directional derivatives of the residual derivatives (jumps of mu)
+   vector<double> directionalResidualDerivatives;
+   if (hessianVector)
+      directionalResidualDerivatives.assign((size_t)numberOfTimes * numberOfStates, 0.0);
+
+#ifdef _OPENMP
+   const double* solutionData = NV_DATA_OMP(_solution);
+   const double* initialData = NV_DATA_OMP(_initialData);
+   const double* directionalSensitivityData = _directionalSensitivity ? NV_DATA_OMP(_directionalSensitivity[0]) : NULL;
+#else
+   const double* solutionData = NV_DATA_S(_solution);
+   const double* initialData = NV_DATA_S(_initialData);
+   const double* directionalSensitivityData = _directionalSensitivity ? NV_DATA_S(_directionalSensitivity[0]) : NULL;
+#endif
+
+   for (k = 0; k < numberOfTimes; k++)
+   {
+      double t = measurementTimes[k];
+      const double* y = solutionData;
+
+      //no step since Init/ReInit: CVode cannot return the current time, so the initial values are used
+      //(the forward sensitivities are the current ones: 0 after Init, continued after ReInit)
+      if ((numberOfSteps == 0) && (t <= currentTime))
+         y = initialData;
+      else
+      {
+         //roots and stop times before the measurement time are passed: the objective
+         //is defined over the whole measurement interval
+         double tret;
+         do
+         {
+            iResultflag = advance(t, tret, CV_NORMAL);
+            if (iResultflag < 0)
+               return iResultflag;
+            if (iResultflag == CV_TSTOP_RETURN)
+               setNextStopTime(tret);
+         } while (tret < t);
+
+         _lastOutputTime = tret;
+         _sensitivitiesRetrieved = false;
+
+         if (forwardGradient)
+         {
+            iResultflag = CVodeGetSensDky(_cvodeMem, t, 0, _sensitivityValues);
+            if (iResultflag != CV_SUCCESS)
+               return iResultflag;
+            _sensitivitiesRetrieved = true;
+         }
+
+         if (hessianVector)
+         {
+            iResultflag = CVodeGetSensDky(_cvodeMem, t, 0, _directionalSensitivity);
+            if (iResultflag != CV_SUCCESS)
+               return iResultflag;
+         }
+      }
+
+      const double* d = observedValues + (size_t)k * numberOfStates;
+      const double* w = weights ? weights + (size_t)k * numberOfStates : NULL;
+      double* residualDerivative = &residualDerivatives[(size_t)k * numberOfStates];
+
+      for (m = 0; m < numberOfStates; m++)
+      {
+         if (isnan(d[m]))
+            continue;
+
+         double weight = w ? w[m] : 1.0;
+         double residual = y[solverStates[m]] - d[m];
+
+         objective += weight * residual * residual;
+         residualDerivative[m] = 2.0 * weight * residual;
+
+         if (hessianVector)
+            directionalResidualDerivatives[(size_t)k * numberOfStates + m] = 2.0 * weight * directionalSensitivityData[solverStates[m]];
+
+         if (!forwardGradient)
+            continue;
+
+         for (int jS = 0; jS < numberOfForwardSensitivities(); jS++)
+         {
+            j = _forwardSensitivityParameters[jS];
+            gradient[j] += residualDerivative[m] * sensitivityData(j)[solverStates[m]];
+         }
+      }
+   }
+
+   if ((!gradient && !hessianVector) || forwardGradient)
+      return CV_SUCCESS;
+
+   return leastSquaresAdjointGradient(measurementTimes, solverStates, residualDerivatives, directionalResidualDerivatives,
+                                      gradient, hessianVector);
+}
+
+int SimModelSolver_CVODES::leastSquaresAdjointGradient(const vector<double>& measurementTimes, const vector<int>& solverStates,
+                                                       const vector<double>& residualDerivatives, const vector<double>& directionalResidualDerivatives,
+                                                       double* gradient, double* hessianVector)
+{
+   int numberOfStates = (int)solverStates.size();
+   int iResultflag;
+
+   //measurements at the start of the forward run do not contribute (initial values do not depend on p)
+   if (_adjointFinalTime <= _adjointStartTime)
+      return CV_SUCCESS;
+
+   //lambda=0 at the last measurement time, no integrand between the measurements
+   _adjointIntegralObjective = false;
+   setupAdjointProblem();
+
+#ifdef _OPENMP
+   double* lambda = NV_DATA_OMP(_adjointValues);
+#else
+   double* lambda = NV_DATA_S(_adjointValues);
+#endif
+   //second order adjoint variables follow lambda
+   double* mu = lambda + _problemSize;
+
+   double tB = _adjointFinalTime;
+
+   for (int k = (int)measurementTimes.size() - 1; k >= 0; k--)
+   {
+      double t = measurementTimes[k];
+      if (t <= _adjointStartTime)
+         break;
+
+      if (t < tB)
+      {
+         iResultflag = integrateAdjointProblem(t);
+         if (iResultflag != CV_SUCCESS)
+            return iResultflag;
+         tB = t;
+      }
+
+      //lambda(t_k-) = lambda(t_k+) + d(w*(y-d)^2)/dy(t_k)
+      const double* residualDerivative = &residualDerivatives[(size_t)k * numberOfStates];
+      for (int m = 0; m < numberOfStates; m++)
+         lambda[solverStates[m]] += residualDerivative[m];
+
+      //mu(t_k-) = mu(t_k+) + d2(w*(y-d)^2)/dy2(t_k)*s(t_k)
+      if (hessianVector)
+      {
+         const double* directionalResidualDerivative = &directionalResidualDerivatives[(size_t)k * numberOfStates];
+         for (int m = 0; m < numberOfStates; m++)
+            mu[solverStates[m]] += directionalResidualDerivative[m];
+      }
+
+      //restart the backward problem after the last measurement at t
+      if ((k > 0) && (measurementTimes[k - 1] == t))
+         continue;
+
+      iResultflag = CVodeReInitB(_cvodeMem, _adjointProblem, t, _adjointValues);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+
+      iResultflag = CVodeQuadReInitB(_cvodeMem, _adjointProblem, _adjointQuadratures);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   if (tB > _adjointStartTime)
+   {
+      iResultflag = integrateAdjointProblem(_adjointStartTime);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   copyAdjointQuadratures(gradient, hessianVector);
+
+   return CV_SUCCESS;
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::adjointJacobian(double t, const double* y, const double* p)
+{
+   //the backward RHS (all Newton iterations of a step) and the backward jacobian are evaluated
+   //at the same forward solution: the jacobian is only rebuilt if (t, y, p) changed
+   if (_adjointJacobianValid && (t == _adjointJacobianTime) && equal(y, y + _problemSize, _adjointJacobianY.begin()) &&
+       equal(p, p + _numberOfSensitivityParameters, _adjointJacobianP.begin()))
+      return JACOBIAN_OK;
+
+   _adjointJacobianValid = false;
+   fill(_adjointJacobian.begin(), _adjointJacobian.end(), 0.0);
+
+   if (_solverCaller->ODERhsFunction(t, y, p, &_adjointYdot[0], NULL) != RHS_OK)
+      return JACOBIAN_RECOVERABLE_ERROR;
+
+   Jacobian_Return_Value RetVal = _solverCaller->ODEJacFunction(t, y, p, &_adjointYdot[0], &_adjointJacobianColumns[0], NULL);
+   if (RetVal != JACOBIAN_OK)
+      return RetVal;
+
+   _adjointJacobianTime = t;
+   copy(y, y + _problemSize, _adjointJacobianY.begin());
+   copy(p, p + _numberOfSensitivityParameters, _adjointJacobianP.begin());
+   _adjointJacobianValid = true;
+
+   return JACOBIAN_OK;
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::jacobianTransposeTimesVector(double t, const double* y, const double* p, const double* v, double* JTv)
+{
+   if (_solverCallerCVODES->IsSet_ODEJacTransposeTimesVecFunction())
+      return _solverCallerCVODES->ODEJacTransposeTimesVecFunction(t, y, p, v, JTv, NULL);
+
+   Jacobian_Return_Value RetVal = adjointJacobian(t, y, p);
+   if (RetVal != JACOBIAN_OK)
+      return RetVal;
+
+   //(J^T*v)_j = column j of J times v
+   for (int j = 0; j < _problemSize; j++)
+   {
+      const double* column = _adjointJacobianColumns[j];
+      double sum = 0.0;
+      for (int i = 0; i < _problemSize; i++)
+         sum += column[i] * v[i];
+      JTv[j] = sum;
+   }
+
+   return JACOBIAN_OK;
+}
+
+Jacobian_Return_Value SimModelSolver_CVODES::parameterJacobianTransposeTimesVector(double t, const double* y, const double* p, const double* v, double* fpTv)
+{
+   if (_solverCallerCVODES->IsSet_ODEParameterJacTransposeTimesVecFunction())
+      return _solverCallerCVODES->ODEParameterJacTransposeTimesVecFunction(t, y, p, v, fpTv, NULL);
+
+   //forward difference quotients df/dp_j, increments as used by CVODES for the sensitivity RHS
+   if (_solverCaller->ODERhsFunction(t, y, p, &_adjointYdot[0], NULL) != RHS_OK)
+      return JACOBIAN_RECOVERABLE_ERROR;
+
+   copy(p, p + _numberOfSensitivityParameters, _adjointParameters.begin());
+   const double* scalingFactors = CVODES_UserData->ScalingFactors;
+
+   for (int j = 0; j < _numberOfSensitivityParameters; j++)
+   {
+      double increment = sqrt(max(_relTol_CVODE, UNIT_ROUNDOFF)) * max(fabs(p[j]), scalingFactors[j]);
+
+      _adjointParameters[j] = p[j] + increment;
+      Rhs_Return_Value RetVal = _solverCaller->ODERhsFunction(t, y, &_adjointParameters[0], &_adjointPerturbedYdot[0], NULL);
+      _adjointParameters[j] = p[j];
+
+      if (RetVal != RHS_OK)
+         return JACOBIAN_RECOVERABLE_ERROR;
+
+      double sum = 0.0;
+      for (int i = 0; i < _problemSize; i++)
+         sum += (_adjointPerturbedYdot[i] - _adjointYdot[i]) * v[i];
+      fpTv[j] = sum / increment;
+   }
+
+   return JACOBIAN_OK;
+}
+
+bool SimModelSolver_CVODES::useSecondOrderAdjoint()
+{
+   return _adjointSensitivities && !_hessianDirection.empty();
+}
+
+void SimModelSolver_CVODES::setupDirectionalSensitivity()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupDirectionalSensitivity";
+
+   if (!useSecondOrderAdjoint())
+      return;
+
+   _secondOrderY.resize(_problemSize);
+   _secondOrderP.resize(_numberOfSensitivityParameters);
+
+   //s(t0)=(dy0/dp)*u=0 (initial values do not depend on the sensitivity parameters)
+#ifdef _OPENMP
+   _directionalSensitivity = N_VCloneVectorArray_OpenMP(1, _initialData);
+#else
+   _directionalSensitivity = N_VCloneVectorArray_Serial(1, _initialData);
+#endif
+   if (_directionalSensitivity == NULL)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for the directional sensitivity");
+
+   N_VConst(0.0, _directionalSensitivity[0]);
+
+   //one sensitivity with its own RHS: s' = (df/dy)*s + (df/dp)*u.
+   //It is stored in the checkpoints and passed to the backward problem by CVODES
+   if (CVodeSensInit1(_cvodeMem, 1, CV_STAGGERED, CVODE_DirectionalSensitivityRhsFn, _directionalSensitivity) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensInit1 failed");
+
+   if (CVodeSensEEtolerances(_cvodeMem) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSensEEtolerances failed");
+
+   if (CVodeSetSensErrCon(_cvodeMem, _sensitivityErrorControl) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetSensErrCon failed");
+}
+
+double SimModelSolver_CVODES::directionalPerturbation(const double* y, const double* s, const double* p)
+{
+   const double* scalingFactors = CVODES_UserData->ScalingFactors;
+   int i, j;
+
+   //size of (s,u) relative to (y,p)
+   double scale = 0.0;
+   for (i = 0; i < _problemSize; i++)
+      scale = max(scale, fabs(s[i]) / max(fabs(y[i]), _absTol[i]));
+   for (j = 0; j < _numberOfSensitivityParameters; j++)
+      scale = max(scale, fabs(_hessianDirection[j]) / max(fabs(p[j]), scalingFactors[j]));
+
+   if (scale == 0.0)
+      return 0.0;
+
+   //relative perturbation as used by CVODES for the difference quotient sensitivity RHS
+   double epsilon = sqrt(max(_relTol_CVODE, UNIT_ROUNDOFF)) / scale;
+
+   for (i = 0; i < _problemSize; i++)
+      _secondOrderY[i] = y[i] + epsilon * s[i];
+   for (j = 0; j < _numberOfSensitivityParameters; j++)
+      _secondOrderP[j] = p[j] + epsilon * _hessianDirection[j];
+
+   return epsilon;
+}
+
+int SimModelSolver_CVODES::secondOrderAdjointRhs(double t, const double* y, const double* s, const double* p, const double* yB, double* yBdot)
+{
+   const double* lambda = yB;
+   const double* mu = yB + _problemSize;
+   double* lambdaDot = yBdot;
+   double* muDot = yBdot + _problemSize;
+
+   double* dgdy = &_adjointObjectiveDerivativeY[0];
+   double* perturbedJTlambda = &_secondOrderProduct[0];
+   double* perturbedDgdy = &_secondOrderObjectiveDerivativeY[0];
+
+   //(df/dy)^T*lambda, (df/dy)^T*mu and dg/dy at (y,p)
+   if (jacobianTransposeTimesVector(t, y, p, lambda, lambdaDot) != JACOBIAN_OK)
+      return 1;
+   if (jacobianTransposeTimesVector(t, y, p, mu, muDot) != JACOBIAN_OK)
+      return 1;
+   if (_adjointIntegralObjective && (_solverCallerCVODES->ObjectiveDerivativeFunction(t, y, p, dgdy, &_adjointObjectiveDerivativeP[0]) != RHS_OK))
+      return 1;
+
+   //the same at (y+epsilon*s, p+epsilon*u)
+   double epsilon = directionalPerturbation(y, s, p);
+   if (epsilon > 0.0)
+   {
+      const double* y2 = &_secondOrderY[0];
+      const double* p2 = &_secondOrderP[0];
+
+      if (jacobianTransposeTimesVector(t, y2, p2, lambda, perturbedJTlambda) != JACOBIAN_OK)
+         return 1;
+      if (_adjointIntegralObjective && (_solverCallerCVODES->ObjectiveDerivativeFunction(t, y2, p2, perturbedDgdy, &_secondOrderObjectiveDerivativeP[0]) != RHS_OK))
+         return 1;
+   }
+
+   //lambda' = -(df/dy)^T*lambda - (dg/dy)^T
+   //mu'     = -(df/dy)^T*mu - d/d(s,u) [(df/dy)^T*lambda + (dg/dy)^T]
+   for (int i = 0; i < _problemSize; i++)
+   {
+      double dgdyi = _adjointIntegralObjective ? dgdy[i] : 0.0;
+      double directionalDerivative = 0.0;
+
+      if (epsilon > 0.0)
+      {
+         directionalDerivative = perturbedJTlambda[i] - lambdaDot[i];
+         if (_adjointIntegralObjective)
+            directionalDerivative += perturbedDgdy[i] - dgdyi;
+         directionalDerivative /= epsilon;
+      }
+
+      muDot[i] = -muDot[i] - directionalDerivative;
+      lambdaDot[i] = -lambdaDot[i] - dgdyi;
+   }
+
+   return 0;
+}
+
+int SimModelSolver_CVODES::secondOrderAdjointQuadratureRhs(double t, const double* y, const double* s, const double* p, const double* yB, double* qBdot)
+{
+   const double* lambda = yB;
+   const double* mu = yB + _problemSize;
+   double* gradientDot = qBdot;
+   double* hessianVectorDot = qBdot + _numberOfSensitivityParameters;
+
+   double* dgdp = &_adjointObjectiveDerivativeP[0];
+   double* perturbedFpTlambda = &_secondOrderProduct[0];
+   double* perturbedDgdp = &_secondOrderObjectiveDerivativeP[0];
+
+   //(df/dp)^T*lambda, (df/dp)^T*mu and dg/dp at (y,p)
+   if (parameterJacobianTransposeTimesVector(t, y, p, lambda, gradientDot) != JACOBIAN_OK)
+      return 1;
+   if (parameterJacobianTransposeTimesVector(t, y, p, mu, hessianVectorDot) != JACOBIAN_OK)
+      return 1;
+   if (_adjointIntegralObjective && (_solverCallerCVODES->ObjectiveDerivativeFunction(t, y, p, &_adjointObjectiveDerivativeY[0], dgdp) != RHS_OK))
+      return 1;
+
+   //the same at (y+epsilon*s, p+epsilon*u)
+   double epsilon = directionalPerturbation(y, s, p);
+   if (epsilon > 0.0)
+   {
+      const double* y2 = &_secondOrderY[0];
+      const double* p2 = &_secondOrderP[0];
+
+      if (parameterJacobianTransposeTimesVector(t, y2, p2, lambda, perturbedFpTlambda) != JACOBIAN_OK)
+         return 1;
+      if (_adjointIntegralObjective && (_solverCallerCVODES->ObjectiveDerivativeFunction(t, y2, p2, &_secondOrderObjectiveDerivativeY[0], perturbedDgdp) != RHS_OK))
+         return 1;
+   }
+
+   //(dG/dp)'       = -((df/dp)^T*lambda + dg/dp)
+   //(d2G/dp2*u)'   = -((df/dp)^T*mu + d/d(s,u) [(df/dp)^T*lambda + dg/dp])
+   for (int j = 0; j < _numberOfSensitivityParameters; j++)
+   {
+      double dgdpj = _adjointIntegralObjective ? dgdp[j] : 0.0;
+      double directionalDerivative = 0.0;
+
+      if (epsilon > 0.0)
+      {
+         directionalDerivative = perturbedFpTlambda[j] - gradientDot[j];
+         if (_adjointIntegralObjective)
+            directionalDerivative += perturbedDgdp[j] - dgdpj;
+         directionalDerivative /= epsilon;
+      }
+
+      hessianVectorDot[j] = -hessianVectorDot[j] - directionalDerivative;
+      gradientDot[j] = -gradientDot[j] - dgdpj;
+   }
+
+   return 0;
+}
+
+void SimModelSolver_CVODES::SetStopTimes(const vector<double>& stopTimes)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetStopTimes";
+
+   for (size_t k = 1; k < stopTimes.size(); k++)
+   {
+      if (stopTimes[k] < stopTimes[k - 1])
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Stop times must be sorted in ascending order");
+   }
+
+   _stopTimes = stopTimes;
+   _nextStopTime = 0;
+}
+
+void SimModelSolver_CVODES::setNextStopTime(double t)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setNextStopTime";
+
+   _nextStopTime = upper_bound(_stopTimes.begin(), _stopTimes.end(), t) - _stopTimes.begin();
+
+   //no further stop time: CVODES has already deactivated the last one when it was reached
+   if (_nextStopTime >= _stopTimes.size())
+      return;
+
+   if (CVodeSetStopTime(_cvodeMem, _stopTimes[_nextStopTime]) != CV_SUCCESS)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetStopTime failed");
+}
+
+int SimModelSolver_CVODES::GetRootInfo(vector<int>& rootsFound)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::GetRootInfo";
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   rootsFound.assign(_numberOfRootFunctions, 0);
+   if (_numberOfRootFunctions == 0)
+      return CV_SUCCESS;
+
+   return CVodeGetRootInfo(_cvodeMem, &rootsFound[0]);
+}
+
+void SimModelSolver_CVODES::copySolution(const double* solverValues, double* y)
+{
+   if (_observedStates.empty())
+   {
+      for (int i = 0; i < _problemSize; i++)
+         y[callerStateIndex(i)] = solverValues[i];
+   }
+   else
+   {
+      for (size_t m = 0; m < _observedStates.size(); m++)
+         y[_observedStates[m]] = solverValues[_observedSolverStates[m]];
+   }
+}
+
+int SimModelSolver_CVODES::getSensitivities(double t)
+{
+   //all parameters at once (CVodeGetSens is CVodeGetSensDky at tret)
+   if ((int)_outputSensitivityParameters.size() == numberOfForwardSensitivities())
+      return CVodeGetSensDky(_cvodeMem, t, 0, _sensitivityValues);
+
+   for (int j : _outputSensitivityParameters)
+   {
+      int k = _forwardSensitivityIndex[j];
+      int flag = CVodeGetSensDky1(_cvodeMem, t, 0, k, _sensitivityValues[k]);
+      if (flag != CV_SUCCESS)
+         return flag;
+   }
+
+   return CV_SUCCESS;
+}
+
+int SimModelSolver_CVODES::numberOfOutputStates()
+{
+   return _observedStates.empty() ? _problemSize : (int)_observedStates.size();
+}
+
+int SimModelSolver_CVODES::outputCallerState(int m)
+{
+   return _observedStates.empty() ? callerStateIndex(m) : _observedStates[m];
+}
+
+int SimModelSolver_CVODES::outputSolverState(int m)
+{
+   return _observedStates.empty() ? m : _observedSolverStates[m];
+}
+
+void SimModelSolver_CVODES::SetObservedStates(const vector<int>& stateIndices)
+{
+   _observedStates = stateIndices;
+
+   if (_initialized)
+      setupObservedOutput();
+}
+
+void SimModelSolver_CVODES::SetObservedSensitivityParameters(const vector<int>& parameterIndices)
+{
+   _observedSensitivityParameters = parameterIndices;
+
+   if (_initialized)
+      setupObservedOutput();
+}
+
+void SimModelSolver_CVODES::setupObservedOutput()
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::setupObservedOutput";
+   int i;
+
+   vector<int> solverStateIndex(_problemSize);
+   for (i = 0; i < _problemSize; i++)
+      solverStateIndex[callerStateIndex(i)] = i;
+
+   _observedSolverStates.resize(_observedStates.size());
+   for (size_t m = 0; m < _observedStates.size(); m++)
+   {
+      if ((_observedStates[m] < 0) || (_observedStates[m] >= _problemSize))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid observed state index passed");
+      _observedSolverStates[m] = solverStateIndex[_observedStates[m]];
+   }
+
+   //only parameters with forward sensitivities (see SetSensitivityParameterList)
+   _outputSensitivityParameters.clear();
+   if (_observedSensitivityParameters.empty())
+      _outputSensitivityParameters = _forwardSensitivityParameters;
+   else
+   {
+      for (int j : _observedSensitivityParameters)
+      {
+         if ((j < 0) || (j >= _numberOfSensitivityParameters))
+            throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid observed sensitivity parameter index passed");
+         if (_forwardSensitivityIndex[j] >= 0)
+            _outputSensitivityParameters.push_back(j);
+      }
+   }
+}
+
+const double* SimModelSolver_CVODES::sensitivityData(int parameterIndex)
+{
+#ifdef _OPENMP
+   return NV_DATA_OMP(_sensitivityValues[_forwardSensitivityIndex[parameterIndex]]);
+#else
+   return NV_DATA_S(_sensitivityValues[_forwardSensitivityIndex[parameterIndex]]);
+#endif
+}
+
+int SimModelSolver_CVODES::PerformSolverStep(double tout, double* y, double** yS, double& tret, STEP_MODE step_mode)
+{
+   //tile size (number of states and of parameters) of the transposing copy below
+   const int TILE_SIZE = 32;
+
+   SolverInstrumentation::ScopedTimer timer(_instrumentation, SolverInstrumentation::SOLVER_STEP);
+
+   bool sensitivitiesAvailable;
+   int iResultflag = performSolverStep(tout, y, tret, step_mode, sensitivitiesAvailable);
+
+   if (!sensitivitiesAvailable)
+      return iResultflag;
+
+   //copy sensitivity values 
+   //at the end; yS[i][j]=dy_i/dp_j
+   //Sensitivities are stored parameter-major, so the copy is a transposition: done in
+   //TILE_SIZE x TILE_SIZE tiles, so that both the read and the written cache lines of a tile stay in cache
+   int numberOfStates = numberOfOutputStates();
+   int numberOfParameters = (int)_outputSensitivityParameters.size();
+
+   for (int stateTile = 0; stateTile < numberOfStates; stateTile += TILE_SIZE)
+   {
+      int stateTileEnd = min(stateTile + TILE_SIZE, numberOfStates);
+
+      for (int parameterTile = 0; parameterTile < numberOfParameters; parameterTile += TILE_SIZE)
+      {
+         int parameterTileEnd = min(parameterTile + TILE_SIZE, numberOfParameters);
+
+         for (int p = parameterTile; p < parameterTileEnd; p++)
+         {
+            int j = _outputSensitivityParameters[p];
+            const double* data = sensitivityData(j);
+
+            for (int m = stateTile; m < stateTileEnd; m++)
+               yS[outputCallerState(m)][j] = data[outputSolverState(m)];
+         }
+      }
+   }
+
+   //return value of CVode call
+   return iResultflag;
+}
+
+int SimModelSolver_CVODES::PerformSolverStepContiguous(double tout, double* y, double* yS, double& tret, STEP_MODE step_mode)
+{
+   SolverInstrumentation::ScopedTimer timer(_instrumentation, SolverInstrumentation::SOLVER_STEP);
+
+   bool sensitivitiesAvailable;
+   int iResultflag = performSolverStep(tout, y, tret, step_mode, sensitivitiesAvailable);
+
+   if (!sensitivitiesAvailable || !yS)
+      return iResultflag;
+
+   copySensitivitiesContiguous(yS);
+
+   return iResultflag;
+}
+
+void SimModelSolver_CVODES::copySensitivitiesContiguous(double* yS)
+{
+   //yS[j*N+i]=dy_i/dp_j: same layout as _sensitivityValues
+   for (int j : _outputSensitivityParameters)
+   {
+      const double* data = sensitivityData(j);
+      double* ySj = yS + (size_t)j * _problemSize;
+
+      if (_statePermutation.empty() && _observedStates.empty())
+         memcpy(ySj, data, _problemSize * sizeof(double));
+      else
+      {
+         for (int m = 0; m < numberOfOutputStates(); m++)
+            ySj[outputCallerState(m)] = data[outputSolverState(m)];
+      }
+   }
+}
+
+int SimModelSolver_CVODES::retrieveSensitivities()
+{
+   if (_sensitivitiesRetrieved)
+      return CV_SUCCESS;
+
+   int iResultflag = getSensitivities(_lastOutputTime);
+   _sensitivitiesRetrieved = (iResultflag == CV_SUCCESS);
+
+   return iResultflag;
+}
+
+int SimModelSolver_CVODES::GetSensitivities(double* yS)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::GetSensitivities";
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   //adjoint mode: no forward sensitivities
+   if (_adjointSensitivities || (numberOfForwardSensitivities() == 0))
+      return CV_NO_SENS;
+
+   if (!_sensitivityValues || !_sensitivitiesActive)
+      return CV_NO_SENS;
+
+   int iResultflag = retrieveSensitivities();
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   copySensitivitiesContiguous(yS);
+
+   return CV_SUCCESS;
+}
+
+bool SimModelSolver_CVODES::GetSensitivitiesActive()
+{
+   return _sensitivitiesActive;
+}
+
+int SimModelSolver_CVODES::SetSensitivitiesActive(bool active, bool resetSensitivities)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetSensitivitiesActive";
+   int iResultflag;
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (_adjointSensitivities)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Not available with adjoint sensitivities");
+
+   if ((numberOfForwardSensitivities() == 0) || !_sensitivityValues)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "No forward sensitivities are calculated");
+
+   if (active == _sensitivitiesActive)
+      return CV_SUCCESS;
+
+   //no step since Init/ReInit: _sensitivityValues and _initialData are the current values
+   //(CVodeGetDky/CVodeGetSensDky are not available before the first step)
+   long numberOfSteps;
+   iResultflag = CVodeGetNumSteps(_cvodeMem, &numberOfSteps);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   if (!active)
+   {
+      //all sensitivities at tret (not only the observed ones) are kept to be carried over
+      if (numberOfSteps > 0)
+      {
+         iResultflag = CVodeGetSensDky(_cvodeMem, _lastOutputTime, 0, _sensitivityValues);
+         if (iResultflag != CV_SUCCESS)
+            return iResultflag;
+      }
+
+      //the sensitivity counters are not available while switched off
+      _inactiveSensitivityStatistics = currentSolverStatistics();
+
+      //the integration continues with the states only (no restart)
+      iResultflag = CVodeSensToggleOff(_cvodeMem);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+
+      _sensitivitiesActive = false;
+      _sensitivitiesRetrieved = false;
+
+      return CV_SUCCESS;
+   }
+
+   //the sensitivity history is not available: restart at tret with the current states
+   if (numberOfSteps > 0)
+   {
+      iResultflag = CVodeGetDky(_cvodeMem, _lastOutputTime, 0, _solution);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+   else
+      N_VScale(1.0, _initialData, _solution);
+
+   if ((_numberOfQuadratures > 0) && (numberOfSteps > 0))
+   {
+      iResultflag = CVodeGetQuadDky(_cvodeMem, _lastOutputTime, 0, _quadratures);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   accumulateSolverStatistics();
+
+   iResultflag = CVodeReInit(_cvodeMem, _lastOutputTime, _solution);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   if (_numberOfQuadratures > 0)
+   {
+      iResultflag = CVodeQuadReInit(_cvodeMem, _quadratures);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+   }
+
+   setNextStopTime(_lastOutputTime);
+
+   if (resetSensitivities)
+   {
+      for (int k = 0; k < numberOfForwardSensitivities(); k++)
+         N_VConst(0.0, _sensitivityValues[k]);
+   }
+
+   iResultflag = CVodeSensReInit(_cvodeMem, _usedSensitivityMethod, _sensitivityValues);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   _sensitivitiesActive = true;
+   _sensitivitiesRetrieved = true;
+
+   return CV_SUCCESS;
+}
+
+int SimModelSolver_CVODES::PerformSolverSteps(const double* outputTimes, int numberOfOutputTimes, double* y, double* yS,
+                                              int& numberOfOutputTimesReached, double* quadratures)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::PerformSolverSteps";
+
+   numberOfOutputTimesReached = 0;
+
+   if (!_initialized)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+   if (numberOfOutputTimes <= 0)
+      return CV_SUCCESS;
+
+   SolverInstrumentation::ScopedTimer timer(_instrumentation, SolverInstrumentation::SOLVER_STEP);
+
+   for (int k = 1; k < numberOfOutputTimes; k++)
+   {
+      if (outputTimes[k] < outputTimes[k - 1])
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Output times must be sorted in ascending order");
+   }
+
+   double tFinal = outputTimes[numberOfOutputTimes - 1];
+   bool withSensitivities = (_sensitivityValues != NULL) && (yS != NULL) && _sensitivitiesActive;
+
+#ifdef _OPENMP
+   const double* solutionData = NV_DATA_OMP(_solution);
+#else
+   const double* solutionData = NV_DATA_S(_solution);
+#endif
+
+   int iResultflag = CV_SUCCESS;
+   int k = 0;
+   double tret;
+
+   _step = 0;
+
+   //the integration may already be past the first output times (internal step of a previous
+   //PerformSolverStep(NORMAL)/PerformSolverSteps call or a root inside the last step):
+   //these are interpolated from the last step before advancing
+   long numberOfSteps = 0;
+   bool stepRequired = true;
+
+   iResultflag = CVodeGetNumSteps(_cvodeMem, &numberOfSteps);
+   if (iResultflag != CV_SUCCESS)
+      return iResultflag;
+
+   if (numberOfSteps > 0)
+   {
+      iResultflag = CVodeGetCurrentTime(_cvodeMem, &tret);
+      if (iResultflag != CV_SUCCESS)
+         return iResultflag;
+
+      stepRequired = false;
+   }
+
+   //one internal step at a time; all output times passed by the step are interpolated
+   //from the Nordsieck history of CVODES (no extra RHS evaluations)
+   while (k < numberOfOutputTimes)
+   {
+      int eventResultflag = CV_SUCCESS;
+
+      if (stepRequired)
+      {
+         iResultflag = advance(tFinal, tret, CV_ONE_STEP);
+         if (iResultflag < 0)
+            return iResultflag;
+
+         //tret is the root/stop time: output times up to it are filled, then the caller handles the event
+         if ((iResultflag == CV_ROOT_RETURN) || (iResultflag == CV_TSTOP_RETURN))
+            eventResultflag = iResultflag;
+         if (iResultflag == CV_TSTOP_RETURN)
+            setNextStopTime(tret);
+
+         _step++;
+      }
+      stepRequired = true;
+
+      for (; (k < numberOfOutputTimes) && (outputTimes[k] <= tret); k++)
+      {
+         _step = 0;
+
+         //_solution is only an output of CVode and can be used as interpolation target
+         iResultflag = CVodeGetDky(_cvodeMem, outputTimes[k], 0, _solution);
+         if (iResultflag != CV_SUCCESS)
+            return iResultflag;
+
+         copySolution(solutionData, y + (size_t)k * _problemSize);
+
+         _lastOutputTime = outputTimes[k];
+         _sensitivitiesRetrieved = false;
+
+         if (quadratures && (_numberOfQuadratures > 0))
+         {
+            iResultflag = CVodeGetQuadDky(_cvodeMem, outputTimes[k], 0, _quadratures);
+            if (iResultflag != CV_SUCCESS)
+               return iResultflag;
+
+#ifdef _OPENMP
+            memcpy(quadratures + (size_t)k * _numberOfQuadratures, NV_DATA_OMP(_quadratures), _numberOfQuadratures * sizeof(double));
+#else
+            memcpy(quadratures + (size_t)k * _numberOfQuadratures, NV_DATA_S(_quadratures), _numberOfQuadratures * sizeof(double));
+#endif
+         }
+
+         if (withSensitivities)
+         {
+            iResultflag = retrieveSensitivities();
+            if (iResultflag != CV_SUCCESS)
+               return iResultflag;
+
+            //yS[(k*N+i)*Ns+j]=dy_i/dp_j(t_k)
+            double* ySk = yS + (size_t)k * _problemSize * _numberOfSensitivityParameters;
+            for (int j : _outputSensitivityParameters)
+            {
+               const double* data = sensitivityData(j);
+               for (int m = 0; m < numberOfOutputStates(); m++)
+                  ySk[(size_t)outputCallerState(m) * _numberOfSensitivityParameters + j] = data[outputSolverState(m)];
+            }
+         }
+
+         numberOfOutputTimesReached = k + 1;
+      }
+
+      if (eventResultflag != CV_SUCCESS)
+         return eventResultflag;
+
+      //same limit as for SINGLE step mode: max. number of internal steps between two output times
+      if (_mxStep != 0 && _step > _mxStep)
+         return CV_TOO_MUCH_WORK;
+   }
+
+   return CV_SUCCESS;
+}
+
+const double* SimModelSolver_CVODES::GetSensitivityValues(int parameterIndex)
+{
+   if (!_initialized || !_sensitivityValues || !_sensitivitiesActive || (parameterIndex < 0) || (parameterIndex >= _numberOfSensitivityParameters))
+      return NULL;
+
+   //values are in solver state order
+   if (!_statePermutation.empty())
+      return NULL;
+
+   //not updated if not observed
+   if (find(_outputSensitivityParameters.begin(), _outputSensitivityParameters.end(), parameterIndex) == _outputSensitivityParameters.end())
+      return NULL;
+
+   //SensitivitiesOnDemand: first request after the solver step
+   if (retrieveSensitivities() != CV_SUCCESS)
+      return NULL;
+
+   return sensitivityData(parameterIndex);
+}
+
+int SimModelSolver_CVODES::ReInit(double t0, const vector < double >& y0)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::ReInit";
+
+   int iResultFlag;
+
+   //call basis class ReInit first (common part)
+   iResultFlag = SimModelSolverBase::ReInit(t0, y0);
+   if (iResultFlag != SimModelSolverErrorData::err_OK)
+      return iResultFlag;
+
+   //fill new initial data vector (reused: CVodeReInit copies it)
+   if (!_initialData)
+   {
+#ifdef _OPENMP
+      _initialData = N_VNew_OpenMP(_problemSize, getNumberOfThreads());
+#else
+      _initialData = N_VNew_Serial(_problemSize);
+#endif
+      if (!_initialData)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for ODE initial data vector");
+   }
+
+   for (int i = 0; i < _problemSize; i++)
+      NV_Ith_S(_initialData, i) = y0[callerStateIndex(i)];
+
+   //pass changed solver options
+   this->FillSolverOptions();
+
+   //sensitivities are continued at t0 (new initial values are assumed not to depend on the sensitivity parameters).
+   //Must be retrieved before CVodeReInit resets the integration history
+   //(sensitivities switched off remain off)
+   //If t0 is not within the last internal step, the values at the last output time are used.
+   //All parameters are retrieved: _sensitivityValues may hold only the observed ones or none at all
+   //(SensitivitiesOnDemand)
+   bool reInitSensitivities = (_numberOfSensitivityParameters > 0) && _sensitivityValues && _sensitivitiesActive;
+   if (reInitSensitivities)
+   {
+      iResultFlag = CVodeGetSensDky(_cvodeMem, t0, 0, _sensitivityValues);
+      if (iResultFlag == CV_BAD_T)
+         iResultFlag = CVodeGetSensDky(_cvodeMem, _lastOutputTime, 0, _sensitivityValues);
+      if (iResultFlag != CV_SUCCESS)
+         return iResultFlag;
+   }
+
+   //directional sensitivity of the Hessian-vector product likewise
+   if (_directionalSensitivity)
+   {
+      iResultFlag = CVodeGetSensDky(_cvodeMem, t0, 0, _directionalSensitivity);
+      if (iResultFlag == CV_BAD_T)
+         iResultFlag = CVodeGetSensDky(_cvodeMem, _lastOutputTime, 0, _directionalSensitivity);
+      if (iResultFlag != CV_SUCCESS)
+         return iResultFlag;
+   }
+
+   //quadratures are continued at t0 (e.g. AUC over all doses)
+   if (_numberOfQuadratures > 0)
+   {
+      iResultFlag = CVodeGetQuadDky(_cvodeMem, t0, 0, _quadratures);
+      if (iResultFlag == CV_BAD_T)
+         iResultFlag = CVodeGetQuadDky(_cvodeMem, _lastOutputTime, 0, _quadratures);
+      if (iResultFlag != CV_SUCCESS)
+         return iResultFlag;
+   }
+
+   //call CVode ReInit routine (resets the CVODES counters)
+   accumulateSolverStatistics();
+   iResultFlag = CVodeReInit(_cvodeMem, t0, _initialData);
+   if (iResultFlag != CV_SUCCESS)
+      return iResultFlag;
+
+   if (_numberOfQuadratures > 0)
+   {
+      iResultFlag = CVodeQuadReInit(_cvodeMem, _quadratures);
+      if (iResultFlag != CV_SUCCESS)
+         return iResultFlag;
+   }
+
+   //continue with the first stop time after t0
+   setNextStopTime(t0);
+
+   //_sensitivityValues hold the sensitivities at t0
+   _lastOutputTime = t0;
+   _sensitivitiesRetrieved = reInitSensitivities;
+
+   //new forward run: the checkpoints of the previous one are discarded
+   if (_adjointSensitivities)
+   {
+      iResultFlag = CVodeAdjReInit(_cvodeMem);
+      if (iResultFlag != CV_SUCCESS)
+         return iResultFlag;
+
+      _adjointStartTime = t0;
+      _adjointFinalTime = t0;
+      _adjointNumberOfCheckpoints = 0;
+      _forwardRhsEvaluations = 0;
+      _adjointRecomputationRhsEvaluations = 0;
+   }
+
+   if (_directionalSensitivity)
+      return CVodeSensReInit(_cvodeMem, CV_STAGGERED, _directionalSensitivity);
+
+   if (!reInitSensitivities)
+      return iResultFlag;
+
+   iResultFlag = CVodeSensReInit(_cvodeMem, _usedSensitivityMethod, _sensitivityValues);
+
+   return iResultFlag;
+}
+
+SimModelSolver_CVODES::SolverStatistics SimModelSolver_CVODES::currentSolverStatistics()
+{
+   SolverStatistics statistics = {};
+
+   if (!_cvodeMem)
+      return statistics;
+
+   //counters of modules which are not used (e.g. Krylov counters of the direct solver) remain 0
+   CVodeGetNumSteps(_cvodeMem, &statistics.Steps);
+   CVodeGetNumRhsEvals(_cvodeMem, &statistics.RhsEvaluations);
+   CVodeGetNumGEvals(_cvodeMem, &statistics.RootFunctionEvaluations);
+   CVodeGetNumErrTestFails(_cvodeMem, &statistics.ErrorTestFailures);
+   CVodeGetNumNonlinSolvIters(_cvodeMem, &statistics.NonlinearIterations);
+   CVodeGetNumNonlinSolvConvFails(_cvodeMem, &statistics.NonlinearConvergenceFailures);
+   CVodeGetNumLinSolvSetups(_cvodeMem, &statistics.LinearSolverSetups);
+   CVodeGetLastStep(_cvodeMem, &statistics.LastStepSize);
+   CVodeGetCurrentStep(_cvodeMem, &statistics.CurrentStepSize);
+   CVodeGetLastOrder(_cvodeMem, &statistics.LastOrder);
+   CVodeGetCurrentOrder(_cvodeMem, &statistics.CurrentOrder);
+
+   CVodeGetNumJacEvals(_cvodeMem, &statistics.JacobianEvaluations);
+   CVodeGetNumLinRhsEvals(_cvodeMem, &statistics.LinearSolverRhsEvaluations);
+   if (_linearSolverType != LS_DIRECT)
+   {
+      CVodeGetNumLinIters(_cvodeMem, &statistics.LinearIterations);
+      CVodeGetNumLinConvFails(_cvodeMem, &statistics.LinearConvergenceFailures);
+      CVodeGetNumJtimesEvals(_cvodeMem, &statistics.JacobianTimesVectorEvaluations);
+      CVodeGetNumPrecEvals(_cvodeMem, &statistics.PreconditionerEvaluations);
+   }
+
+   if (!_sensitivitiesActive)
+   {
+      statistics.SensitivityRhsEvaluations = _inactiveSensitivityStatistics.SensitivityRhsEvaluations;
+      statistics.RhsEvaluationsForSensitivities = _inactiveSensitivityStatistics.RhsEvaluationsForSensitivities;
+      statistics.SensitivityErrorTestFailures = _inactiveSensitivityStatistics.SensitivityErrorTestFailures;
+      statistics.SensitivityLinearSolverSetups = _inactiveSensitivityStatistics.SensitivityLinearSolverSetups;
+      statistics.SensitivityNonlinearIterations = _inactiveSensitivityStatistics.SensitivityNonlinearIterations;
+      statistics.SensitivityNonlinearConvergenceFailures = _inactiveSensitivityStatistics.SensitivityNonlinearConvergenceFailures;
+      return statistics;
+   }
+
+   //CV_NO_SENS without forward sensitivities (counters remain 0)
+   CVodeGetSensNumRhsEvals(_cvodeMem, &statistics.SensitivityRhsEvaluations);
+   CVodeGetNumRhsEvalsSens(_cvodeMem, &statistics.RhsEvaluationsForSensitivities);
+   CVodeGetSensNumErrTestFails(_cvodeMem, &statistics.SensitivityErrorTestFailures);
+   CVodeGetSensNumLinSolvSetups(_cvodeMem, &statistics.SensitivityLinearSolverSetups);
+   CVodeGetSensNumNonlinSolvIters(_cvodeMem, &statistics.SensitivityNonlinearIterations);
+   CVodeGetSensNumNonlinSolvConvFails(_cvodeMem, &statistics.SensitivityNonlinearConvergenceFailures);
+
+   return statistics;
+}
+
+void SimModelSolver_CVODES::addSolverStatistics(SolverStatistics& sum, const SolverStatistics& statistics)
+{
+   sum.Steps += statistics.Steps;
+   sum.RhsEvaluations += statistics.RhsEvaluations;
+   sum.RootFunctionEvaluations += statistics.RootFunctionEvaluations;
+   sum.ErrorTestFailures += statistics.ErrorTestFailures;
+   sum.NonlinearIterations += statistics.NonlinearIterations;
+   sum.NonlinearConvergenceFailures += statistics.NonlinearConvergenceFailures;
+   sum.LinearSolverSetups += statistics.LinearSolverSetups;
+   sum.JacobianEvaluations += statistics.JacobianEvaluations;
+   sum.LinearSolverRhsEvaluations += statistics.LinearSolverRhsEvaluations;
+   sum.LinearIterations += statistics.LinearIterations;
+   sum.LinearConvergenceFailures += statistics.LinearConvergenceFailures;
+   sum.JacobianTimesVectorEvaluations += statistics.JacobianTimesVectorEvaluations;
+   sum.PreconditionerEvaluations += statistics.PreconditionerEvaluations;
+   sum.SensitivityRhsEvaluations += statistics.SensitivityRhsEvaluations;
+   sum.RhsEvaluationsForSensitivities += statistics.RhsEvaluationsForSensitivities;
+   sum.SensitivityErrorTestFailures += statistics.SensitivityErrorTestFailures;
+   sum.SensitivityLinearSolverSetups += statistics.SensitivityLinearSolverSetups;
+   sum.SensitivityNonlinearIterations += statistics.SensitivityNonlinearIterations;
+   sum.SensitivityNonlinearConvergenceFailures += statistics.SensitivityNonlinearConvergenceFailures;
+
+   //step size and order of the latest interval
+   sum.LastStepSize = statistics.LastStepSize;
+   sum.CurrentStepSize = statistics.CurrentStepSize;
+   sum.LastOrder = statistics.LastOrder;
+   sum.CurrentOrder = statistics.CurrentOrder;
+}
+
+void SimModelSolver_CVODES::accumulateSolverStatistics()
+{
+   if (!_cvodeMem)
+      return;
+
+   addSolverStatistics(_cumulativeStatistics, currentSolverStatistics());
+
+   //counted in this interval; the next one starts with the sensitivities restarted or switched off
+   _inactiveSensitivityStatistics = SolverStatistics();
+}
+
+void SimModelSolver_CVODES::resetSolverStatistics()
+{
+   _cumulativeStatistics = SolverStatistics();
+   _inactiveSensitivityStatistics = SolverStatistics();
+}
+
+SimModelSolver_CVODES::SolverStatistics SimModelSolver_CVODES::GetSolverStatistics()
+{
+   return currentSolverStatistics();
+}
+
+SimModelSolver_CVODES::SolverStatistics SimModelSolver_CVODES::GetCumulativeSolverStatistics()
+{
+   SolverStatistics statistics = _cumulativeStatistics;
+
+   if (_cvodeMem)
+      addSolverStatistics(statistics, currentSolverStatistics());
+
+   return statistics;
+}
+
+void SimModelSolver_CVODES::SetInstrumentationOutput(const string& fileName)
+{
+   _instrumentationOutput = fileName;
+}
+
+const SolverInstrumentation* SimModelSolver_CVODES::GetInstrumentation()
+{
+   return _instrumentation;
+}
+
+string SimModelSolver_CVODES::GetInstrumentationReportError()
+{
+   return _instrumentationReportError;
+}
+
+void SimModelSolver_CVODES::Terminate()
+{
+   //counters of the last interval (CVodeFree below)
+   accumulateSolverStatistics();
+
+   if (_solution)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_solution);
+#else
+      N_VDestroy_Serial(_solution);
+#endif
+      _solution = NULL;
+   }
+
+   if (_initialData)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_initialData);
+#else
+      N_VDestroy_Serial(_initialData);
+#endif
+      _initialData = NULL;
+   }
+
+   if (_quadratures)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_quadratures);
+#else
+      N_VDestroy_Serial(_quadratures);
+#endif
+      _quadratures = NULL;
+   }
+   _numberOfQuadratures = 0;
+
+   if (_absTol_NV)
+   {
+#ifdef _OPENMP
+      N_VDestroy_OpenMP(_absTol_NV);
+#else
+      N_VDestroy_Serial(_absTol_NV);
+#endif
+      _absTol_NV = NULL;
+   }
+
+   freeAdjointProblem();
+
+   if (_cvodeMem)
+   {
+      CVodeFree(&_cvodeMem);
+      _cvodeMem = NULL;
+   }
+   _passedSolverOptions.Valid = false;
+
+   if (_directionalSensitivity)
+   {
+#ifdef _OPENMP
+      N_VDestroyVectorArray_OpenMP(_directionalSensitivity, 1);
+#else
+      N_VDestroyVectorArray_Serial(_directionalSensitivity, 1);
+#endif
+      _directionalSensitivity = NULL;
+   }
+
+   if (_sensitivityValues && (numberOfForwardSensitivities() > 0))
+   {
+#ifdef _OPENMP
+      N_VDestroyVectorArray_OpenMP(_sensitivityValues, numberOfForwardSensitivities());
+#else
+      N_VDestroyVectorArray_Serial(_sensitivityValues, numberOfForwardSensitivities());
+#endif
+      _sensitivityValues = NULL;
+   }
+
+   //the timing wrapper does not free _linearSolver
+   if (_timedLinearSolver)
+   {
+      SUNLinSolFree(_timedLinearSolver);
+      _timedLinearSolver = NULL;
+   }
+
+   if (_linearSolver)
+   {
+      SUNLinSolFree(_linearSolver);
+      _linearSolver = NULL;
+   }
+
+   if (_linearSolverMatrix)
+   {
+      SUNMatDestroy(_linearSolverMatrix);
+      _linearSolverMatrix = NULL;
+   }
+
+   //timings of all runs so far (a failure to write must not prevent the clean up:
+   //reported by GetInstrumentationReportError)
+   _instrumentationReportError.clear();
+   if (_instrumentation && !_instrumentationOutput.empty() && !_instrumentation->WriteReport(_instrumentationOutput))
+      _instrumentationReportError = "Cannot write the instrumentation report to " + _instrumentationOutput;
+
+   _initialized = false;
+}
+
+string SimModelSolver_CVODES::ToString(double dValue)
+{
+   std::ostringstream out;
+   out.precision(16);
+   out << dValue;
+
+   return out.str();
+}
+
+SimModelSolverErrorData::errNumber SimModelSolver_CVODES::GetErrorNumberFromSolverReturnValue(int solverRetVal)
+{
+   switch (solverRetVal)
+   {
+   case CV_SUCCESS:
+   case CV_TSTOP_RETURN:
+   case CV_ROOT_RETURN:
+      return SimModelSolverErrorData::err_OK;
+   case CV_ILL_INPUT:
+      return SimModelSolverErrorData::err_ILL_INPUT;
+   case CV_TOO_MUCH_WORK:
+      return SimModelSolverErrorData::err_TOO_MUCH_WORK;
+   case CV_TOO_MUCH_ACC:
+      return SimModelSolverErrorData::err_TOO_MUCH_ACC;
+   case CV_ERR_FAILURE:
+      return SimModelSolverErrorData::err_TEST_FAILURE;
+   case CV_CONV_FAILURE:
+      return SimModelSolverErrorData::err_CONV_FAILURE;
+   }
+
+   return SimModelSolverErrorData::err_FAILURE;
+}
+
+string SimModelSolver_CVODES::GetSolverErrMsg(int SolverRetVal)
+{
+   switch (SolverRetVal)
+   {
+   case CV_SUCCESS:
+      return "CVode succeeded and no roots were found (CV_SUCCESS)";
+   case CV_TOO_MUCH_WORK:
+      return "The solver took " + ToString(_mxStep) +
+         " internal steps but could not reach output time (TOO_MUCH_WORK)";
+   case CV_TSTOP_RETURN:
+      return "CVode succeeded by reaching the stopping point specified through the optional input function CVodeSetStopTime (CV_TSTOP_RETURN)";
+   case CV_ROOT_RETURN:
+      return "CVode succeeded and found one or more roots. If nrtfn > 1, call CVodeGetRootInfo to see which gi were found to have a root (CV_ROOT_RETURN)";
+   case CV_MEM_NULL:
+      return "The cvode mem argument was NULL (CV_MEM_NULL)";
+   case CV_NO_MALLOC:
+      return "The cvode memory was not allocated by a call to CVodeInit (CV_NO_MALLOC)";
+   case CV_ILL_INPUT:
+      return string("One of the inputs to CVode was illegal, or some other input to the \n") +
+         "solver was either illegal or missing.\n" +
+         "The latter category includes the following situations:\n" +
+         "(a) The tolerances have not been set.\n" +
+         "(b) A component of the error weight vector became zero during internal time-stepping.\n" +
+         "(c) The linear solver initialization function (called by the user after calling CVodeCreate)\n" +
+         "failed to set the linear solverspecific lsolve field in cvode mem.\n" +
+         "(d) A root of one of the root functions was found both at a point t and also very near t.\n" +
+         "(CV_ILL_INPUT)";
+   case CV_TOO_CLOSE:
+      return "The initial time t0 and the final time tout are too close to each other and the user did not specify an initial step size (CV_TOO_CLOSE)";
+   case CV_TOO_MUCH_ACC:
+      return "The solver could not satisfy the accuracy demanded by the user for some internal step (CV_TOO_MUCH_ACC)";
+   case CV_ERR_FAILURE:
+      return "Either error test failures occurred too many times during one internal time step, or with |h| = hmin (CV_ERR_FAILURE)";
+   case CV_CONV_FAILURE:
+      return "Either convergence test failures occurred too many times during one internal time step, or with |h| = hmin (CV_CONV_FAILURE)";
+   case CV_LINIT_FAIL:
+      return "The linear solver's initialization function failed (CV_LINIT_FAIL)";
+   case CV_LSETUP_FAIL:
+      return "The linear solver's setup function failed in an unrecoverable manner (CV_LSETUP_FAIL)";
+   case CV_LSOLVE_FAIL:
+      return "The linear solver's solve function failed in an unrecoverable manner (CV_LSOLVE_FAIL)";
+   case CV_RHSFUNC_FAIL:
+      return "The right-hand side function failed in an unrecoverable manner (CV_RHSFUNC_FAIL)";
+   case CV_FIRST_RHSFUNC_ERR:
+      return "The right-hand side function had a recoverable error at the first call (CV_FIRST_RHSFUNC_FAIL)";
+   case CV_REPTD_RHSFUNC_ERR:
+      return string("Convergence test failures occurred too many times due to repeated") +
+         "recoverable errors in the right-hand side function. This flag " +
+         "will also be returned if the rhs function had repeated " +
+         "recoverable errors during the estimation of an initial step size " +
+         "(CV_REPTD_RHSFUNC_ERR)";
+   case CV_UNREC_RHSFUNC_ERR:
+      return string("The right-hand function had a recoverable error, but no recovery ") +
+         "was possible. This failure mode is rare, as it can occur only if the " +
+         "right-hand side function fails recoverably after an error test failed" +
+         "while at order one (CV_UNREC_RHSFUNC_ERR)";
+   case CV_RTFUNC_FAIL:
+      return "The rootfinding function failed (CV_RTFUNC_FAIL)";
+   case CV_NO_SENS:
+      return "Forward sensitivities are not calculated or switched off (CV_NO_SENS)";
+   }
+
+   return "Unknown Error";
+}
+
+void SimModelSolver_CVODES::SetOption(const std::string& name, double value)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetOption";
+
+   string NameToUpper = name;
+   transform(NameToUpper.begin(), NameToUpper.end(), NameToUpper.begin(),
+      (int(*)(int)) toupper);
+
+   if (NameToUpper == "LMM")
+   {
+      int iValue = (int)value + 1; //+1 because CVODE constants changed!!
+      if ((iValue != CV_ADAMS) && (iValue != CV_BDF))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option Lmm passed");
+      _lmm = iValue;
+   }
+   else if (NameToUpper == "ITER")
+   {
+      //not used anymore. Keep option just for backward compatibility
+   }
+   else if (NameToUpper == "MAXORD")
+   {
+      int iValue = (int)value;
+      if ((iValue < 1) || (iValue > 5))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option MaxOrd passed");
+      _maxOrd = iValue;
+   }
+   else if (NameToUpper == "MXHNIL")
+   {
+      int iValue = (int)value;
+      _mxHNil = iValue;
+   }
+   else if (NameToUpper == "LINEARSOLVER")
+   {
+      int iValue = (int)value;
+      if ((iValue < LS_DIRECT) || (iValue > LS_SPTFQMR))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option LinearSolver passed");
+      _linearSolverType = (LINEAR_SOLVER)iValue;
+   }
+   else if (NameToUpper == "COLOREDFINITEDIFFERENCEJACOBIAN")
+      _coloredJacobianEnabled = (value != 0.0);
+   else if (NameToUpper == "JACOBIANSPARSITYDETECTION")
+      _jacobianSparsityDetection = (value != 0.0);
+   else if (NameToUpper == "STATEREORDERING")
+      _stateReordering = (value != 0.0);
+   else if (NameToUpper == "QUADRATUREERRORCONTROL")
+      _quadratureErrorControl = (value != 0.0);
+   else if (NameToUpper == "PARALLELSENSITIVITYRHS")
+      _parallelSensitivityRhs = (value != 0.0);
+   else if (NameToUpper == "SENSITIVITYMETHOD")
+   {
+      int iValue = (int)value;
+      if ((iValue != 0) && (iValue != CV_SIMULTANEOUS) && (iValue != CV_STAGGERED) && (iValue != CV_STAGGERED1))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option SensitivityMethod passed");
+      _sensitivityMethod = iValue;
+   }
+   else if (NameToUpper == "SENSITIVITYERRORCONTROL")
+      _sensitivityErrorControl = (value != 0.0);
+   else if (NameToUpper == "SENSITIVITIESONDEMAND")
+      _sensitivitiesOnDemand = (value != 0.0);
+   else if (NameToUpper == "ADJOINTSENSITIVITIES")
+      _adjointSensitivities = (value != 0.0);
+   else if (NameToUpper == "INSTRUMENTATION")
+      _instrumentationEnabled = (value != 0.0);
+   else if (NameToUpper == "ADJOINTMEMORYBUDGET")
+   {
+      if (value < 0.0)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option AdjointMemoryBudget passed");
+      _adjointMemoryBudget = value * 1024.0 * 1024.0;
+   }
+   else if (NameToUpper == "ADJOINTINTERPOLATION")
+   {
+      int iValue = (int)value;
+      if ((iValue != 0) && (iValue != 1))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option AdjointInterpolation passed");
+      _adjointInterpolation = (iValue == 0) ? CV_HERMITE : CV_POLYNOMIAL;
+   }
+   else if (NameToUpper == "PRECONDITIONER")
+   {
+      int iValue = (int)value;
+      if ((iValue != PREC_NONE) && (iValue != PREC_LEFT) && (iValue != PREC_RIGHT))
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option Preconditioner passed");
+      _preconditioning = iValue;
+   }
+   else if (NameToUpper == "MAXKRYLOVDIMENSION")
+   {
+      int iValue = (int)value;
+      if (iValue < 0)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option MaxKrylovDimension passed");
+      _maxKrylovDimension = iValue;
+   }
+   else if (NameToUpper == "NUMBEROFTHREADS")
+   {
+      int iValue = (int)value;
+      if (iValue < 1)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option NumberOfThreads passed");
+      setNumberOfThreads(iValue);
+   }
+   else
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown CVODE solver option passed: " + name);
+
+}
+
+int SimModelSolver_CVODES::Rhs(realtype t, N_Vector y, N_Vector ydot,
+   void* user_data)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::Rhs";
+
+   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
+   //This instance cannot be accessed from Rhs because it's a static member
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SolverInstrumentation::ScopedTimer timer(userData->Solver->_instrumentation, SolverInstrumentation::RHS);
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
+
+   userData->Solver->_forwardRhsEvaluations++;
+
+   //call the ODE RHS function of the solver caller (in caller state order)
+#ifdef _OPENMP
+   Rhs_Return_Value RetVal = userData->Solver->callRhs(t, NV_DATA_OMP(y), p, NV_DATA_OMP(ydot));
+#else
+   Rhs_Return_Value RetVal = userData->Solver->callRhs(t, NV_DATA_S(y), p, NV_DATA_S(ydot));
 #endif
-      _initialData = NULL;
+
+   if (RetVal == RHS_OK)
+      return 0;
+
+   if (RetVal == RHS_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable Error
+}
+
+
+int SimModelSolver_CVODES::CVODE_SensitivityRhsFunction(int Ns, realtype t, N_Vector y, N_Vector ydot, int iS,
+   N_Vector yS, N_Vector ySdot, void* user_data,
+   N_Vector tmp1, N_Vector tmp2)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_SensitivityRhsFunction";
+
+   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
+   //This instance cannot be accessed from Rhs because it's a static member
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   //get pointer to the Solver caller instance and call ODE Sensitivity RHS function
+   SimModelSolver_CVODES* solver = userData->Solver;
+   ISolverCaller* pSolverCaller = solver->GetSolverCaller();
+
+   SolverInstrumentation::ScopedTimer timer(solver->_instrumentation, SolverInstrumentation::SENSITIVITY_RHS);
+
+#ifdef _OPENMP
+   double* yData = NV_DATA_OMP(y);
+   double* ydotData = NV_DATA_OMP(ydot);
+   double* ySData = NV_DATA_OMP(yS);
+   double* ySdotData = NV_DATA_OMP(ySdot);
+#else
+   double* yData = NV_DATA_S(y);
+   double* ydotData = NV_DATA_S(ydot);
+   double* ySData = NV_DATA_S(yS);
+   double* ySdotData = NV_DATA_S(ySdot);
+#endif
+
+   Sensitivity_Rhs_Return_Value RetVal;
+
+   //index of the sensitivity parameter of the solver caller
+   iS = solver->_forwardSensitivityParameters[iS];
+
+   if (solver->_statePermutation.empty())
+      RetVal = pSolverCaller->ODESensitivityRhsFunction(t, yData, ydotData, iS, ySData, ySdotData, NULL);
+   else
+   {
+      //caller state order
+      solver->toCallerOrder(yData, &solver->_callerY[0]);
+      solver->toCallerOrder(ydotData, &solver->_callerYdot[0]);
+      solver->toCallerOrder(ySData, &solver->_callerYS[0]);
+
+      RetVal = pSolverCaller->ODESensitivityRhsFunction(t, &solver->_callerY[0], &solver->_callerYdot[0], iS,
+                                                        &solver->_callerYS[0], &solver->_callerYSdot[0], NULL);
+
+      solver->toSolverOrder(&solver->_callerYSdot[0], ySdotData);
    }
 
-   if (_absTol_NV)
+   if (RetVal == SENSITIVITY_RHS_OK)
+      return 0;
+
+   if (RetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable Error
+}
+
+int SimModelSolver_CVODES::CVODE_SensitivityRhsAllFunction(int Ns, realtype t, N_Vector y, N_Vector ydot,
+   N_Vector* yS, N_Vector* ySdot, void* user_data,
+   N_Vector tmp1, N_Vector tmp2)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_SensitivityRhsAllFunction";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SimModelSolver_CVODES* solver = userData->Solver;
+   int N = solver->_problemSize;
+   int iS;
+
+   SolverInstrumentation::ScopedTimer timer(solver->_instrumentation, SolverInstrumentation::SENSITIVITY_RHS);
+
+#ifdef _OPENMP
+   double* yData = NV_DATA_OMP(y);
+   double* ydotData = NV_DATA_OMP(ydot);
+#else
+   double* yData = NV_DATA_S(y);
+   double* ydotData = NV_DATA_S(ydot);
+#endif
+
+   bool reordered = !solver->_statePermutation.empty();
+
+   for (iS = 0; iS < Ns; iS++)
    {
 #ifdef _OPENMP
-      N_VDestroy_OpenMP(_absTol_NV);
+      double* ySData = NV_DATA_OMP(yS[iS]);
+      double* ySdotData = NV_DATA_OMP(ySdot[iS]);
 #else
-      N_VDestroy_Serial(_absTol_NV);
+      double* ySData = NV_DATA_S(yS[iS]);
+      double* ySdotData = NV_DATA_S(ySdot[iS]);
 #endif
-      _absTol_NV = NULL;
+
+      if (!reordered)
+      {
+         solver->_sensitivityRhsYS[iS] = ySData;
+         solver->_sensitivityRhsYSdot[iS] = ySdotData;
+         continue;
+      }
+
+      //caller state order
+      double* callerYS = &solver->_callerSensitivities[(size_t)iS * N];
+      solver->toCallerOrder(ySData, callerYS);
+      solver->_sensitivityRhsYS[iS] = callerYS;
+      solver->_sensitivityRhsYSdot[iS] = &solver->_callerSensitivitiesDot[(size_t)iS * N];
    }
 
-   if (_cvodeMem)
+   if (reordered)
    {
-      CVodeFree(&_cvodeMem);
-      _cvodeMem = NULL;
+      solver->toCallerOrder(yData, &solver->_callerY[0]);
+      solver->toCallerOrder(ydotData, &solver->_callerYdot[0]);
+      yData = &solver->_callerY[0];
+      ydotData = &solver->_callerYdot[0];
    }
 
-   if (_sensitivityValues && (_numberOfSensitivityParameters > 0))
+   Sensitivity_Rhs_Return_Value RetVal;
+
+   if (solver->_solverCallerCVODES && solver->_solverCallerCVODES->IsSet_ODESensitivityRhsAllFunction())
+      RetVal = solver->_solverCallerCVODES->ODESensitivityRhsAllFunction(t, yData, ydotData, Ns, &solver->_sensitivityRhsYS[0],
+                                                                         &solver->_sensitivityRhsYSdot[0], NULL);
+   else
+      RetVal = solver->parallelSensitivityRhs(t, yData, ydotData);
+
+   if (reordered && (RetVal == SENSITIVITY_RHS_OK))
    {
+      for (iS = 0; iS < Ns; iS++)
+      {
 #ifdef _OPENMP
-      N_VDestroyVectorArray_OpenMP(_sensitivityValues, _numberOfSensitivityParameters);
+         solver->toSolverOrder(solver->_sensitivityRhsYSdot[iS], NV_DATA_OMP(ySdot[iS]));
 #else
-      N_VDestroyVectorArray_Serial(_sensitivityValues, _numberOfSensitivityParameters);
+         solver->toSolverOrder(solver->_sensitivityRhsYSdot[iS], NV_DATA_S(ySdot[iS]));
 #endif
-      _sensitivityValues = NULL;
+      }
    }
 
-   if (_linearSolver)
-   {
-      SUNLinSolFree(_linearSolver);
-      _linearSolver = NULL;
-   }
+   if (RetVal == SENSITIVITY_RHS_OK)
+      return 0;
 
-   if (_linearSolverMatrix)
+   if (RetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable Error
+}
+
+int SimModelSolver_CVODES::CVODE_JacFn(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+   void* user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_JacFn";
+
+   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
+   //This instance cannot be accessed from CVODE_JacFn because it's a static member
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SolverInstrumentation::ScopedTimer timer(userData->Solver->_instrumentation, SolverInstrumentation::JACOBIAN);
+
+   //get pointer to the Solver caller instance and call the ODE RHS function
+   ISolverCaller* pSolverCaller = userData->Solver->GetSolverCaller();
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
+
+   Jacobian_Return_Value RetVal;
+
+   if (userData->Solver->_useColoredJacobian)
+      RetVal = userData->Solver->fillColoredJacobian(t, y, fy, J, tmp1, tmp2, tmp3);
+   else if (SUNMatGetID(J) == SUNMATRIX_SPARSE)
+      RetVal = userData->Solver->fillSparseJacobian(t, y, fy, J);
+   else if (pSolverCaller->IsSet_ODEJacFunction() && !userData->Solver->_statePermutation.empty())
+      RetVal = userData->Solver->fillReorderedJacobian(t, y, fy, J);
+   else if (pSolverCaller->IsSet_ODEJacFunction())
    {
-      SUNMatDestroy(_linearSolverMatrix);
-      _linearSolverMatrix = NULL;
+      double** cols;
+      if (SUNMatGetID(J) == SUNMATRIX_BAND)
+         cols = SUNBandMatrix_Cols(J);
+      else
+         cols = SUNDenseMatrix_Cols(J);
+
+#ifdef _OPENMP
+      RetVal = pSolverCaller->ODEJacFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(fy), cols, NULL);
+#else
+      RetVal = pSolverCaller->ODEJacFunction(t, NV_DATA_S(y), p, NV_DATA_S(fy), cols, NULL);
+#endif
    }
+   else
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Jacobian function not set");
 
-   _initialized = false;
+   if (RetVal == JACOBIAN_OK)
+      return 0;
+
+   if (RetVal == JACOBIAN_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable error
 }
 
-string SimModelSolver_CVODES::ToString(double dValue)
+int SimModelSolver_CVODES::CVODE_JacTimesVecFn(N_Vector v, N_Vector Jv, realtype t, N_Vector y, N_Vector fy,
+   void* user_data, N_Vector tmp)
 {
-   std::ostringstream out;
-   out.precision(16);
-   out << dValue;
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_JacTimesVecFn";
 
-   return out.str();
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   ISolverCaller_CVODES* pSolverCaller = userData->Solver->_solverCallerCVODES;
+   if (!pSolverCaller || !pSolverCaller->IsSet_ODEJacTimesVecFunction())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Jacobian-vector product function not set");
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
+
+#ifdef _OPENMP
+   Jacobian_Return_Value RetVal = pSolverCaller->ODEJacTimesVecFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(fy), NV_DATA_OMP(v), NV_DATA_OMP(Jv), NULL);
+#else
+   Jacobian_Return_Value RetVal = pSolverCaller->ODEJacTimesVecFunction(t, NV_DATA_S(y), p, NV_DATA_S(fy), NV_DATA_S(v), NV_DATA_S(Jv), NULL);
+#endif
+
+   if (RetVal == JACOBIAN_OK)
+      return 0;
+
+   if (RetVal == JACOBIAN_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable error
 }
 
-SimModelSolverErrorData::errNumber SimModelSolver_CVODES::GetErrorNumberFromSolverReturnValue(int solverRetVal)
+int SimModelSolver_CVODES::CVODE_PrecSetupFn(realtype t, N_Vector y, N_Vector fy, booleantype jok, booleantype* jcurPtr,
+   realtype gamma, void* user_data)
 {
-   switch (solverRetVal)
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_PrecSetupFn";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   ISolverCaller_CVODES* pSolverCaller = userData->Solver->_solverCallerCVODES;
+   if (!pSolverCaller || !pSolverCaller->IsSet_PreconditionerFunctions())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Preconditioner functions not set");
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
+
+   bool jacobianUpdated = false;
+
+#ifdef _OPENMP
+   Preconditioner_Return_Value RetVal = pSolverCaller->PreconditionerSetupFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(fy), jok ? true : false, jacobianUpdated, gamma, NULL);
+#else
+   Preconditioner_Return_Value RetVal = pSolverCaller->PreconditionerSetupFunction(t, NV_DATA_S(y), p, NV_DATA_S(fy), jok ? true : false, jacobianUpdated, gamma, NULL);
+#endif
+
+   *jcurPtr = jacobianUpdated ? SUNTRUE : SUNFALSE;
+
+   if (RetVal == PRECONDITIONER_OK)
+      return 0;
+
+   if (RetVal == PRECONDITIONER_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable error
+}
+
+int SimModelSolver_CVODES::CVODE_PrecSolveFn(realtype t, N_Vector y, N_Vector fy, N_Vector r, N_Vector z,
+   realtype gamma, realtype delta, int lr, void* user_data)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_PrecSolveFn";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   ISolverCaller_CVODES* pSolverCaller = userData->Solver->_solverCallerCVODES;
+   if (!pSolverCaller || !pSolverCaller->IsSet_PreconditionerFunctions())
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Preconditioner functions not set");
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
+
+#ifdef _OPENMP
+   Preconditioner_Return_Value RetVal = pSolverCaller->PreconditionerSolveFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(fy), NV_DATA_OMP(r), NV_DATA_OMP(z), gamma, delta, lr == PREC_LEFT, NULL);
+#else
+   Preconditioner_Return_Value RetVal = pSolverCaller->PreconditionerSolveFunction(t, NV_DATA_S(y), p, NV_DATA_S(fy), NV_DATA_S(r), NV_DATA_S(z), gamma, delta, lr == PREC_LEFT, NULL);
+#endif
+
+   if (RetVal == PRECONDITIONER_OK)
+      return 0;
+
+   if (RetVal == PRECONDITIONER_RECOVERABLE_ERROR)
+      return 1;
+
+   return -1; //unrecoverable error
+}
+
+int SimModelSolver_CVODES::CVODE_AdjointRhsFn(realtype t, N_Vector y, N_Vector yB, N_Vector yBdot, void* user_dataB)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_AdjointRhsFn";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SimModelSolver_CVODES* solver = userData->Solver;
+   const double* p = userData->SensitivityParameters;
+
+#ifdef _OPENMP
+   const double* yData = NV_DATA_OMP(y);
+   const double* yBData = NV_DATA_OMP(yB);
+   double* yBdotData = NV_DATA_OMP(yBdot);
+#else
+   const double* yData = NV_DATA_S(y);
+   const double* yBData = NV_DATA_S(yB);
+   double* yBdotData = NV_DATA_S(yBdot);
+#endif
+
+   //lambda' = -(df/dy)^T*lambda - (dg/dy)^T
+   if (solver->jacobianTransposeTimesVector(t, yData, p, yBData, yBdotData) != JACOBIAN_OK)
+      return 1;
+
+   if (!solver->_adjointIntegralObjective)
    {
-   case CV_SUCCESS:
-   case CV_TSTOP_RETURN:
-   case CV_ROOT_RETURN:
-      return SimModelSolverErrorData::err_OK;
-   case CV_ILL_INPUT:
-      return SimModelSolverErrorData::err_ILL_INPUT;
-   case CV_TOO_MUCH_WORK:
-      return SimModelSolverErrorData::err_TOO_MUCH_WORK;
-   case CV_TOO_MUCH_ACC:
-      return SimModelSolverErrorData::err_TOO_MUCH_ACC;
-   case CV_ERR_FAILURE:
-      return SimModelSolverErrorData::err_TEST_FAILURE;
-   case CV_CONV_FAILURE:
-      return SimModelSolverErrorData::err_CONV_FAILURE;
+      for (int i = 0; i < solver->_problemSize; i++)
+         yBdotData[i] = -yBdotData[i];
+      return 0;
+   }
+
+   double* dgdy = &solver->_adjointObjectiveDerivativeY[0];
+   if (solver->_solverCallerCVODES->ObjectiveDerivativeFunction(t, yData, p, dgdy, &solver->_adjointObjectiveDerivativeP[0]) != RHS_OK)
+      return 1;
+
+   for (int i = 0; i < solver->_problemSize; i++)
+      yBdotData[i] = -yBdotData[i] - dgdy[i];
+
+   return 0;
+}
+
+int SimModelSolver_CVODES::CVODE_AdjointQuadratureRhsFn(realtype t, N_Vector y, N_Vector yB, N_Vector qBdot, void* user_dataB)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_AdjointQuadratureRhsFn";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SimModelSolver_CVODES* solver = userData->Solver;
+   const double* p = userData->SensitivityParameters;
+
+#ifdef _OPENMP
+   const double* yData = NV_DATA_OMP(y);
+   const double* yBData = NV_DATA_OMP(yB);
+   double* qBdotData = NV_DATA_OMP(qBdot);
+#else
+   const double* yData = NV_DATA_S(y);
+   const double* yBData = NV_DATA_S(yB);
+   double* qBdotData = NV_DATA_S(qBdot);
+#endif
+
+   //(dG/dp)' = -(dg/dp + (df/dp)^T*lambda), integrated backward from 0 at T
+   if (solver->parameterJacobianTransposeTimesVector(t, yData, p, yBData, qBdotData) != JACOBIAN_OK)
+      return 1;
+
+   if (!solver->_adjointIntegralObjective)
+   {
+      for (int j = 0; j < solver->_numberOfSensitivityParameters; j++)
+         qBdotData[j] = -qBdotData[j];
+      return 0;
    }
 
-   return SimModelSolverErrorData::err_FAILURE;
+   double* dgdp = &solver->_adjointObjectiveDerivativeP[0];
+   if (solver->_solverCallerCVODES->ObjectiveDerivativeFunction(t, yData, p, &solver->_adjointObjectiveDerivativeY[0], dgdp) != RHS_OK)
+      return 1;
+
+   for (int j = 0; j < solver->_numberOfSensitivityParameters; j++)
+      qBdotData[j] = -qBdotData[j] - dgdp[j];
+
+   return 0;
 }
 
-string SimModelSolver_CVODES::GetSolverErrMsg(int SolverRetVal)
+int SimModelSolver_CVODES::CVODE_AdjointJacFn(realtype t, N_Vector y, N_Vector yB, N_Vector fyB, SUNMatrix JB,
+   void* user_dataB, N_Vector tmp1B, N_Vector tmp2B, N_Vector tmp3B)
 {
-   switch (SolverRetVal)
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_AdjointJacFn";
+
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+   SimModelSolver_CVODES* solver = userData->Solver;
+
+#ifdef _OPENMP
+   Jacobian_Return_Value RetVal = solver->adjointJacobian(t, NV_DATA_OMP(y), userData->SensitivityParameters);
+#else
+   Jacobian_Return_Value RetVal = solver->adjointJacobian(t, NV_DATA_S(y), userData->SensitivityParameters);
+#endif
+
+   if (RetVal == JACOBIAN_RECOVERABLE_ERROR)
+      return 1;
+   if (RetVal != JACOBIAN_OK)
+      return -1;
+
+   //jacobian of the backward RHS: -(df/dy)^T
+   //(second order: diag(-(df/dy)^T, -(df/dy)^T); the dependency of mu' on lambda is neglected in the Newton matrix.
+   // JB is zeroed by CVODES before the call)
+   int N = solver->_problemSize;
+   int blocks = solver->useSecondOrderAdjoint() ? 2 : 1;
+
+   //band: only the entries within the half bandwidths of JB (column c, row r at SUNBandMatrix_Column(JB, c)[r-c])
+   bool band = (SUNMatGetID(JB) == SUNMATRIX_BAND);
+   int mu = band ? (int)SUNBandMatrix_UpperBandwidth(JB) : N;
+   int ml = band ? (int)SUNBandMatrix_LowerBandwidth(JB) : N;
+
+   for (int block = 0; block < blocks; block++)
    {
-   case CV_SUCCESS:
-      return "CVode succeeded and no roots were found (CV_SUCCESS)";
-   case CV_TOO_MUCH_WORK:
-      return "The solver took " + ToString(_mxStep) +
-         " internal steps but could not reach output time (TOO_MUCH_WORK)";
-   case CV_TSTOP_RETURN:
-      return "CVode succeeded by reaching the stopping point specified through the optional input function CVodeSetStopTime (CV_TSTOP_RETURN)";
-   case CV_ROOT_RETURN:
-      return "CVode succeeded and found one or more roots. If nrtfn > 1, call CVodeGetRootInfo to see which gi were found to have a root (CV_ROOT_RETURN)";
-   case CV_MEM_NULL:
-      return "The cvode mem argument was NULL (CV_MEM_NULL)";
-   case CV_NO_MALLOC:
-      return "The cvode memory was not allocated by a call to CVodeInit (CV_NO_MALLOC)";
-   case CV_ILL_INPUT:
-      return string("One of the inputs to CVode was illegal, or some other input to the \n") +
-         "solver was either illegal or missing.\n" +
-         "The latter category includes the following situations:\n" +
-         "(a) The tolerances have not been set.\n" +
-         "(b) A component of the error weight vector became zero during internal time-stepping.\n" +
-         "(c) The linear solver initialization function (called by the user after calling CVodeCreate)\n" +
-         "failed to set the linear solverspecific lsolve field in cvode mem.\n" +
-         "(d) A root of one of the root functions was found both at a point t and also very near t.\n" +
-         "(CV_ILL_INPUT)";
-   case CV_TOO_CLOSE:
-      return "The initial time t0 and the final time tout are too close to each other and the user did not specify an initial step size (CV_TOO_CLOSE)";
-   case CV_TOO_MUCH_ACC:
-      return "The solver could not satisfy the accuracy demanded by the user for some internal step (CV_TOO_MUCH_ACC)";
-   case CV_ERR_FAILURE:
-      return "Either error test failures occurred too many times during one internal time step, or with |h| = hmin (CV_ERR_FAILURE)";
-   case CV_CONV_FAILURE:
-      return "Either convergence test failures occurred too many times during one internal time step, or with |h| = hmin (CV_CONV_FAILURE)";
-   case CV_LINIT_FAIL:
-      return "The linear solver's initialization function failed (CV_LINIT_FAIL)";
-   case CV_LSETUP_FAIL:
-      return "The linear solver's setup function failed in an unrecoverable manner (CV_LSETUP_FAIL)";
-   case CV_LSOLVE_FAIL:
-      return "The linear solver's solve function failed in an unrecoverable manner (CV_LSOLVE_FAIL)";
-   case CV_RHSFUNC_FAIL:
-      return "The right-hand side function failed in an unrecoverable manner (CV_RHSFUNC_FAIL)";
-   case CV_FIRST_RHSFUNC_ERR:
-      return "The right-hand side function had a recoverable error at the first call (CV_FIRST_RHSFUNC_FAIL)";
-   case CV_REPTD_RHSFUNC_ERR:
-      return string("Convergence test failures occurred too many times due to repeated") +
-         "recoverable errors in the right-hand side function. This flag " +
-         "will also be returned if the rhs function had repeated " +
-         "recoverable errors during the estimation of an initial step size " +
-         "(CV_REPTD_RHSFUNC_ERR)";
-   case CV_UNREC_RHSFUNC_ERR:
-      return string("The right-hand function had a recoverable error, but no recovery ") +
-         "was possible. This failure mode is rare, as it can occur only if the " +
-         "right-hand side function fails recoverably after an error test failed" +
-         "while at order one (CV_UNREC_RHSFUNC_ERR)";
-   case CV_RTFUNC_FAIL:
-      return "The rootfinding function failed (CV_RTFUNC_FAIL)";
+      for (int j = 0; j < N; j++)
+      {
+         if (band)
+         {
+            double* column = SUNBandMatrix_Column(JB, block * N + j);
+            for (int i = max(j - mu, 0); i <= min(j + ml, N - 1); i++)
+               column[i - j] = -solver->_adjointJacobianColumns[i][j];
+            continue;
+         }
+
+         double* column = SUNDenseMatrix_Column(JB, block * N + j) + block * N;
+         for (int i = 0; i < N; i++)
+            column[i] = -solver->_adjointJacobianColumns[i][j];
+      }
    }
 
-   return "Unknown Error";
+   return 0;
 }
 
-void SimModelSolver_CVODES::SetOption(const std::string& name, double value)
+int SimModelSolver_CVODES::CVODE_AdjointJacTimesVecFn(N_Vector vB, N_Vector JvB, realtype t, N_Vector y, N_Vector yB,
+   N_Vector fyB, void* user_dataB, N_Vector tmpB)
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::SetOption";
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_AdjointJacTimesVecFn";
 
-   string NameToUpper = name;
-   transform(NameToUpper.begin(), NameToUpper.end(), NameToUpper.begin(),
-      (int(*)(int)) toupper);
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
 
-   if (NameToUpper == "LMM")
-   {
-      int iValue = (int)value + 1; //+1 because CVODE constants changed!!
-      if ((iValue != CV_ADAMS) && (iValue != CV_BDF))
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option Lmm passed");
-      _lmm = iValue;
-   }
-   else if (NameToUpper == "ITER")
-   {
-      //not used anymore. Keep option just for backward compatibility
-   }
-   else if (NameToUpper == "MAXORD")
-   {
-      int iValue = (int)value;
-      if ((iValue < 1) || (iValue > 5))
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option MaxOrd passed");
-      _maxOrd = iValue;
-   }
-   else if (NameToUpper == "MXHNIL")
-   {
-      int iValue = (int)value;
-      _mxHNil = iValue;
-   }
-   else if (NameToUpper == "NUMBEROFTHREADS")
+   SimModelSolver_CVODES* solver = userData->Solver;
+
+#ifdef _OPENMP
+   const double* yData = NV_DATA_OMP(y);
+   const double* v = NV_DATA_OMP(vB);
+   double* Jv = NV_DATA_OMP(JvB);
+#else
+   const double* yData = NV_DATA_S(y);
+   const double* v = NV_DATA_S(vB);
+   double* Jv = NV_DATA_S(JvB);
+#endif
+
+   //-(df/dy)^T*v (second order: per block, consistent with CVODE_AdjointJacFn)
+   int N = solver->_problemSize;
+   int blocks = solver->useSecondOrderAdjoint() ? 2 : 1;
+
+   for (int block = 0; block < blocks; block++)
    {
-      int iValue = (int)value;
-      if (iValue < 1)
-         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid value for CVODE solver option NumberOfThreads passed");
-      setNumberOfThreads(iValue);
+      Jacobian_Return_Value RetVal = solver->jacobianTransposeTimesVector(t, yData, userData->SensitivityParameters, v + block * N, Jv + block * N);
+
+      if (RetVal == JACOBIAN_RECOVERABLE_ERROR)
+         return 1;
+      if (RetVal != JACOBIAN_OK)
+         return -1;
    }
-   else
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown CVODE solver option passed: " + name);
 
+   N_VScale(-1.0, JvB, JvB);
+
+   return 0;
 }
 
-int SimModelSolver_CVODES::Rhs(realtype t, N_Vector y, N_Vector ydot,
-   void* user_data)
+int SimModelSolver_CVODES::CVODE_DirectionalSensitivityRhsFn(int Ns, realtype t, N_Vector y, N_Vector ydot, int iS,
+   N_Vector yS, N_Vector ySdot, void* user_data,
+   N_Vector tmp1, N_Vector tmp2)
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::Rhs";
-
-   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
-   //This instance cannot be accessed from Rhs because it's a static member
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_DirectionalSensitivityRhsFn";
 
    UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
    if (!userData)
       throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
 
-   //get pointer to the Solver caller instance and call the ODE RHS function
-   ISolverCaller* pSolverCaller = userData->Solver->GetSolverCaller();
+   SimModelSolver_CVODES* solver = userData->Solver;
 
-   //get new values of sensitivity parameters
-   const double* p = userData->SensitivityParameters;
+   SolverInstrumentation::ScopedTimer timer(solver->_instrumentation, SolverInstrumentation::SENSITIVITY_RHS);
 
 #ifdef _OPENMP
-   Rhs_Return_Value RetVal = pSolverCaller->ODERhsFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(ydot), NULL);
+   const double* yData = NV_DATA_OMP(y);
+   const double* ydotData = NV_DATA_OMP(ydot);
+   const double* ySData = NV_DATA_OMP(yS);
+   double* ySdotData = NV_DATA_OMP(ySdot);
 #else
-   Rhs_Return_Value RetVal = pSolverCaller->ODERhsFunction(t, NV_DATA_S(y), p, NV_DATA_S(ydot), NULL);
+   const double* yData = NV_DATA_S(y);
+   const double* ydotData = NV_DATA_S(ydot);
+   const double* ySData = NV_DATA_S(yS);
+   double* ySdotData = NV_DATA_S(ySdot);
 #endif
 
-   if (RetVal == RHS_OK)
+   //s' = (df/dy)*s + (df/dp)*u = (f(y+epsilon*s, p+epsilon*u) - f(y,p))/epsilon
+   double epsilon = solver->directionalPerturbation(yData, ySData, userData->SensitivityParameters);
+   if (epsilon == 0.0)
+   {
+      N_VConst(0.0, ySdot);
       return 0;
+   }
+
+   Rhs_Return_Value RetVal = solver->callRhs(t, &solver->_secondOrderY[0], &solver->_secondOrderP[0], ySdotData);
 
    if (RetVal == RHS_RECOVERABLE_ERROR)
       return 1;
+   if (RetVal != RHS_OK)
+      return -1;
 
-   return -1; //unrecoverable Error
+   for (int i = 0; i < solver->_problemSize; i++)
+      ySdotData[i] = (ySdotData[i] - ydotData[i]) / epsilon;
+
+   return 0;
 }
 
+int SimModelSolver_CVODES::CVODE_SecondOrderAdjointRhsFn(realtype t, N_Vector y, N_Vector* yS, N_Vector yB, N_Vector yBdot, void* user_dataB)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_SecondOrderAdjointRhsFn";
 
-int SimModelSolver_CVODES::CVODE_SensitivityRhsFunction(int Ns, realtype t, N_Vector y, N_Vector ydot, int iS,
-   N_Vector yS, N_Vector ySdot, void* user_data,
-   N_Vector tmp1, N_Vector tmp2)
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+#ifdef _OPENMP
+   return userData->Solver->secondOrderAdjointRhs(t, NV_DATA_OMP(y), NV_DATA_OMP(yS[0]), userData->SensitivityParameters,
+                                                  NV_DATA_OMP(yB), NV_DATA_OMP(yBdot));
+#else
+   return userData->Solver->secondOrderAdjointRhs(t, NV_DATA_S(y), NV_DATA_S(yS[0]), userData->SensitivityParameters,
+                                                  NV_DATA_S(yB), NV_DATA_S(yBdot));
+#endif
+}
+
+int SimModelSolver_CVODES::CVODE_SecondOrderAdjointQuadratureRhsFn(realtype t, N_Vector y, N_Vector* yS, N_Vector yB, N_Vector qBdot, void* user_dataB)
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_SensitivityRhsFunction";
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_SecondOrderAdjointQuadratureRhsFn";
 
-   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
-   //This instance cannot be accessed from Rhs because it's a static member
+   UserData* userData = dynamic_cast<UserData*> ((UserData*)user_dataB);
+   if (!userData)
+      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
+
+#ifdef _OPENMP
+   return userData->Solver->secondOrderAdjointQuadratureRhs(t, NV_DATA_OMP(y), NV_DATA_OMP(yS[0]), userData->SensitivityParameters,
+                                                            NV_DATA_OMP(yB), NV_DATA_OMP(qBdot));
+#else
+   return userData->Solver->secondOrderAdjointQuadratureRhs(t, NV_DATA_S(y), NV_DATA_S(yS[0]), userData->SensitivityParameters,
+                                                            NV_DATA_S(yB), NV_DATA_S(qBdot));
+#endif
+}
+
+int SimModelSolver_CVODES::CVODE_SecondOrderAdjointJacFn(realtype t, N_Vector y, N_Vector* yS, N_Vector yB, N_Vector fyB, SUNMatrix JB,
+   void* user_dataB, N_Vector tmp1B, N_Vector tmp2B, N_Vector tmp3B)
+{
+   //block diagonal jacobian, independent of the directional sensitivity
+   return CVODE_AdjointJacFn(t, y, yB, fyB, JB, user_dataB, tmp1B, tmp2B, tmp3B);
+}
+
+int SimModelSolver_CVODES::CVODE_SecondOrderAdjointJacTimesVecFn(N_Vector vB, N_Vector JvB, realtype t, N_Vector y, N_Vector* yS,
+   N_Vector yB, N_Vector fyB, void* user_dataB, N_Vector tmpB)
+{
+   //block diagonal jacobian, independent of the directional sensitivity
+   return CVODE_AdjointJacTimesVecFn(vB, JvB, t, y, yB, fyB, user_dataB, tmpB);
+}
+
+int SimModelSolver_CVODES::CVODE_QuadratureRhsFn(realtype t, N_Vector y, N_Vector qdot, void* user_data)
+{
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_QuadratureRhsFn";
 
    UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
    if (!userData)
       throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
 
-   //get pointer to the Solver caller instance and call ODE Sensitivity RHS function
-   ISolverCaller* pSolverCaller = userData->Solver->GetSolverCaller();
+   SimModelSolver_CVODES* solver = userData->Solver;
+
+   //get new values of sensitivity parameters
+   const double* p = userData->SensitivityParameters;
 
 #ifdef _OPENMP
-   Sensitivity_Rhs_Return_Value RetVal = pSolverCaller->ODESensitivityRhsFunction(t, NV_DATA_OMP(y), NV_DATA_OMP(ydot), iS, NV_DATA_OMP(yS), NV_DATA_OMP(ySdot), NULL);
+   const double* yData = NV_DATA_OMP(y);
+   double* qdotData = NV_DATA_OMP(qdot);
 #else
-   Sensitivity_Rhs_Return_Value RetVal = pSolverCaller->ODESensitivityRhsFunction(t, NV_DATA_S(y), NV_DATA_S(ydot), iS, NV_DATA_S(yS), NV_DATA_S(ySdot), NULL);
+   const double* yData = NV_DATA_S(y);
+   double* qdotData = NV_DATA_S(qdot);
 #endif
 
-   if (RetVal == SENSITIVITY_RHS_OK)
+   //quadratures are defined in caller state order
+   if (!solver->_statePermutation.empty())
+   {
+      solver->toCallerOrder(yData, &solver->_callerY[0]);
+      yData = &solver->_callerY[0];
+   }
+
+   Rhs_Return_Value RetVal = solver->_solverCallerCVODES->ODEQuadratureRhsFunction(t, yData, p, qdotData, NULL);
+
+   if (RetVal == RHS_OK)
       return 0;
 
-   if (RetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+   if (RetVal == RHS_RECOVERABLE_ERROR)
       return 1;
 
    return -1; //unrecoverable Error
 }
 
-int SimModelSolver_CVODES::CVODE_JacFn(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
-   void* user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+int SimModelSolver_CVODES::CVODE_RootFn(realtype t, N_Vector y, realtype* gout, void* user_data)
 {
-   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_JacFn";
-
-   //user_data MUST provide pointer to the instance of SimModelSolver_CVODES class
-   //This instance cannot be accessed from CVODE_JacFn because it's a static member
+   const char* ERROR_SOURCE = "SimModelSolver_CVODES::CVODE_RootFn";
 
    UserData* userData = dynamic_cast<UserData*> ((UserData*)user_data);
    if (!userData)
       throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Missing class instance pointer");
 
-   //get pointer to the Solver caller instance and call the ODE RHS function
-   ISolverCaller* pSolverCaller = userData->Solver->GetSolverCaller();
+   SimModelSolver_CVODES* solver = userData->Solver;
 
    //get new values of sensitivity parameters
    const double* p = userData->SensitivityParameters;
 
-   Jacobian_Return_Value RetVal;
-
-   if (pSolverCaller->IsSet_ODEJacFunction())
-   {
-      double** cols;
-      if (pSolverCaller->UseBandLinearSolver())
-         cols = SUNBandMatrix_Cols(J);
-      else
-         cols = SUNDenseMatrix_Cols(J);
-
 #ifdef _OPENMP
-      RetVal = pSolverCaller->ODEJacFunction(t, NV_DATA_OMP(y), p, NV_DATA_OMP(fy), cols, NULL);
+   const double* yData = NV_DATA_OMP(y);
 #else
-      RetVal = pSolverCaller->ODEJacFunction(t, NV_DATA_S(y), p, NV_DATA_S(fy), cols, NULL);
+   const double* yData = NV_DATA_S(y);
 #endif
-   }
-   else
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Jacobian function not set");
 
-   if (RetVal == JACOBIAN_OK)
-      return 0;
+   //root functions are defined in caller state order
+   if (!solver->_statePermutation.empty())
+   {
+      solver->toCallerOrder(yData, &solver->_callerY[0]);
+      yData = &solver->_callerY[0];
+   }
 
-   if (RetVal == JACOBIAN_RECOVERABLE_ERROR)
-      return 1;
+   Root_Return_Value RetVal = solver->_solverCallerCVODES->ODERootFunction(t, yData, p, gout, NULL);
 
-   return -1; //unrecoverable error
+   return (RetVal == ROOT_OK) ? 0 : -1;
 }
 
 void SimModelSolver_CVODES::FillSolverOptions(void)
@@ -722,87 +4201,120 @@ void SimModelSolver_CVODES::FillSolverOptions(void)
    const char* ERROR_SOURCE = "SimModelSolver_CVODES::FillSolverOptions";
    int flag;
 
-   //relative tolerance
-   _relTol_CVODE = _relTol;
+   //after CVodeCreate all options are passed, afterwards (ReInit) only the changed ones
+   bool passAll = !_passedSolverOptions.Valid;
+   PassedSolverOptions& passed = _passedSolverOptions;
 
    _step = 0;
 
-   //absolute tolerance
-   if (_absTol_NV)
+   //relative and absolute tolerance
+   if (passAll || (_relTol != passed.RelTol) || (_absTol != passed.AbsTol))
    {
-#ifdef _OPENMP
-      N_VDestroy_OpenMP(_absTol_NV);
-#else
-      N_VDestroy_Serial(_absTol_NV);
-#endif
-   }
+      _relTol_CVODE = _relTol;
 
+      //CVODES copies the absolute tolerances, so the vector is reused
+      if (!_absTol_NV)
+      {
 #ifdef _OPENMP
-   _absTol_NV = N_VNew_OpenMP(_problemSize, getNumberOfThreads());
+         _absTol_NV = N_VNew_OpenMP(_problemSize, getNumberOfThreads());
 #else
-   _absTol_NV = N_VNew_Serial(_problemSize);
+         _absTol_NV = N_VNew_Serial(_problemSize);
 #endif
-   if (!_absTol_NV)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for absolute tolerances");
+         if (!_absTol_NV)
+            throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot allocate memory for absolute tolerances");
+      }
 
-   for (int i = 0; i < _problemSize; i++)
-      NV_Ith_S(_absTol_NV, i) = _absTol[i];
+      for (int i = 0; i < _problemSize; i++)
+         NV_Ith_S(_absTol_NV, i) = _absTol[callerStateIndex(i)];
 
-   //set solver tolerances
-   flag = CVodeSVtolerances(_cvodeMem, _relTol_CVODE, _absTol_NV);
-   switch (flag)
-   {
-   case CV_SUCCESS:
-      break;
-   case CV_MEM_NULL:
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
-         "The cvode memory block was not initialized through a previous call to CVodeCreate");
-   case CV_NO_MALLOC:
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
-         "The allocation function CVodeInit has not been called.");
-   case CV_ILL_INPUT:
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
-         "The relative error tolerance was negative or the absolute tolerance had a negative component.");
-   default:
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
-         "CVodeSVtolerances returned unexpected value.");
+      //set solver tolerances
+      flag = CVodeSVtolerances(_cvodeMem, _relTol_CVODE, _absTol_NV);
+      switch (flag)
+      {
+      case CV_SUCCESS:
+         break;
+      case CV_MEM_NULL:
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+            "The cvode memory block was not initialized through a previous call to CVodeCreate");
+      case CV_NO_MALLOC:
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+            "The allocation function CVodeInit has not been called.");
+      case CV_ILL_INPUT:
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+            "The relative error tolerance was negative or the absolute tolerance had a negative component.");
+      default:
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+            "CVodeSVtolerances returned unexpected value.");
+      }
+
+      passed.RelTol = _relTol;
+      passed.AbsTol = _absTol;
    }
 
-   //pass pointer to the actual class instance (casted to void *)
-   flag = CVodeSetUserData(_cvodeMem, CVODES_UserData);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetUserData failed.");
+   if (passAll)
+   {
+      //pass pointer to the actual class instance (casted to void *)
+      flag = CVodeSetUserData(_cvodeMem, CVODES_UserData);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetUserData failed.");
+   }
 
    //maximum order of the linear multistep method
-   flag = CVodeSetMaxOrd(_cvodeMem, _maxOrd);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
-         "CVodeSetMaxOrder: The specified value is <= 0, or larger than its previous value.");
+   if (passAll || (_maxOrd != passed.MaxOrd))
+   {
+      flag = CVodeSetMaxOrd(_cvodeMem, _maxOrd);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+            "CVodeSetMaxOrder: The specified value is <= 0, or larger than its previous value.");
+      passed.MaxOrd = _maxOrd;
+   }
 
    //maximum number of steps to be taken by the solver in its attempt to reach the next output time.
-   flag = CVodeSetMaxNumSteps(_cvodeMem, _mxStep);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxNumSteps failed.");
+   if (passAll || (_mxStep != passed.MxStep))
+   {
+      flag = CVodeSetMaxNumSteps(_cvodeMem, _mxStep);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxNumSteps failed.");
+      passed.MxStep = _mxStep;
+   }
 
    //maximum number of messages issued by the solver warning that t + h = t on the next internal step.
-   flag = CVodeSetMaxHnilWarns(_cvodeMem, _mxHNil);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxHnilWarns failed.");
+   if (passAll || (_mxHNil != passed.MxHNil))
+   {
+      flag = CVodeSetMaxHnilWarns(_cvodeMem, _mxHNil);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxHnilWarns failed.");
+      passed.MxHNil = _mxHNil;
+   }
 
    //specifies the initial step size.
-   flag = CVodeSetInitStep(_cvodeMem, _h0);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetInitStep failed.");
+   if (passAll || (_h0 != passed.H0))
+   {
+      flag = CVodeSetInitStep(_cvodeMem, _h0);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetInitStep failed.");
+      passed.H0 = _h0;
+   }
 
-   //specifies the initial step size.
-   flag = CVodeSetMaxStep(_cvodeMem, _hMax);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxStep failed.");
+   //specifies the maximum step size.
+   if (passAll || (_hMax != passed.HMax))
+   {
+      flag = CVodeSetMaxStep(_cvodeMem, _hMax);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMaxStep failed.");
+      passed.HMax = _hMax;
+   }
 
-   //specifies the initial step size.
-   flag = CVodeSetMinStep(_cvodeMem, _hMin);
-   if (flag != CV_SUCCESS)
-      throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMinStep failed.");
+   //specifies the minimum step size.
+   if (passAll || (_hMin != passed.HMin))
+   {
+      flag = CVodeSetMinStep(_cvodeMem, _hMin);
+      if (flag != CV_SUCCESS)
+         throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "CVodeSetMinStep failed.");
+      passed.HMin = _hMin;
+   }
+
+   passed.Valid = true;
 }
 
 UserData::UserData()
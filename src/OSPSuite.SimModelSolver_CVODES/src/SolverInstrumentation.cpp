@@ -0,0 +1,251 @@
+#include "SimModelSolver_CVODES/SolverInstrumentation.h"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+SolverInstrumentation::SolverInstrumentation()
+{
+   Reset();
+}
+
+void SolverInstrumentation::Reset()
+{
+   for (int i = 0; i < NUMBER_OF_SECTIONS; i++)
+   {
+      _numberOfCalls[i] = 0;
+      _times[i] = chrono::steady_clock::duration::zero();
+   }
+}
+
+long SolverInstrumentation::GetNumberOfCalls(SECTION section) const
+{
+   return _numberOfCalls[section];
+}
+
+double SolverInstrumentation::GetTime(SECTION section) const
+{
+   return chrono::duration<double>(_times[section]).count();
+}
+
+const char* SolverInstrumentation::GetSectionName(SECTION section)
+{
+   switch (section)
+   {
+   case RHS:
+      return "rhs";
+   case JACOBIAN:
+      return "jacobian";
+   case SENSITIVITY_RHS:
+      return "sensitivity_rhs";
+   case LINEAR_SOLVER_SETUP:
+      return "linear_solver_setup";
+   case LINEAR_SOLVE:
+      return "linear_solve";
+   case INTEGRATION:
+      return "integration";
+   case SOLVER_STEP:
+      return "solver_step";
+   default:
+      return "unknown";
+   }
+}
+
+string SolverInstrumentation::GetReport(bool csv) const
+{
+   ostringstream report;
+   report.precision(9);
+
+   if (csv)
+      report << "section,calls,time_s,mean_time_s\n";
+   else
+      report << "{\"sections\":{";
+
+   for (int i = 0; i < NUMBER_OF_SECTIONS; i++)
+   {
+      SECTION section = (SECTION)i;
+      long calls = GetNumberOfCalls(section);
+      double time = GetTime(section);
+      double meanTime = calls > 0 ? time / calls : 0.0;
+
+      if (csv)
+         report << GetSectionName(section) << "," << calls << "," << time << "," << meanTime << "\n";
+      else
+         report << (i > 0 ? "," : "") << "\"" << GetSectionName(section) << "\":{\"calls\":" << calls
+                << ",\"time_s\":" << time << ",\"mean_time_s\":" << meanTime << "}";
+   }
+
+   //time of the solver step calls outside of CVode
+   double wrapperOverhead = GetTime(SOLVER_STEP) - GetTime(INTEGRATION);
+   if (csv)
+      report << "wrapper_overhead,," << wrapperOverhead << ",\n";
+   else
+      report << "},\"wrapper_overhead_s\":" << wrapperOverhead << "}\n";
+
+   return report.str();
+}
+
+bool SolverInstrumentation::WriteReport(const string& fileName) const
+{
+   const string CSV_EXTENSION = ".csv";
+   bool csv = (fileName.size() >= CSV_EXTENSION.size()) &&
+              (fileName.compare(fileName.size() - CSV_EXTENSION.size(), CSV_EXTENSION.size(), CSV_EXTENSION) == 0);
+
+   ofstream file(fileName.c_str());
+   if (!file)
+      return false;
+
+   file << GetReport(csv);
+
+   return !file.fail();
+}
+
+//---- timed linear solver: forwards all operations to the wrapped one
+
+struct TimedLinearSolverContent
+{
+   SUNLinearSolver LinearSolver;
+   SolverInstrumentation* Instrumentation;
+};
+
+static SUNLinearSolver wrappedLinearSolver(SUNLinearSolver S)
+{
+   return ((TimedLinearSolverContent*)S->content)->LinearSolver;
+}
+
+static SUNLinearSolver_Type timedLinearSolverGetType(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->gettype(linearSolver);
+}
+
+static SUNLinearSolver_ID timedLinearSolverGetID(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->getid(linearSolver);
+}
+
+static int timedLinearSolverSetATimes(SUNLinearSolver S, void* A_data, ATimesFn ATimes)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->setatimes(linearSolver, A_data, ATimes);
+}
+
+static int timedLinearSolverSetPreconditioner(SUNLinearSolver S, void* P_data, PSetupFn Pset, PSolveFn Psol)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->setpreconditioner(linearSolver, P_data, Pset, Psol);
+}
+
+static int timedLinearSolverSetScalingVectors(SUNLinearSolver S, N_Vector s1, N_Vector s2)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->setscalingvectors(linearSolver, s1, s2);
+}
+
+static int timedLinearSolverSetZeroGuess(SUNLinearSolver S, booleantype onoff)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->setzeroguess(linearSolver, onoff);
+}
+
+static int timedLinearSolverInitialize(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->initialize(linearSolver);
+}
+
+static int timedLinearSolverSetup(SUNLinearSolver S, SUNMatrix A)
+{
+   TimedLinearSolverContent* content = (TimedLinearSolverContent*)S->content;
+   SolverInstrumentation::ScopedTimer timer(content->Instrumentation, SolverInstrumentation::LINEAR_SOLVER_SETUP);
+
+   return content->LinearSolver->ops->setup(content->LinearSolver, A);
+}
+
+static int timedLinearSolverSolve(SUNLinearSolver S, SUNMatrix A, N_Vector x, N_Vector b, realtype tol)
+{
+   TimedLinearSolverContent* content = (TimedLinearSolverContent*)S->content;
+   SolverInstrumentation::ScopedTimer timer(content->Instrumentation, SolverInstrumentation::LINEAR_SOLVE);
+
+   return content->LinearSolver->ops->solve(content->LinearSolver, A, x, b, tol);
+}
+
+static int timedLinearSolverNumIters(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->numiters(linearSolver);
+}
+
+static realtype timedLinearSolverResNorm(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->resnorm(linearSolver);
+}
+
+static sunindextype timedLinearSolverLastFlag(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->lastflag(linearSolver);
+}
+
+static int timedLinearSolverSpace(SUNLinearSolver S, long int* lenrwLS, long int* leniwLS)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->space(linearSolver, lenrwLS, leniwLS);
+}
+
+static N_Vector timedLinearSolverResid(SUNLinearSolver S)
+{
+   SUNLinearSolver linearSolver = wrappedLinearSolver(S);
+   return linearSolver->ops->resid(linearSolver);
+}
+
+static int timedLinearSolverFree(SUNLinearSolver S)
+{
+   if (!S)
+      return SUNLS_SUCCESS;
+
+   //the wrapped linear solver is owned by the caller
+   delete (TimedLinearSolverContent*)S->content;
+   S->content = NULL;
+   SUNLinSolFreeEmpty(S);
+
+   return SUNLS_SUCCESS;
+}
+
+SUNLinearSolver SolverInstrumentation::CreateTimedLinearSolver(SUNLinearSolver linearSolver)
+{
+   if (!linearSolver)
+      return NULL;
+
+   SUNLinearSolver S = SUNLinSolNewEmpty();
+   if (!S)
+      return NULL;
+
+   TimedLinearSolverContent* content = new TimedLinearSolverContent();
+   content->LinearSolver = linearSolver;
+   content->Instrumentation = this;
+   S->content = content;
+
+   //optional operations remain NULL if the wrapped linear solver does not provide them
+   SUNLinearSolver_Ops ops = linearSolver->ops;
+
+   S->ops->gettype = ops->gettype ? timedLinearSolverGetType : NULL;
+   S->ops->getid = ops->getid ? timedLinearSolverGetID : NULL;
+   S->ops->setatimes = ops->setatimes ? timedLinearSolverSetATimes : NULL;
+   S->ops->setpreconditioner = ops->setpreconditioner ? timedLinearSolverSetPreconditioner : NULL;
+   S->ops->setscalingvectors = ops->setscalingvectors ? timedLinearSolverSetScalingVectors : NULL;
+   S->ops->setzeroguess = ops->setzeroguess ? timedLinearSolverSetZeroGuess : NULL;
+   S->ops->initialize = ops->initialize ? timedLinearSolverInitialize : NULL;
+   S->ops->setup = ops->setup ? timedLinearSolverSetup : NULL;
+   S->ops->solve = ops->solve ? timedLinearSolverSolve : NULL;
+   S->ops->numiters = ops->numiters ? timedLinearSolverNumIters : NULL;
+   S->ops->resnorm = ops->resnorm ? timedLinearSolverResNorm : NULL;
+   S->ops->lastflag = ops->lastflag ? timedLinearSolverLastFlag : NULL;
+   S->ops->space = ops->space ? timedLinearSolverSpace : NULL;
+   S->ops->resid = ops->resid ? timedLinearSolverResid : NULL;
+   S->ops->free = timedLinearSolverFree;
+
+   return S;
+}
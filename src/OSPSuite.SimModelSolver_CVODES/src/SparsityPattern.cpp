@@ -0,0 +1,232 @@
+#include "SimModelSolver_CVODES/SparsityPattern.h"
+#include <algorithm>
+
+using namespace std;
+
+SparsityPattern::SparsityPattern()
+{
+   PatternFormat = CSC;
+   IndexPointers.push_back(0);
+}
+
+SparsityPattern::SparsityPattern(int problemSize, Format format)
+{
+   PatternFormat = format;
+   IndexPointers.assign(problemSize + 1, 0);
+}
+
+int SparsityPattern::GetProblemSize() const
+{
+   return (int)IndexPointers.size() - 1;
+}
+
+int SparsityPattern::GetNumberOfNonZeros() const
+{
+   return (int)IndexValues.size();
+}
+
+bool SparsityPattern::IsValid(int problemSize) const
+{
+   if ((int)IndexPointers.size() != problemSize + 1)
+      return false;
+
+   if (IndexPointers[0] != 0 || IndexPointers[problemSize] != GetNumberOfNonZeros())
+      return false;
+
+   for (int j = 0; j < problemSize; j++)
+   {
+      if (IndexPointers[j + 1] < IndexPointers[j])
+         return false;
+   }
+
+   for (size_t k = 0; k < IndexValues.size(); k++)
+   {
+      if (IndexValues[k] < 0 || IndexValues[k] >= problemSize)
+         return false;
+   }
+
+   return true;
+}
+
+void SparsityPattern::GetHalfBandWidths(int & lowerHalfBandWidth, int & upperHalfBandWidth) const
+{
+   lowerHalfBandWidth = 0;
+   upperHalfBandWidth = 0;
+
+   for (int j = 0; j < GetProblemSize(); j++)
+   {
+      for (int k = IndexPointers[j]; k < IndexPointers[j + 1]; k++)
+      {
+         //CSC: j is the column, CSR: j is the row
+         int distance = (PatternFormat == CSC) ? IndexValues[k] - j : j - IndexValues[k];
+
+         lowerHalfBandWidth = max(lowerHalfBandWidth, distance);
+         upperHalfBandWidth = max(upperHalfBandWidth, -distance);
+      }
+   }
+}
+
+SparsityPattern SparsityPattern::Normalized(vector<int> & valueMap) const
+{
+   int problemSize = GetProblemSize();
+   SparsityPattern normalized(problemSize, PatternFormat);
+
+   vector<int> indices;
+   bool identical = true;
+
+   valueMap.assign(IndexValues.size(), -1);
+
+   for (int j = 0; j < problemSize; j++)
+   {
+      //indices of column (row) j including the diagonal, sorted and unique
+      indices.assign(IndexValues.begin() + IndexPointers[j], IndexValues.begin() + IndexPointers[j + 1]);
+      indices.push_back(j);
+      sort(indices.begin(), indices.end());
+      indices.erase(unique(indices.begin(), indices.end()), indices.end());
+
+      int offset = (int)normalized.IndexValues.size();
+      normalized.IndexValues.insert(normalized.IndexValues.end(), indices.begin(), indices.end());
+      normalized.IndexPointers[j + 1] = (int)normalized.IndexValues.size();
+
+      for (int k = IndexPointers[j]; k < IndexPointers[j + 1]; k++)
+      {
+         valueMap[k] = offset + (int)(lower_bound(indices.begin(), indices.end(), IndexValues[k]) - indices.begin());
+         if (valueMap[k] != k)
+            identical = false;
+      }
+   }
+
+   if (identical && normalized.GetNumberOfNonZeros() == GetNumberOfNonZeros())
+      valueMap.clear();
+
+   return normalized;
+}
+
+SparsityPattern SparsityPattern::Permuted(const vector<int> & permutation) const
+{
+   int problemSize = GetProblemSize();
+   SparsityPattern permuted(problemSize, PatternFormat);
+
+   vector<int> inversePermutation(problemSize);
+   for (int k = 0; k < problemSize; k++)
+      inversePermutation[permutation[k]] = k;
+
+   //column (row) k of the permuted pattern is column (row) permutation[k] of the original one
+   for (int k = 0; k < problemSize; k++)
+   {
+      int j = permutation[k];
+      for (int l = IndexPointers[j]; l < IndexPointers[j + 1]; l++)
+         permuted.IndexValues.push_back(inversePermutation[IndexValues[l]]);
+
+      permuted.IndexPointers[k + 1] = permuted.GetNumberOfNonZeros();
+   }
+
+   return permuted;
+}
+
+vector<int> SparsityPattern::ReverseCuthillMcKee() const
+{
+   int i, j, k;
+   int problemSize = GetProblemSize();
+
+   //adjacency structure of A+A^T without diagonal
+   vector<vector<int> > neighbours(problemSize);
+   for (j = 0; j < problemSize; j++)
+   {
+      for (k = IndexPointers[j]; k < IndexPointers[j + 1]; k++)
+      {
+         i = IndexValues[k];
+         if (i == j)
+            continue;
+         neighbours[i].push_back(j);
+         neighbours[j].push_back(i);
+      }
+   }
+
+   vector<int> degrees(problemSize);
+   for (i = 0; i < problemSize; i++)
+   {
+      sort(neighbours[i].begin(), neighbours[i].end());
+      neighbours[i].erase(unique(neighbours[i].begin(), neighbours[i].end()), neighbours[i].end());
+      degrees[i] = (int)neighbours[i].size();
+   }
+
+   //neighbours are visited in the order of increasing degree
+   for (i = 0; i < problemSize; i++)
+   {
+      sort(neighbours[i].begin(), neighbours[i].end(),
+           [&degrees](int a, int b) { return degrees[a] < degrees[b] || (degrees[a] == degrees[b] && a < b); });
+   }
+
+   vector<int> ordering;
+   ordering.reserve(problemSize);
+
+   vector<bool> visited(problemSize, false);
+   vector<int> level(problemSize, -1);
+
+   //breadth first search from root; returns the visited nodes in BFS order
+   auto breadthFirstSearch = [&](int root, vector<int> & nodes)
+   {
+      nodes.clear();
+      nodes.push_back(root);
+      level[root] = 0;
+
+      for (size_t head = 0; head < nodes.size(); head++)
+      {
+         int node = nodes[head];
+         for (int neighbour : neighbours[node])
+         {
+            if (visited[neighbour] || level[neighbour] >= 0)
+               continue;
+            level[neighbour] = level[node] + 1;
+            nodes.push_back(neighbour);
+         }
+      }
+   };
+
+   vector<int> component;
+
+   for (int start = 0; start < problemSize; start++)
+   {
+      if (visited[start])
+         continue;
+
+      //pseudo peripheral root: repeatedly move to a node of minimal degree in the last BFS level
+      int root = start;
+      int eccentricity = -1;
+      for (int iteration = 0; iteration < 5; iteration++)
+      {
+         breadthFirstSearch(root, component);
+
+         int lastLevel = level[component.back()];
+         int candidate = component.back();
+         for (int node : component)
+         {
+            if (level[node] == lastLevel && degrees[node] < degrees[candidate])
+               candidate = node;
+         }
+
+         for (int node : component)
+            level[node] = -1;
+
+         if (lastLevel <= eccentricity)
+            break;
+
+         eccentricity = lastLevel;
+         root = candidate;
+      }
+
+      //Cuthill-McKee ordering of the component
+      breadthFirstSearch(root, component);
+      for (int node : component)
+      {
+         visited[node] = true;
+         level[node] = -1;
+         ordering.push_back(node);
+      }
+   }
+
+   reverse(ordering.begin(), ordering.end());
+
+   return ordering;
+}
@@ -0,0 +1,17 @@
+#ifndef _AllocationCounter_H_
+#define _AllocationCounter_H_
+
+//Counts the heap allocations of the benchmark process (all threads, all modules).
+//
+//With glibc, malloc/calloc/realloc are interposed, so allocations inside the CVODES library
+//(e.g. N_VNew_Serial) are counted as well. Otherwise only C++ operator new is counted.
+class AllocationCounter
+{
+public:
+	static long long NumberOfAllocations();
+
+	//true if C allocations (malloc etc.) are counted as well
+	static bool CountsCAllocations();
+};
+
+#endif //_AllocationCounter_H_
@@ -0,0 +1,248 @@
+#ifndef _BenchmarkSolverCallers_H_
+#define _BenchmarkSolverCallers_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolver_CVODES/ISolverCaller_CVODES.h"
+
+#include <string>
+#include <vector>
+
+//Native (non C++/CLI) solver callers used by the benchmark driver.
+//All callers count their own RHS and jacobian evaluations, so the numbers
+//reported by the benchmark do not depend on any statistics exposed by the solver
+class BenchmarkSolverCallerBase : public ISolverCaller_CVODES
+{
+protected:
+	bool _useJacobian;
+	bool _bandLinearSolver;
+	bool _sparseLinearSolver;
+	bool _usePreconditioner;
+	bool _provideSparsityPattern;
+	int _lowerHalfBandWidth, _upperHalfBandWidth;
+
+public:
+	long NumberOfRhsEvaluations;
+	long NumberOfJacobianEvaluations;
+
+	BenchmarkSolverCallerBase();
+	virtual ~BenchmarkSolverCallerBase() {}
+
+	void ResetCounters();
+
+	//benchmark description
+	virtual std::string Name() = 0;
+	virtual int ProblemSize() = 0;
+	virtual std::vector<double> InitialValues() = 0;
+	virtual std::vector<double> AbsoluteTolerances();
+	virtual double RelativeTolerance() { return 1e-6; }
+	virtual double EndTime() = 0;
+
+	//output time points (default: 100 equidistant points in (0, EndTime])
+	virtual std::vector<double> OutputTimes();
+
+	//sensitivity parameters (if any)
+	virtual std::vector<double> SensitivityParameterValues() { return std::vector<double>(); }
+
+	void SetUseJacobian(bool useJacobian) { _useJacobian = useJacobian; }
+	void SetBandLinearSolver(bool useBand, int lowerHalfBandWidth, int upperHalfBandWidth);
+	void SetSparseLinearSolver(bool useSparse) { _sparseLinearSolver = useSparse; }
+	void SetUsePreconditioner(bool usePreconditioner) { _usePreconditioner = usePreconditioner; }
+
+	//if false, the jacobian sparsity pattern is not passed to the solver (e.g. to benchmark sparsity detection)
+	void SetProvideSparsityPattern(bool provideSparsityPattern) { _provideSparsityPattern = provideSparsityPattern; }
+
+	//---- ISolverCaller
+	Rhs_Return_Value DDERhsFunction(double t, const double * y, const double * * yd, double * ydot, void * f_data) { return RHS_FAILED; }
+	void DDEDelayFunction(double t, const double * y, double * delays, void * delays_data) {}
+	Sensitivity_Rhs_Return_Value ODESensitivityRhsFunction(double t, const double * y, double * ydot, int iS, const double * yS, double * ySdot, void * f_data)
+	{
+		return SENSITIVITY_RHS_FAILED;
+	}
+
+	bool IsSet_ODERhsFunction() { return true; }
+	bool IsSet_ODEJacFunction() { return _useJacobian; }
+	bool IsSet_DDERhsFunction() { return false; }
+	bool IsSet_ODESensitivityRhsFunction() { return false; }
+	bool UseBandLinearSolver() { return _bandLinearSolver; }
+	int GetLowerHalfBandWidth() { return _lowerHalfBandWidth; }
+	int GetUpperHalfBandWidth() { return _upperHalfBandWidth; }
+
+	//---- ISolverCaller_CVODES
+	bool UseSparseLinearSolver() { return _sparseLinearSolver; }
+	bool IsSet_ODESparseJacFunction() { return _useJacobian && _sparseLinearSolver; }
+	bool IsSet_PreconditionerFunctions() { return _usePreconditioner; }
+};
+
+//3-species chemical kinetics problem from the CVODES example cvsRoberts_FSA_dns
+//(same system as TestSolverCaller_cvsRoberts_FSA_dns in SolverSpecs.cpp)
+//
+//  dy1/dt = -p1*y1 + p2*y2*y3
+//  dy2/dt =  p1*y1 - p2*y2*y3 - p3*y2^2
+//  dy3/dt =  p3*y2^2
+//
+//p1 = 0.04, p2 = 1e4, p3 = 3e7; y(0) = (1, 0, 0)
+class TestSolverCaller_cvsRoberts_FSA_dns : public BenchmarkSolverCallerBase
+{
+public:
+	TestSolverCaller_cvsRoberts_FSA_dns();
+
+	std::string Name() { return "Roberts"; }
+	int ProblemSize() { return 3; }
+	std::vector<double> InitialValues();
+	std::vector<double> AbsoluteTolerances();
+	double RelativeTolerance() { return 1e-4; }
+	double EndTime() { return 4e10; }
+	std::vector<double> OutputTimes();
+	std::vector<double> SensitivityParameterValues();
+
+	Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data);
+	Jacobian_Return_Value ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data);
+};
+
+//Whole-body PBPK-like system with an arbitrary number of organs.
+//
+//Each organ consists of plasma, interstitial and intracellular sub compartments.
+//Organ plasma is fed from the arterial blood pool and drains into the venous blood pool,
+//the venous pool is connected to the arterial pool via the lung. The liver eliminates
+//intracellular drug by Michaelis-Menten kinetics, the first organ is fed by first order
+//absorption from a gut lumen compartment.
+//
+//The arterial and venous pools couple to every organ, so the jacobian has an
+//"arrow" structure which is sparse but not narrow-banded.
+//
+//State layout: [lumen, arterial, venous, organ_0(pls, int, cell), organ_1(...), ..., (AUC_0, AUC_1, ...)]
+//
+//Optionally the plasma AUC of every organ is calculated, either as additional ODE states
+//or as quadratures (which do not enter the Newton system).
+//
+//Optionally the organ permeabilities are sensitivity parameters; the objective for adjoint
+//sensitivities is the venous AUC (g = venous concentration). The sensitivity RHS is calculated
+//by CVODES (difference quotients), per parameter or for all parameters at once
+class TestSolverCaller_PBPK : public BenchmarkSolverCallerBase
+{
+public:
+	enum AUC_OUTPUT { AUC_NONE, AUC_STATES, AUC_QUADRATURES };
+	enum SENSITIVITY_RHS { SENSITIVITY_RHS_NONE, SENSITIVITY_RHS_SINGLE, SENSITIVITY_RHS_ALL };
+
+	static const int LUMEN = 0, ARTERIAL = 1, VENOUS = 2, ORGANS_OFFSET = 3;
+
+protected:
+	AUC_OUTPUT _aucOutput;
+	bool _permeabilitySensitivities;
+	SENSITIVITY_RHS _sensitivityRhs;
+
+	int _numberOfOrgans;
+	std::vector<double> _flows, _volumesPlasma, _volumesInterstitial, _volumesCell;
+	std::vector<double> _permeabilities, _basePermeabilities;
+
+	int plasmaIndex(int organ) { return ORGANS_OFFSET + 3 * organ; }
+	int interstitialIndex(int organ) { return ORGANS_OFFSET + 3 * organ + 1; }
+	int cellIndex(int organ) { return ORGANS_OFFSET + 3 * organ + 2; }
+	int aucIndex(int organ) { return ORGANS_OFFSET + 3 * _numberOfOrgans + organ; }
+
+	//calls setter(i, j, df_i/dy_j) for all structural nonzeros of the jacobian
+	template <typename Setter>
+	void jacobianEntries(const double * y, const double * p, Setter setter);
+
+	//permeabilities used for the parameters p passed by the solver
+	const double * permeabilities(const double * p) { return (p && _permeabilitySensitivities) ? p : &_permeabilities[0]; }
+
+	//adds df/dp_organ (permeability of the organ) to ySdot
+	void addPermeabilityDerivative(const double * y, int organ, double * ySdot);
+
+	//jacobian entries shared by all parameters in ODESensitivityRhsAllFunction
+	struct JacobianEntry
+	{
+		int Row, Column;
+		double Value;
+	};
+	std::vector<JacobianEntry> _jacobianEntries;
+
+	//CSC pattern of the jacobian
+	SparsityPattern _pattern;
+
+public:
+	TestSolverCaller_PBPK(int numberOfOrgans);
+
+	//individual parameter of the population benchmark: scales all permeabilities
+	void SetPermeabilityFactor(double factor);
+
+	//must be set before the solver is created
+	void SetAUCOutput(AUC_OUTPUT aucOutput) { _aucOutput = aucOutput; }
+
+	//permeabilities as sensitivity parameters (one per organ)
+	void SetPermeabilitySensitivities(bool permeabilitySensitivities) { _permeabilitySensitivities = permeabilitySensitivities; }
+	void SetSensitivityRhs(SENSITIVITY_RHS sensitivityRhs) { _sensitivityRhs = sensitivityRhs; }
+	std::vector<double> SensitivityParameterValues() { return _permeabilitySensitivities ? _permeabilities : std::vector<double>(); }
+
+	std::string Name() { return "PBPK"; }
+	int ProblemSize() { return ORGANS_OFFSET + 3 * _numberOfOrgans + (_aucOutput == AUC_STATES ? _numberOfOrgans : 0); }
+	std::vector<double> InitialValues();
+	double EndTime() { return 24.0 * 60.0; }
+
+	Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data);
+	Jacobian_Return_Value ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data);
+
+	bool GetJacobianSparsityPattern(SparsityPattern & pattern);
+	Jacobian_Return_Value ODESparseJacFunction(double t, const double * y, const double * p, const double * fy, double * jacobianValues, void * Jac_data);
+
+	int GetNumberOfQuadratures() { return _aucOutput == AUC_QUADRATURES ? _numberOfOrgans : 0; }
+	Rhs_Return_Value ODEQuadratureRhsFunction(double t, const double * y, const double * p, double * qdot, void * f_data);
+
+	bool IsSet_ObjectiveDerivativeFunction() { return _permeabilitySensitivities; }
+	Rhs_Return_Value ObjectiveDerivativeFunction(double t, const double * y, const double * p, double * dgdy, double * dgdp);
+
+	//thread safe (used for the benchmark of the solver option ParallelSensitivityRhs)
+	bool IsSet_ODESensitivityRhsFunction() { return _permeabilitySensitivities && (_sensitivityRhs == SENSITIVITY_RHS_SINGLE); }
+	Sensitivity_Rhs_Return_Value ODESensitivityRhsFunction(double t, const double * y, double * ydot, int iS, const double * yS, double * ySdot, void * f_data);
+
+	bool IsSet_ODESensitivityRhsAllFunction() { return _permeabilitySensitivities && (_sensitivityRhs == SENSITIVITY_RHS_ALL); }
+	Sensitivity_Rhs_Return_Value ODESensitivityRhsAllFunction(double t, const double * y, double * ydot, int Ns,
+		                                                      const double * const * yS, double * const * ySdot, void * f_data);
+};
+
+//1D reaction-diffusion chain with quadratic decay and closed boundaries:
+//
+//  y_i' = D*(y_{i-1} - 2*y_i + y_{i+1}) - k*y_i^2
+//
+//Tridiagonal jacobian (lower/upper half bandwidth 1) if the cells are numbered consecutively.
+//With shuffled numbering the jacobian is the same tridiagonal matrix, symmetrically permuted
+//(used to benchmark the state reordering).
+//The preconditioner solves the exact tridiagonal system (I-gamma*J)*z = r (consecutive numbering only)
+class TestSolverCaller_DiffusionChain : public BenchmarkSolverCallerBase
+{
+protected:
+	int _numberOfCells;
+	double _diffusionCoefficient;
+	double _decayRate;
+
+	//_stateIndex[i] is the state index of cell i
+	std::vector<int> _stateIndex;
+
+	//diagonal of J saved by the preconditioner setup; diagonal of I-gamma*J and Thomas algorithm workspace
+	std::vector<double> _jacobianDiagonal;
+	std::vector<double> _preconditionerDiagonal;
+	std::vector<double> _thomasWork;
+	double _preconditionerOffDiagonal;
+
+public:
+	TestSolverCaller_DiffusionChain(int numberOfCells, bool shuffledNumbering = false);
+
+	std::string Name() { return "DiffusionChain"; }
+	int ProblemSize() { return _numberOfCells; }
+	std::vector<double> InitialValues();
+	double EndTime() { return 100.0; }
+
+	Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data);
+	Jacobian_Return_Value ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data);
+
+	bool GetJacobianSparsityPattern(SparsityPattern & pattern);
+
+	Preconditioner_Return_Value PreconditionerSetupFunction(double t, const double * y, const double * p, const double * fy,
+		                                                    bool jacobianOk, bool & jacobianUpdated, double gamma, void * P_data);
+	Preconditioner_Return_Value PreconditionerSolveFunction(double t, const double * y, const double * p, const double * fy,
+		                                                    const double * r, double * z, double gamma, double delta,
+		                                                    bool leftPreconditioner, void * P_data);
+};
+
+#endif //_BenchmarkSolverCallers_H_
@@ -0,0 +1,96 @@
+#include "SimModelSolver_CVODESBenchmarks/AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> numberOfAllocations(0);
+
+long long AllocationCounter::NumberOfAllocations()
+{
+	return numberOfAllocations.load();
+}
+
+#if defined(__GLIBC__)
+
+//operator new of libstdc++ allocates via malloc
+extern "C"
+{
+	void * __libc_malloc(size_t size);
+	void * __libc_calloc(size_t count, size_t size);
+	void * __libc_realloc(void * ptr, size_t size);
+	void __libc_free(void * ptr);
+
+	void * malloc(size_t size)
+	{
+		numberOfAllocations++;
+		return __libc_malloc(size);
+	}
+
+	void * calloc(size_t count, size_t size)
+	{
+		numberOfAllocations++;
+		return __libc_calloc(count, size);
+	}
+
+	void * realloc(void * ptr, size_t size)
+	{
+		numberOfAllocations++;
+		return __libc_realloc(ptr, size);
+	}
+
+	void free(void * ptr)
+	{
+		__libc_free(ptr);
+	}
+}
+
+bool AllocationCounter::CountsCAllocations()
+{
+	return true;
+}
+
+#else
+
+void * operator new(size_t size)
+{
+	numberOfAllocations++;
+
+	void * ptr = malloc(size > 0 ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void * operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+bool AllocationCounter::CountsCAllocations()
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,567 @@
+#include "SimModelSolver_CVODESBenchmarks/BenchmarkSolverCallers.h"
+
+#include <algorithm>
+#include <math.h>
+
+//Jacobian layout used by all callers below: Jacobian is the column array of the
+//CVODE matrix, i.e. Jacobian[j] points to column j.
+//   - dense: Jacobian[j][i]             = df_i/dy_j
+//   - band:  Jacobian[j][i - j + smu]   = df_i/dy_j, smu = min(N-1, mu+ml) (storage upper bandwidth)
+//Sparse jacobians are returned in CSC format
+
+BenchmarkSolverCallerBase::BenchmarkSolverCallerBase()
+{
+	_useJacobian = true;
+	_bandLinearSolver = false;
+	_sparseLinearSolver = false;
+	_usePreconditioner = false;
+	_provideSparsityPattern = true;
+	_lowerHalfBandWidth = 0;
+	_upperHalfBandWidth = 0;
+
+	ResetCounters();
+}
+
+void BenchmarkSolverCallerBase::ResetCounters()
+{
+	NumberOfRhsEvaluations = 0;
+	NumberOfJacobianEvaluations = 0;
+}
+
+std::vector<double> BenchmarkSolverCallerBase::AbsoluteTolerances()
+{
+	return std::vector<double>(ProblemSize(), 1e-10);
+}
+
+std::vector<double> BenchmarkSolverCallerBase::OutputTimes()
+{
+	const int numberOfOutputTimes = 100;
+	std::vector<double> outputTimes(numberOfOutputTimes);
+
+	for (int i = 0; i < numberOfOutputTimes; i++)
+		outputTimes[i] = EndTime() * (i + 1) / numberOfOutputTimes;
+
+	return outputTimes;
+}
+
+void BenchmarkSolverCallerBase::SetBandLinearSolver(bool useBand, int lowerHalfBandWidth, int upperHalfBandWidth)
+{
+	_bandLinearSolver = useBand;
+	_lowerHalfBandWidth = lowerHalfBandWidth;
+	_upperHalfBandWidth = upperHalfBandWidth;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Roberts
+//-------------------------------------------------------------------------------------------------
+TestSolverCaller_cvsRoberts_FSA_dns::TestSolverCaller_cvsRoberts_FSA_dns()
+{
+	_useJacobian = true;
+}
+
+std::vector<double> TestSolverCaller_cvsRoberts_FSA_dns::InitialValues()
+{
+	std::vector<double> y0;
+
+	y0.push_back(1.0);
+	y0.push_back(0.0);
+	y0.push_back(0.0);
+
+	return y0;
+}
+
+std::vector<double> TestSolverCaller_cvsRoberts_FSA_dns::AbsoluteTolerances()
+{
+	std::vector<double> absTol;
+
+	absTol.push_back(1e-8);
+	absTol.push_back(1e-14);
+	absTol.push_back(1e-6);
+
+	return absTol;
+}
+
+std::vector<double> TestSolverCaller_cvsRoberts_FSA_dns::OutputTimes()
+{
+	//0.4, 4, 40, ..., 4e10 (as in the CVODES example)
+	std::vector<double> outputTimes;
+
+	for (int i = 0; i < 12; i++)
+		outputTimes.push_back(0.4 * pow(10.0, i));
+
+	return outputTimes;
+}
+
+std::vector<double> TestSolverCaller_cvsRoberts_FSA_dns::SensitivityParameterValues()
+{
+	std::vector<double> p0;
+
+	p0.push_back(0.04);
+	p0.push_back(1.0e4);
+	p0.push_back(3.0e7);
+
+	return p0;
+}
+
+Rhs_Return_Value TestSolverCaller_cvsRoberts_FSA_dns::ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+{
+	NumberOfRhsEvaluations++;
+
+	double p1 = 0.04, p2 = 1.0e4, p3 = 3.0e7;
+	if (p != NULL)
+	{
+		p1 = p[0]; p2 = p[1]; p3 = p[2];
+	}
+
+	double yd1 = ydot[0] = -p1 * y[0] + p2 * y[1] * y[2];
+	double yd3 = ydot[2] = p3 * y[1] * y[1];
+	ydot[1] = -yd1 - yd3;
+
+	return RHS_OK;
+}
+
+Jacobian_Return_Value TestSolverCaller_cvsRoberts_FSA_dns::ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data)
+{
+	NumberOfJacobianEvaluations++;
+
+	double p1 = 0.04, p2 = 1.0e4, p3 = 3.0e7;
+	if (p != NULL)
+	{
+		p1 = p[0]; p2 = p[1]; p3 = p[2];
+	}
+
+	//column y1
+	Jacobian[0][0] = -p1;
+	Jacobian[0][1] = p1;
+	Jacobian[0][2] = 0.0;
+
+	//column y2
+	Jacobian[1][0] = p2 * y[2];
+	Jacobian[1][1] = -p2 * y[2] - 2.0 * p3 * y[1];
+	Jacobian[1][2] = 2.0 * p3 * y[1];
+
+	//column y3
+	Jacobian[2][0] = p2 * y[1];
+	Jacobian[2][1] = -p2 * y[1];
+	Jacobian[2][2] = 0.0;
+
+	return JACOBIAN_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+// PBPK
+//-------------------------------------------------------------------------------------------------
+namespace
+{
+	const double ABSORPTION_RATE = 0.01;        //[1/min]
+	const double BLOOD_VOLUME = 2.5;            //arterial and venous pool volume [l]
+	const double FAST_EXCHANGE_FACTOR = 100.0;  //plasma <-> interstitial exchange relative to blood flow
+	const double PARTITION_COEFFICIENT = 5.0;   //cell/interstitial partition coefficient
+	const double VMAX = 0.5;                    //liver Michaelis-Menten elimination [umol/min]
+	const double KM = 1.0;                      //[umol/l]
+	const int LIVER = 1;
+}
+
+TestSolverCaller_PBPK::TestSolverCaller_PBPK(int numberOfOrgans)
+{
+	_numberOfOrgans = std::max(numberOfOrgans, 2);
+	_useJacobian = true;
+	_aucOutput = AUC_NONE;
+	_permeabilitySensitivities = false;
+	_sensitivityRhs = SENSITIVITY_RHS_NONE;
+
+	//deterministic, heterogeneous organ parameters
+	for (int i = 0; i < _numberOfOrgans; i++)
+	{
+		double scale = 1.0 + 0.5 * sin(1.0 + i);
+
+		_flows.push_back(5.0 / _numberOfOrgans * scale);  //total cardiac output ~5 l/min
+		_volumesPlasma.push_back(0.05 * scale);
+		_volumesInterstitial.push_back(0.2 * scale);
+		_volumesCell.push_back(1.0 * scale);
+		_permeabilities.push_back(0.01 * (1.0 + (i % 7)));
+	}
+
+	_basePermeabilities = _permeabilities;
+}
+
+void TestSolverCaller_PBPK::SetPermeabilityFactor(double factor)
+{
+	for (int i = 0; i < _numberOfOrgans; i++)
+		_permeabilities[i] = factor * _basePermeabilities[i];
+}
+
+std::vector<double> TestSolverCaller_PBPK::InitialValues()
+{
+	std::vector<double> y0(ProblemSize(), 0.0);
+
+	y0[LUMEN] = 100.0;  //oral dose (amount)
+	y0[VENOUS] = 10.0;  //iv bolus (concentration)
+
+	return y0;
+}
+
+Rhs_Return_Value TestSolverCaller_PBPK::ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+{
+	NumberOfRhsEvaluations++;
+
+	double totalFlow = 0.0, venousInflow = 0.0;
+	double cArterial = y[ARTERIAL];
+	const double * ps = permeabilities(p);
+
+	ydot[LUMEN] = -ABSORPTION_RATE * y[LUMEN];
+
+	for (int i = 0; i < _numberOfOrgans; i++)
+	{
+		double cPls = y[plasmaIndex(i)], cInt = y[interstitialIndex(i)], cCell = y[cellIndex(i)];
+		double fastExchange = FAST_EXCHANGE_FACTOR * _flows[i] * (cPls - cInt);
+		double cellUptake = ps[i] * (cInt - cCell / PARTITION_COEFFICIENT);
+
+		double plasmaInput = _flows[i] * (cArterial - cPls);
+		if (i == 0)
+			plasmaInput += ABSORPTION_RATE * y[LUMEN];
+
+		double cellOutput = cellUptake;
+		if (i == LIVER)
+			cellOutput -= VMAX * cCell / (KM + cCell);
+
+		ydot[plasmaIndex(i)] = (plasmaInput - fastExchange) / _volumesPlasma[i];
+		ydot[interstitialIndex(i)] = (fastExchange - cellUptake) / _volumesInterstitial[i];
+		ydot[cellIndex(i)] = cellOutput / _volumesCell[i];
+
+		totalFlow += _flows[i];
+		venousInflow += _flows[i] * cPls;
+
+		if (_aucOutput == AUC_STATES)
+			ydot[aucIndex(i)] = cPls;
+	}
+
+	ydot[VENOUS] = (venousInflow - totalFlow * y[VENOUS]) / BLOOD_VOLUME;
+	ydot[ARTERIAL] = totalFlow * (y[VENOUS] - cArterial) / BLOOD_VOLUME;
+
+	return RHS_OK;
+}
+
+template <typename Setter>
+void TestSolverCaller_PBPK::jacobianEntries(const double * y, const double * p, Setter setter)
+{
+	double totalFlow = 0.0;
+	const double * permeability = permeabilities(p);
+
+	setter(LUMEN, LUMEN, -ABSORPTION_RATE);
+
+	for (int i = 0; i < _numberOfOrgans; i++)
+	{
+		int pls = plasmaIndex(i), intst = interstitialIndex(i), cell = cellIndex(i);
+		double fast = FAST_EXCHANGE_FACTOR * _flows[i];
+		double ps = permeability[i];
+
+		//plasma equation
+		setter(pls, ARTERIAL, _flows[i] / _volumesPlasma[i]);
+		setter(pls, pls, (-_flows[i] - fast) / _volumesPlasma[i]);
+		setter(pls, intst, fast / _volumesPlasma[i]);
+		if (i == 0)
+			setter(pls, LUMEN, ABSORPTION_RATE / _volumesPlasma[i]);
+
+		//interstitial equation
+		setter(intst, pls, fast / _volumesInterstitial[i]);
+		setter(intst, intst, (-fast - ps) / _volumesInterstitial[i]);
+		setter(intst, cell, ps / PARTITION_COEFFICIENT / _volumesInterstitial[i]);
+
+		//intracellular equation
+		double dCell = -ps / PARTITION_COEFFICIENT / _volumesCell[i];
+		if (i == LIVER)
+			dCell -= VMAX * KM / ((KM + y[cell]) * (KM + y[cell])) / _volumesCell[i];
+
+		setter(cell, intst, ps / _volumesCell[i]);
+		setter(cell, cell, dCell);
+
+		//venous pool
+		setter(VENOUS, pls, _flows[i] / BLOOD_VOLUME);
+
+		if (_aucOutput == AUC_STATES)
+			setter(aucIndex(i), pls, 1.0);
+
+		totalFlow += _flows[i];
+	}
+
+	setter(VENOUS, VENOUS, -totalFlow / BLOOD_VOLUME);
+	setter(ARTERIAL, VENOUS, totalFlow / BLOOD_VOLUME);
+	setter(ARTERIAL, ARTERIAL, -totalFlow / BLOOD_VOLUME);
+}
+
+Jacobian_Return_Value TestSolverCaller_PBPK::ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data)
+{
+	NumberOfJacobianEvaluations++;
+
+	int n = ProblemSize();
+	for (int j = 0; j < n; j++)
+		std::fill(Jacobian[j], Jacobian[j] + n, 0.0);
+
+	jacobianEntries(y, p, [Jacobian](int i, int j, double value) { Jacobian[j][i] = value; });
+
+	return JACOBIAN_OK;
+}
+
+bool TestSolverCaller_PBPK::GetJacobianSparsityPattern(SparsityPattern & pattern)
+{
+	if (!_provideSparsityPattern)
+		return false;
+
+	if (_pattern.GetNumberOfNonZeros() == 0)
+	{
+		int n = ProblemSize();
+		std::vector<std::vector<int> > rows(n);
+		std::vector<double> y(n, 0.0);
+
+		jacobianEntries(&y[0], NULL, [&rows](int i, int j, double value) { rows[j].push_back(i); });
+
+		_pattern = SparsityPattern(n, SparsityPattern::CSC);
+		for (int j = 0; j < n; j++)
+		{
+			std::sort(rows[j].begin(), rows[j].end());
+			_pattern.IndexValues.insert(_pattern.IndexValues.end(), rows[j].begin(), rows[j].end());
+			_pattern.IndexPointers[j + 1] = (int)_pattern.IndexValues.size();
+		}
+	}
+
+	pattern = _pattern;
+	return true;
+}
+
+Jacobian_Return_Value TestSolverCaller_PBPK::ODESparseJacFunction(double t, const double * y, const double * p, const double * fy, double * jacobianValues, void * Jac_data)
+{
+	NumberOfJacobianEvaluations++;
+
+	const std::vector<int> & pointers = _pattern.IndexPointers;
+	const std::vector<int> & rows = _pattern.IndexValues;
+
+	jacobianEntries(y, p, [&](int i, int j, double value) {
+		int k = (int)(std::lower_bound(rows.begin() + pointers[j], rows.begin() + pointers[j + 1], i) - rows.begin());
+		jacobianValues[k] = value;
+	});
+
+	return JACOBIAN_OK;
+}
+
+Rhs_Return_Value TestSolverCaller_PBPK::ODEQuadratureRhsFunction(double t, const double * y, const double * p, double * qdot, void * f_data)
+{
+	for (int i = 0; i < _numberOfOrgans; i++)
+		qdot[i] = y[plasmaIndex(i)];
+
+	return RHS_OK;
+}
+
+Rhs_Return_Value TestSolverCaller_PBPK::ObjectiveDerivativeFunction(double t, const double * y, const double * p, double * dgdy, double * dgdp)
+{
+	std::fill(dgdy, dgdy + ProblemSize(), 0.0);
+	dgdy[VENOUS] = 1.0;
+
+	std::fill(dgdp, dgdp + _numberOfOrgans, 0.0);
+
+	return RHS_OK;
+}
+
+void TestSolverCaller_PBPK::addPermeabilityDerivative(const double * y, int organ, double * ySdot)
+{
+	int intst = interstitialIndex(organ), cell = cellIndex(organ);
+	double uptakeGradient = y[intst] - y[cell] / PARTITION_COEFFICIENT;
+
+	ySdot[intst] -= uptakeGradient / _volumesInterstitial[organ];
+	ySdot[cell] += uptakeGradient / _volumesCell[organ];
+}
+
+Sensitivity_Rhs_Return_Value TestSolverCaller_PBPK::ODESensitivityRhsFunction(double t, const double * y, double * ydot, int iS, const double * yS, double * ySdot, void * f_data)
+{
+	std::fill(ySdot, ySdot + ProblemSize(), 0.0);
+
+	//df/dy*yS: the jacobian entries are evaluated again for every parameter
+	jacobianEntries(y, NULL, [yS, ySdot](int i, int j, double value) { ySdot[i] += value * yS[j]; });
+
+	addPermeabilityDerivative(y, iS, ySdot);
+
+	return SENSITIVITY_RHS_OK;
+}
+
+Sensitivity_Rhs_Return_Value TestSolverCaller_PBPK::ODESensitivityRhsAllFunction(double t, const double * y, double * ydot, int Ns,
+	                                                                             const double * const * yS, double * const * ySdot, void * f_data)
+{
+	//jacobian entries once for all parameters
+	_jacobianEntries.clear();
+	jacobianEntries(y, NULL, [this](int i, int j, double value) { _jacobianEntries.push_back({ i, j, value }); });
+
+	for (int iS = 0; iS < Ns; iS++)
+	{
+		const double * ySj = yS[iS];
+		double * ySdotj = ySdot[iS];
+
+		std::fill(ySdotj, ySdotj + ProblemSize(), 0.0);
+		for (const JacobianEntry & entry : _jacobianEntries)
+			ySdotj[entry.Row] += entry.Value * ySj[entry.Column];
+
+		addPermeabilityDerivative(y, iS, ySdotj);
+	}
+
+	return SENSITIVITY_RHS_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Diffusion chain
+//-------------------------------------------------------------------------------------------------
+TestSolverCaller_DiffusionChain::TestSolverCaller_DiffusionChain(int numberOfCells, bool shuffledNumbering)
+{
+	_numberOfCells = std::max(numberOfCells, 2);
+	_diffusionCoefficient = 1.0e3;
+	_decayRate = 0.1;
+	_useJacobian = true;
+	_preconditionerOffDiagonal = 0.0;
+
+	_stateIndex.resize(_numberOfCells);
+	for (int i = 0; i < _numberOfCells; i++)
+		_stateIndex[i] = i;
+
+	//fixed pseudo random numbering (reproducible benchmark)
+	if (shuffledNumbering)
+	{
+		unsigned int seed = 12345;
+		for (int i = _numberOfCells - 1; i > 0; i--)
+		{
+			seed = seed * 1103515245 + 12345;
+			std::swap(_stateIndex[i], _stateIndex[(seed >> 8) % (i + 1)]);
+		}
+	}
+}
+
+std::vector<double> TestSolverCaller_DiffusionChain::InitialValues()
+{
+	std::vector<double> y0(_numberOfCells, 0.0);
+
+	//initial pulse in the first 10% of the chain
+	for (int i = 0; i < std::max(_numberOfCells / 10, 1); i++)
+		y0[_stateIndex[i]] = 1.0;
+
+	return y0;
+}
+
+Rhs_Return_Value TestSolverCaller_DiffusionChain::ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+{
+	NumberOfRhsEvaluations++;
+
+	int n = _numberOfCells;
+	const std::vector<int> & s = _stateIndex;
+	for (int i = 0; i < n; i++)
+	{
+		double left = (i > 0) ? y[s[i - 1]] - y[s[i]] : 0.0;
+		double right = (i < n - 1) ? y[s[i + 1]] - y[s[i]] : 0.0;
+
+		ydot[s[i]] = _diffusionCoefficient * (left + right) - _decayRate * y[s[i]] * y[s[i]];
+	}
+
+	return RHS_OK;
+}
+
+Jacobian_Return_Value TestSolverCaller_DiffusionChain::ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data)
+{
+	NumberOfJacobianEvaluations++;
+
+	int n = _numberOfCells;
+
+	//dense: element (i,j) is Jacobian[j][i]; band: Jacobian[j][i - j + smu]
+	int smu = _bandLinearSolver ? std::min(n - 1, _upperHalfBandWidth + _lowerHalfBandWidth) : 0;
+	auto element = [&](int i, int j) -> double & { return _bandLinearSolver ? Jacobian[j][i - j + smu] : Jacobian[j][i]; };
+
+	if (!_bandLinearSolver)
+	{
+		for (int j = 0; j < n; j++)
+			std::fill(Jacobian[j], Jacobian[j] + n, 0.0);
+	}
+
+	const std::vector<int> & s = _stateIndex;
+	for (int j = 0; j < n; j++)
+	{
+		int neighbours = ((j > 0) ? 1 : 0) + ((j < n - 1) ? 1 : 0);
+
+		element(s[j], s[j]) = -_diffusionCoefficient * neighbours - 2.0 * _decayRate * y[s[j]];
+		if (j > 0)
+			element(s[j - 1], s[j]) = _diffusionCoefficient;
+		if (j < n - 1)
+			element(s[j + 1], s[j]) = _diffusionCoefficient;
+	}
+
+	return JACOBIAN_OK;
+}
+
+bool TestSolverCaller_DiffusionChain::GetJacobianSparsityPattern(SparsityPattern & pattern)
+{
+	if (!_provideSparsityPattern)
+		return false;
+
+	int n = _numberOfCells;
+
+	//cell of each state
+	std::vector<int> cell(n);
+	for (int i = 0; i < n; i++)
+		cell[_stateIndex[i]] = i;
+
+	pattern = SparsityPattern(n, SparsityPattern::CSC);
+	for (int j = 0; j < n; j++)
+	{
+		for (int i = std::max(cell[j] - 1, 0); i <= std::min(cell[j] + 1, n - 1); i++)
+			pattern.IndexValues.push_back(_stateIndex[i]);
+		pattern.IndexPointers[j + 1] = (int)pattern.IndexValues.size();
+	}
+
+	return true;
+}
+
+Preconditioner_Return_Value TestSolverCaller_DiffusionChain::PreconditionerSetupFunction(double t, const double * y, const double * p, const double * fy,
+	bool jacobianOk, bool & jacobianUpdated, double gamma, void * P_data)
+{
+	int n = _numberOfCells;
+
+	if (!jacobianOk || _jacobianDiagonal.empty())
+	{
+		NumberOfJacobianEvaluations++;
+
+		_jacobianDiagonal.resize(n);
+		for (int i = 0; i < n; i++)
+		{
+			int neighbours = ((i > 0) ? 1 : 0) + ((i < n - 1) ? 1 : 0);
+			_jacobianDiagonal[i] = -_diffusionCoefficient * neighbours - 2.0 * _decayRate * y[i];
+		}
+
+		jacobianUpdated = true;
+	}
+
+	_preconditionerDiagonal.resize(n);
+	_thomasWork.resize(n);
+
+	for (int i = 0; i < n; i++)
+		_preconditionerDiagonal[i] = 1.0 - gamma * _jacobianDiagonal[i];
+	_preconditionerOffDiagonal = -gamma * _diffusionCoefficient;
+
+	return PRECONDITIONER_OK;
+}
+
+Preconditioner_Return_Value TestSolverCaller_DiffusionChain::PreconditionerSolveFunction(double t, const double * y, const double * p, const double * fy,
+	const double * r, double * z, double gamma, double delta, bool leftPreconditioner, void * P_data)
+{
+	int n = _numberOfCells;
+	const double * b = &_preconditionerDiagonal[0];
+	double c = _preconditionerOffDiagonal; //symmetric: sub- and superdiagonal are equal
+	double * w = &_thomasWork[0];
+
+	//Thomas algorithm (P is strictly diagonally dominant, no pivoting required)
+	w[0] = c / b[0];
+	z[0] = r[0] / b[0];
+	for (int i = 1; i < n; i++)
+	{
+		double m = b[i] - c * w[i - 1];
+		w[i] = c / m;
+		z[i] = (r[i] - c * z[i - 1]) / m;
+	}
+	for (int i = n - 2; i >= 0; i--)
+		z[i] -= w[i] * z[i + 1];
+
+	return PRECONDITIONER_OK;
+}
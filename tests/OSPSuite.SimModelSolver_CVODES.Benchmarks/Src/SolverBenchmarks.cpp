@@ -0,0 +1,1143 @@
+//Native benchmark driver for the CVODES solver wrapper.
+//
+//Solves a set of reference problems through the exported GetSolverInterface entry point
+//(exactly as SimModel does) and reports wall time, RHS/jacobian evaluation counts, error test
+//and nonlinear convergence failures and internal steps per second for each configuration.
+//
+//The ReInit benchmarks simulate repeated dosing (ReInit after each dose) and report the
+//heap allocations and the wall time per ReInit call. With sensitivities, they compare sensitivities
+//over the whole horizon with sensitivities switched on only after the last dose.
+//
+//The population benchmarks solve a virtual population with PopulationSolver for an increasing
+//number of worker threads and report the speedup compared to one thread.
+//
+//The gradient benchmarks compare forward sensitivities with the adjoint gradient for an
+//increasing number of sensitivity parameters.
+//
+//The sensitivity RHS benchmarks compare the sensitivity RHS by difference quotients (CVODES),
+//per parameter (serial and parallel) and for all parameters at once, and the sensitivity methods.
+//
+//The least squares benchmarks compare the reduction of the full sensitivity output outside the
+//solver with the objective/gradient calculated by the solver (forward and adjoint) and with the
+//additional Hessian-vector product (second order adjoint).
+//
+//The parameter update benchmarks simulate an optimization loop (objective and gradient for a
+//sequence of parameter sets) with Terminate/Init and with UpdateSensitivityParameters between the solves.
+//
+//The instrumentation benchmarks compare the wall time with and without the solver option Instrumentation
+//and print the timing report (RHS, jacobian, sensitivity RHS, linear solver, solver steps).
+//
+//Usage: OSPSuite.SimModelSolver_CVODES.Benchmarks [--repeat N] [--filter SUBSTRING] [--csv]
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolver_CVODES/PopulationSolver.h"
+#include "SimModelSolver_CVODES/SimModelSolver_CVODES.h"
+#include "SimModelSolver_CVODESBenchmarks/AllocationCounter.h"
+#include "SimModelSolver_CVODESBenchmarks/BenchmarkSolverCallers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" SimModelSolverBase * GetSolverInterface(ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters);
+
+struct BenchmarkConfiguration
+{
+	std::string Name;
+	std::function<BenchmarkSolverCallerBase * ()> CreateSolverCaller;
+	bool WithSensitivities;
+
+	//solver options passed via SetOption before Init
+	std::vector<std::pair<std::string, double> > SolverOptions;
+
+	//all output times in one PerformSolverSteps call
+	bool BatchOutput = false;
+
+	//observed state indices (empty: all states are copied)
+	std::vector<int> ObservedStates;
+};
+
+struct BenchmarkResult
+{
+	int ResultFlag;
+	double WallTimeMs;
+	long Steps;
+	long RhsEvaluations;
+	long JacobianEvaluations;
+	long ErrorTestFailures;
+	long NonlinearConvergenceFailures;
+};
+
+static BenchmarkResult RunBenchmark(BenchmarkSolverCallerBase & solverCaller, const BenchmarkConfiguration & configuration)
+{
+	bool withSensitivities = configuration.WithSensitivities;
+	BenchmarkResult result = { 0, 0.0, 0, 0, 0, 0, 0 };
+
+	int n = solverCaller.ProblemSize();
+	std::vector<double> p0 = withSensitivities ? solverCaller.SensitivityParameterValues() : std::vector<double>();
+	int ns = (int)p0.size();
+
+	std::vector<double> solution(n);
+	std::vector<double> sensitivityStorage(n * std::max(ns, 1));
+	std::vector<double *> sensitivityValues(n);
+	for (int i = 0; i < n; i++)
+		sensitivityValues[i] = &sensitivityStorage[i * std::max(ns, 1)];
+
+	std::vector<double> outputTimes = solverCaller.OutputTimes();
+
+	solverCaller.ResetCounters();
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::unique_ptr<SimModelSolverBase> solver(GetSolverInterface(&solverCaller, n, ns));
+
+	solver->SetAbsTol(solverCaller.AbsoluteTolerances());
+	solver->SetRelTol(solverCaller.RelativeTolerance());
+	solver->SetInitialTime(0.0);
+	solver->SetMxStep(1000000);
+	solver->SetInitialValues(solverCaller.InitialValues());
+
+	for (const std::pair<std::string, double> & option : configuration.SolverOptions)
+		solver->SetOption(option.first, option.second);
+
+	if (ns > 0)
+	{
+		solver->SetNumberOfSensitivityParameters(ns);
+		solver->SetSensitivityParametersInitialValues(p0);
+	}
+
+	if (!configuration.ObservedStates.empty())
+		dynamic_cast<SimModelSolver_CVODES *>(solver.get())->SetObservedStates(configuration.ObservedStates);
+
+	solver->Init();
+
+	if (configuration.BatchOutput)
+	{
+		SimModelSolver_CVODES * cvodesSolver = dynamic_cast<SimModelSolver_CVODES *>(solver.get());
+
+		std::vector<double> batchSolution(outputTimes.size() * n);
+		std::vector<double> batchSensitivities(ns > 0 ? outputTimes.size() * n * ns : 0);
+		int numberOfOutputTimesReached;
+
+		result.ResultFlag = cvodesSolver->PerformSolverSteps(&outputTimes[0], (int)outputTimes.size(), &batchSolution[0],
+			ns > 0 ? &batchSensitivities[0] : NULL, numberOfOutputTimesReached);
+	}
+
+	for (size_t i = 0; i < outputTimes.size() && result.ResultFlag == 0 && !configuration.BatchOutput; i++)
+	{
+		double tout = outputTimes[i];
+		double tret;
+
+		//single step mode: one call = one internal solver step
+		do
+		{
+			result.ResultFlag = solver->PerformSolverStep(tout, &solution[0], ns > 0 ? &sensitivityValues[0] : NULL, tret, SimModelSolverBase::SINGLE);
+		} while (result.ResultFlag == 0 && tret < tout);
+	}
+
+	solver->Terminate();
+
+	auto end = std::chrono::steady_clock::now();
+
+	//internal steps and failures of the whole run (available after Terminate)
+	SimModelSolver_CVODES::SolverStatistics statistics = dynamic_cast<SimModelSolver_CVODES *>(solver.get())->GetCumulativeSolverStatistics();
+	result.Steps = statistics.Steps;
+	result.ErrorTestFailures = statistics.ErrorTestFailures;
+	result.NonlinearConvergenceFailures = statistics.NonlinearConvergenceFailures;
+
+	result.WallTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+	result.RhsEvaluations = solverCaller.NumberOfRhsEvaluations;
+	result.JacobianEvaluations = solverCaller.NumberOfJacobianEvaluations;
+
+	return result;
+}
+
+static std::vector<BenchmarkConfiguration> CreateConfigurations()
+{
+	std::vector<BenchmarkConfiguration> configurations;
+
+	//---- Roberts
+	configurations.push_back({ "Roberts/dense/analytic", []() { return new TestSolverCaller_cvsRoberts_FSA_dns(); }, false });
+	configurations.push_back({ "Roberts/dense/DQ", []() {
+		BenchmarkSolverCallerBase * sc = new TestSolverCaller_cvsRoberts_FSA_dns();
+		sc->SetUseJacobian(false);
+		return sc; }, false });
+	configurations.push_back({ "Roberts/dense/analytic/FSA", []() { return new TestSolverCaller_cvsRoberts_FSA_dns(); }, true });
+	configurations.push_back({ "Roberts/dense/analytic/FSA/batch", []() { return new TestSolverCaller_cvsRoberts_FSA_dns(); }, true, {}, true });
+
+	//---- PBPK (arrow structured jacobian)
+	const int numberOfOrgans[] = { 15, 50, 200 };
+	for (int organs : numberOfOrgans)
+	{
+		std::string suffix = "/" + std::to_string(organs) + "_organs";
+
+		configurations.push_back({ "PBPK/dense/analytic" + suffix, [organs]() { return new TestSolverCaller_PBPK(organs); }, false });
+		configurations.push_back({ "PBPK/dense/analytic/batch" + suffix, [organs]() { return new TestSolverCaller_PBPK(organs); }, false, {}, true });
+		configurations.push_back({ "PBPK/dense/analytic/AUC_states" + suffix, [organs]() {
+			TestSolverCaller_PBPK * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetAUCOutput(TestSolverCaller_PBPK::AUC_STATES);
+			return sc; }, false });
+		configurations.push_back({ "PBPK/dense/analytic/AUC_quadratures" + suffix, [organs]() {
+			TestSolverCaller_PBPK * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetAUCOutput(TestSolverCaller_PBPK::AUC_QUADRATURES);
+			return sc; }, false });
+		configurations.push_back({ "PBPK/dense/analytic/observed" + suffix, [organs]() { return new TestSolverCaller_PBPK(organs); }, false, {}, false, { 0, 1, 2 } });
+		configurations.push_back({ "PBPK/dense/DQ" + suffix, [organs]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "ColoredFiniteDifferenceJacobian", 0 } } });
+		configurations.push_back({ "PBPK/dense/colored" + suffix, [organs]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetUseJacobian(false);
+			return sc; }, false });
+		configurations.push_back({ "PBPK/detected" + suffix, [organs]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetUseJacobian(false);
+			sc->SetProvideSparsityPattern(false);
+			return sc; }, false, { { "JacobianSparsityDetection", 1 } } });
+#ifdef CVODES_WITH_KLU
+		configurations.push_back({ "PBPK/sparse/analytic" + suffix, [organs]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetSparseLinearSolver(true);
+			return sc; }, false });
+		configurations.push_back({ "PBPK/sparse/colored" + suffix, [organs]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_PBPK(organs);
+			sc->SetSparseLinearSolver(true);
+			sc->SetUseJacobian(false);
+			return sc; }, false });
+#endif
+	}
+
+	//---- diffusion chain (tridiagonal jacobian)
+	const int numberOfCells[] = { 100, 1000 };
+	for (int cells : numberOfCells)
+	{
+		std::string suffix = "/" + std::to_string(cells) + "_cells";
+
+		configurations.push_back({ "DiffusionChain/band/analytic" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetBandLinearSolver(true, 1, 1);
+			return sc; }, false });
+		configurations.push_back({ "DiffusionChain/band/DQ" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetBandLinearSolver(true, 1, 1);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "ColoredFiniteDifferenceJacobian", 0 } } });
+		configurations.push_back({ "DiffusionChain/dense/DQ" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "ColoredFiniteDifferenceJacobian", 0 } } });
+
+		configurations.push_back({ "DiffusionChain/band/colored" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetBandLinearSolver(true, 1, 1);
+			sc->SetUseJacobian(false);
+			return sc; }, false });
+		configurations.push_back({ "DiffusionChain/dense/colored" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetUseJacobian(false);
+			return sc; }, false });
+		configurations.push_back({ "DiffusionChain/detected" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetUseJacobian(false);
+			sc->SetProvideSparsityPattern(false);
+			return sc; }, false, { { "JacobianSparsityDetection", 1 } } });
+
+		//shuffled cell numbering: dense unless the states are reordered
+		configurations.push_back({ "DiffusionChain/shuffled/dense/analytic" + suffix, [cells]() {
+			return new TestSolverCaller_DiffusionChain(cells, true); }, false });
+		configurations.push_back({ "DiffusionChain/shuffled/RCM/analytic" + suffix, [cells]() {
+			return new TestSolverCaller_DiffusionChain(cells, true); }, false, { { "StateReordering", 1 } } });
+		configurations.push_back({ "DiffusionChain/shuffled/RCM/colored" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells, true);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "StateReordering", 1 } } });
+
+		//matrix-free Newton-Krylov with difference quotient jacobian-vector products
+		configurations.push_back({ "DiffusionChain/SPGMR/noprec" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "LinearSolver", 1 }, { "Preconditioner", 0 } } });
+		configurations.push_back({ "DiffusionChain/SPGMR/bandpre" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetBandLinearSolver(false, 1, 1);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "LinearSolver", 1 } } });
+		configurations.push_back({ "DiffusionChain/SPGMR/callerprec" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetUseJacobian(false);
+			sc->SetUsePreconditioner(true);
+			return sc; }, false, { { "LinearSolver", 1 } } });
+		configurations.push_back({ "DiffusionChain/SPBCGS/bandpre" + suffix, [cells]() {
+			BenchmarkSolverCallerBase * sc = new TestSolverCaller_DiffusionChain(cells);
+			sc->SetBandLinearSolver(false, 1, 1);
+			sc->SetUseJacobian(false);
+			return sc; }, false, { { "LinearSolver", 2 } } });
+	}
+
+	return configurations;
+}
+
+//---- ReInit (multiple dosing) benchmarks
+struct ReInitBenchmarkResult
+{
+	int ResultFlag;
+	int NumberOfReInits;
+	long long Allocations;
+	double ReInitTimeMs;
+	long RhsEvaluations;
+};
+
+//integrates up to EndTime with numberOfDoses equidistant doses; each dose adds the initial values
+//to the current solution and restarts the integration with ReInit
+//(with useStopTimes the dose times are passed as stop times, so the solver does not integrate past them;
+// with sensitivitiesAfterLastDose the sensitivities are switched off until the last dose)
+static ReInitBenchmarkResult RunReInitBenchmark(BenchmarkSolverCallerBase & solverCaller, bool withSensitivities, bool useStopTimes,
+	                                            bool sensitivitiesAfterLastDose, int numberOfDoses)
+{
+	ReInitBenchmarkResult result = { 0, 0, 0, 0.0, 0 };
+
+	int n = solverCaller.ProblemSize();
+	std::vector<double> p0 = withSensitivities ? solverCaller.SensitivityParameterValues() : std::vector<double>();
+	int ns = (int)p0.size();
+
+	std::vector<double> solution(n);
+	std::vector<double> sensitivityStorage(n * std::max(ns, 1));
+	std::vector<double *> sensitivityValues(n);
+	for (int i = 0; i < n; i++)
+		sensitivityValues[i] = &sensitivityStorage[i * std::max(ns, 1)];
+
+	std::vector<double> dose = solverCaller.InitialValues();
+	double doseInterval = solverCaller.EndTime() / numberOfDoses;
+
+	solverCaller.ResetCounters();
+
+	std::unique_ptr<SimModelSolverBase> solver(GetSolverInterface(&solverCaller, n, ns));
+
+	solver->SetAbsTol(solverCaller.AbsoluteTolerances());
+	solver->SetRelTol(solverCaller.RelativeTolerance());
+	solver->SetInitialTime(0.0);
+	solver->SetMxStep(1000000);
+	solver->SetInitialValues(dose);
+
+	if (useStopTimes)
+	{
+		std::vector<double> doseTimes;
+		for (int d = 1; d < numberOfDoses; d++)
+			doseTimes.push_back(d * doseInterval);
+
+		dynamic_cast<SimModelSolver_CVODES *>(solver.get())->SetStopTimes(doseTimes);
+	}
+
+	if (ns > 0)
+	{
+		solver->SetNumberOfSensitivityParameters(ns);
+		solver->SetSensitivityParametersInitialValues(p0);
+	}
+
+	solver->Init();
+
+	SimModelSolver_CVODES * solverCVODES = dynamic_cast<SimModelSolver_CVODES *>(solver.get());
+	if (sensitivitiesAfterLastDose)
+		result.ResultFlag = solverCVODES->SetSensitivitiesActive(false);
+
+	for (int d = 1; d < numberOfDoses && result.ResultFlag == 0; d++)
+	{
+		double tDose = d * doseInterval;
+		double tret;
+
+		result.ResultFlag = solver->PerformSolverStep(tDose, &solution[0], ns > 0 ? &sensitivityValues[0] : NULL, tret, SimModelSolverBase::NORMAL);
+		if (result.ResultFlag == CV_TSTOP_RETURN)
+			result.ResultFlag = 0;
+		if (result.ResultFlag != 0)
+			break;
+
+		for (int i = 0; i < n; i++)
+			solution[i] += dose[i];
+
+		long long allocations = AllocationCounter::NumberOfAllocations();
+		auto start = std::chrono::steady_clock::now();
+
+		result.ResultFlag = solver->ReInit(tDose, solution);
+
+		result.ReInitTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		result.Allocations += AllocationCounter::NumberOfAllocations() - allocations;
+		result.NumberOfReInits++;
+	}
+
+	//sensitivities from 0 at the last dose
+	if (sensitivitiesAfterLastDose && (result.ResultFlag == 0))
+		result.ResultFlag = solverCVODES->SetSensitivitiesActive(true, true);
+
+	if (result.ResultFlag == 0)
+	{
+		double tret;
+		result.ResultFlag = solver->PerformSolverStep(solverCaller.EndTime(), &solution[0], ns > 0 ? &sensitivityValues[0] : NULL, tret, SimModelSolverBase::NORMAL);
+	}
+
+	solver->Terminate();
+
+	result.RhsEvaluations = solverCaller.NumberOfRhsEvaluations;
+
+	return result;
+}
+
+//returns false if any benchmark failed
+static bool RunReInitBenchmarks(const std::string & filter, bool csv)
+{
+	const int numberOfDoses = 200;
+
+	struct ReInitConfiguration
+	{
+		std::string Name;
+		std::function<BenchmarkSolverCallerBase * ()> CreateSolverCaller;
+		bool WithSensitivities;
+		bool UseStopTimes;
+		bool SensitivitiesAfterLastDose;
+	};
+
+	auto createPBPKWithSensitivities = []() { TestSolverCaller_PBPK * sc = new TestSolverCaller_PBPK(20); sc->SetPermeabilitySensitivities(true); return sc; };
+
+	std::vector<ReInitConfiguration> configurations;
+	configurations.push_back({ "ReInit/Roberts", []() { return new TestSolverCaller_cvsRoberts_FSA_dns(); }, false, false, false });
+	configurations.push_back({ "ReInit/Roberts/FSA", []() { return new TestSolverCaller_cvsRoberts_FSA_dns(); }, true, false, false });
+	configurations.push_back({ "ReInit/PBPK/20_organs", []() { return new TestSolverCaller_PBPK(20); }, false, false, false });
+	configurations.push_back({ "ReInit/PBPK/20_organs/stop_times", []() { return new TestSolverCaller_PBPK(20); }, false, true, false });
+	configurations.push_back({ "ReInit/PBPK/20_organs/FSA", createPBPKWithSensitivities, true, true, false });
+	configurations.push_back({ "ReInit/PBPK/20_organs/FSA/after_last_dose", createPBPKWithSensitivities, true, true, true });
+
+	if (csv)
+		printf("configuration,reinits,result,allocations_per_reinit,time_per_reinit_us,rhs_evals\n");
+	else
+		printf("\n%-45s %7s %6s %14s %14s %10s  (%s)\n", "configuration", "ReInits", "result", "allocs/ReInit", "us/ReInit", "rhs",
+			AllocationCounter::CountsCAllocations() ? "malloc + new" : "new only");
+
+	bool success = true;
+
+	for (ReInitConfiguration & configuration : configurations)
+	{
+		if (!filter.empty() && configuration.Name.find(filter) == std::string::npos)
+			continue;
+
+		std::unique_ptr<BenchmarkSolverCallerBase> solverCaller(configuration.CreateSolverCaller());
+		ReInitBenchmarkResult result = RunReInitBenchmark(*solverCaller, configuration.WithSensitivities, configuration.UseStopTimes,
+			                                               configuration.SensitivitiesAfterLastDose, numberOfDoses);
+
+		if (result.ResultFlag != 0)
+			success = false;
+
+		int reInits = std::max(result.NumberOfReInits, 1);
+		double allocationsPerReInit = (double)result.Allocations / reInits;
+		double microsecondsPerReInit = 1e3 * result.ReInitTimeMs / reInits;
+
+		if (csv)
+			printf("%s,%d,%d,%.2f,%.3f,%ld\n", configuration.Name.c_str(), result.NumberOfReInits, result.ResultFlag, allocationsPerReInit, microsecondsPerReInit,
+				result.RhsEvaluations);
+		else
+			printf("%-45s %7d %6d %14.2f %14.3f %10ld\n", configuration.Name.c_str(), result.NumberOfReInits, result.ResultFlag, allocationsPerReInit, microsecondsPerReInit,
+				result.RhsEvaluations);
+	}
+
+	return success;
+}
+
+//---- population benchmarks
+class PBPKPopulationModelFactory : public IPopulationModelFactory
+{
+protected:
+	int _numberOfOrgans;
+
+public:
+	PBPKPopulationModelFactory(int numberOfOrgans) { _numberOfOrgans = numberOfOrgans; }
+
+	ISolverCaller * CreateSolverCaller() { return new TestSolverCaller_PBPK(_numberOfOrgans); }
+
+	void SetParameterValues(ISolverCaller * solverCaller, const double * parameterValues, int numberOfParameters)
+	{
+		static_cast<TestSolverCaller_PBPK *>(solverCaller)->SetPermeabilityFactor(parameterValues[0]);
+	}
+};
+
+//returns false if any individual failed
+static bool RunPopulationBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	const int numberOfOrgans = 20, numberOfIndividuals = 1000;
+
+	std::string name = "Population/PBPK/" + std::to_string(numberOfIndividuals) + "_individuals";
+	if (!filter.empty() && name.find(filter) == std::string::npos)
+		return true;
+
+	PBPKPopulationModelFactory modelFactory(numberOfOrgans);
+	TestSolverCaller_PBPK referenceCaller(numberOfOrgans);
+
+	int n = referenceCaller.ProblemSize();
+
+	//individual permeability factors between 0.25 and 4 (deterministic)
+	std::vector<double> parameterValues(numberOfIndividuals);
+	for (int i = 0; i < numberOfIndividuals; i++)
+		parameterValues[i] = pow(4.0, sin(0.7 * i));
+
+	std::vector<double> initialValues;
+	std::vector<double> y0 = referenceCaller.InitialValues();
+	for (int i = 0; i < numberOfIndividuals; i++)
+		initialValues.insert(initialValues.end(), y0.begin(), y0.end());
+
+	std::vector<double> outputTimes = referenceCaller.OutputTimes();
+	outputTimes.insert(outputTimes.begin(), 0.0);
+
+	std::vector<double> results((size_t)numberOfIndividuals * outputTimes.size() * n);
+	std::vector<int> resultFlags(numberOfIndividuals);
+
+	int maxThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+	std::vector<int> numbersOfThreads;
+	for (int threads = 1; threads < maxThreads; threads *= 2)
+		numbersOfThreads.push_back(threads);
+	numbersOfThreads.push_back(maxThreads);
+
+	if (csv)
+		printf("configuration,threads,failures,wall_time_ms,individuals_per_s,speedup\n");
+	else
+		printf("\n%-45s %7s %8s %12s %14s %8s\n", "configuration", "threads", "failures", "best [ms]", "individuals/s", "speedup");
+
+	bool success = true;
+	double singleThreadTimeMs = 0.0;
+
+	for (int threads : numbersOfThreads)
+	{
+		PopulationSolver populationSolver(&modelFactory, n, threads);
+		populationSolver.SetRelTol(referenceCaller.RelativeTolerance());
+		populationSolver.SetAbsTol(1e-10);
+		populationSolver.SetMxStep(1000000);
+
+		double best = 0.0;
+		int failures = 0;
+
+		for (int r = 0; r < repeat; r++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			failures = populationSolver.Solve(numberOfIndividuals, &parameterValues[0], 1, &initialValues[0], outputTimes,
+				&results[0], &resultFlags[0]);
+
+			double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (r == 0 || wallTimeMs < best)
+				best = wallTimeMs;
+		}
+
+		if (threads == 1)
+			singleThreadTimeMs = best;
+		if (failures > 0)
+			success = false;
+
+		double individualsPerSecond = best > 0.0 ? numberOfIndividuals / (best * 1e-3) : 0.0;
+		double speedup = best > 0.0 ? singleThreadTimeMs / best : 0.0;
+
+		if (csv)
+			printf("%s,%d,%d,%.3f,%.0f,%.2f\n", name.c_str(), threads, failures, best, individualsPerSecond, speedup);
+		else
+			printf("%-45s %7d %8d %12.3f %14.0f %8.2f\n", name.c_str(), threads, failures, best, individualsPerSecond, speedup);
+	}
+
+	return success;
+}
+
+//---- gradient benchmarks
+//forward: solve with forward sensitivities (the gradient would still have to be reduced from yS)
+//adjoint: forward solve with checkpointing and one backward solve for the gradient
+//         (Hermite/polynomial interpolation, fixed checkpoint interval or 1 MB checkpoint memory budget)
+static bool RunGradientBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	struct GradientCase
+	{
+		const char * Name;
+		bool Adjoint;
+		int Interpolation;
+		double MemoryBudget;
+	};
+
+	const int numberOfOrgans[] = { 10, 40, 160 };
+	const GradientCase cases[] = {
+		{ "forward", false, 0, 0.0 },
+		{ "adjoint", true, 0, 0.0 },
+		{ "adjoint/polynomial", true, 1, 0.0 },
+		{ "adjoint/budget_1MB", true, 0, 1.0 }
+	};
+
+	if (csv)
+		printf("configuration,ns,result,wall_time_ms,checkpoints,checkpoint_steps,forward_rhs_evals,recomputed_rhs_evals\n");
+	else
+		printf("\n%-45s %4s %6s %12s %11s %10s %10s %10s\n", "configuration", "Ns", "result", "best [ms]", "checkpoints", "ckpt steps", "fwd RHS", "recomp RHS");
+
+	bool success = true;
+
+	for (int organs : numberOfOrgans)
+	{
+		for (const GradientCase & gradientCase : cases)
+		{
+			bool adjoint = gradientCase.Adjoint;
+			std::string name = std::string("Gradient/PBPK/") + gradientCase.Name + "/" + std::to_string(organs) + "_organs";
+			if (!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			TestSolverCaller_PBPK solverCaller(organs);
+			solverCaller.SetPermeabilitySensitivities(true);
+
+			int n = solverCaller.ProblemSize();
+			std::vector<double> p0 = solverCaller.SensitivityParameterValues();
+			int ns = (int)p0.size();
+
+			std::vector<double> solution(n), gradient(ns);
+			std::vector<double> sensitivityStorage((size_t)n * ns);
+			std::vector<double *> sensitivityValues(n);
+			for (int i = 0; i < n; i++)
+				sensitivityValues[i] = &sensitivityStorage[(size_t)i * ns];
+
+			double best = 0.0;
+			int resultFlag = 0;
+			SimModelSolver_CVODES::AdjointStatistics statistics = {};
+
+			for (int r = 0; r < repeat; r++)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				SimModelSolver_CVODES solver(&solverCaller, n, ns);
+
+				solver.SetAbsTol(solverCaller.AbsoluteTolerances());
+				solver.SetRelTol(solverCaller.RelativeTolerance());
+				solver.SetInitialTime(0.0);
+				solver.SetMxStep(1000000);
+				solver.SetInitialValues(solverCaller.InitialValues());
+				solver.SetNumberOfSensitivityParameters(ns);
+				solver.SetSensitivityParametersInitialValues(p0);
+				solver.SetOption("AdjointSensitivities", adjoint);
+				solver.SetOption("AdjointInterpolation", gradientCase.Interpolation);
+				solver.SetOption("AdjointMemoryBudget", gradientCase.MemoryBudget);
+
+				solver.Init();
+
+				double tret;
+				resultFlag = solver.PerformSolverStep(solverCaller.EndTime(), &solution[0], adjoint ? NULL : &sensitivityValues[0], tret, SimModelSolverBase::NORMAL);
+				if (resultFlag == 0 && adjoint)
+					resultFlag = solver.ComputeAdjointGradient(&gradient[0]);
+				if (adjoint)
+					statistics = solver.GetAdjointStatistics();
+
+				solver.Terminate();
+
+				double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (r == 0 || wallTimeMs < best)
+					best = wallTimeMs;
+			}
+
+			if (resultFlag != 0)
+				success = false;
+
+			if (csv)
+				printf("%s,%d,%d,%.3f,%d,%ld,%ld,%ld\n", name.c_str(), ns, resultFlag, best, (int)statistics.NumberOfCheckpoints,
+					statistics.CheckpointSteps, statistics.ForwardRhsEvaluations, statistics.RecomputationRhsEvaluations);
+			else
+				printf("%-45s %4d %6d %12.3f %11d %10ld %10ld %10ld\n", name.c_str(), ns, resultFlag, best, (int)statistics.NumberOfCheckpoints,
+					statistics.CheckpointSteps, statistics.ForwardRhsEvaluations, statistics.RecomputationRhsEvaluations);
+		}
+	}
+
+	return success;
+}
+
+//---- sensitivity RHS benchmarks
+//forward sensitivities of all organ permeabilities
+static bool RunSensitivityRhsBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	struct SensitivityRhsCase
+	{
+		const char * Name;
+		TestSolverCaller_PBPK::SENSITIVITY_RHS SensitivityRhs;
+		bool Parallel;
+		//solver option SensitivityMethod (0: automatic)
+		int SensitivityMethod;
+	};
+
+	const int numberOfOrgans[] = { 10, 40, 160 };
+	const SensitivityRhsCase cases[] = {
+		{ "difference_quotients", TestSolverCaller_PBPK::SENSITIVITY_RHS_NONE, false, 2 },
+		{ "per_parameter", TestSolverCaller_PBPK::SENSITIVITY_RHS_SINGLE, false, 2 },
+		{ "per_parameter_parallel", TestSolverCaller_PBPK::SENSITIVITY_RHS_SINGLE, true, 2 },
+		{ "all_parameters", TestSolverCaller_PBPK::SENSITIVITY_RHS_ALL, false, 2 },
+		{ "per_parameter/simultaneous", TestSolverCaller_PBPK::SENSITIVITY_RHS_SINGLE, false, 1 },
+		{ "per_parameter/staggered1", TestSolverCaller_PBPK::SENSITIVITY_RHS_SINGLE, false, 3 },
+		{ "per_parameter/automatic", TestSolverCaller_PBPK::SENSITIVITY_RHS_SINGLE, false, 0 }
+	};
+
+	if (csv)
+		printf("configuration,ns,result,wall_time_ms,rhs_evals\n");
+	else
+		printf("\n%-45s %4s %6s %12s %10s\n", "configuration", "Ns", "result", "best [ms]", "RHS evals");
+
+	bool success = true;
+
+	for (int organs : numberOfOrgans)
+	{
+		for (const SensitivityRhsCase & sensitivityRhsCase : cases)
+		{
+			std::string name = std::string("SensitivityRhs/PBPK/") + sensitivityRhsCase.Name + "/" + std::to_string(organs) + "_organs";
+			if (!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			TestSolverCaller_PBPK solverCaller(organs);
+			solverCaller.SetPermeabilitySensitivities(true);
+			solverCaller.SetSensitivityRhs(sensitivityRhsCase.SensitivityRhs);
+
+			int n = solverCaller.ProblemSize();
+			std::vector<double> p0 = solverCaller.SensitivityParameterValues();
+			int ns = (int)p0.size();
+
+			std::vector<double> solution(n);
+			double best = 0.0;
+			int resultFlag = 0;
+			long rhsEvaluations = 0;
+
+			for (int r = 0; r < repeat; r++)
+			{
+				solverCaller.ResetCounters();
+				auto start = std::chrono::steady_clock::now();
+
+				SimModelSolver_CVODES solver(&solverCaller, n, ns);
+
+				solver.SetAbsTol(solverCaller.AbsoluteTolerances());
+				solver.SetRelTol(solverCaller.RelativeTolerance());
+				solver.SetInitialTime(0.0);
+				solver.SetMxStep(1000000);
+				solver.SetInitialValues(solverCaller.InitialValues());
+				solver.SetNumberOfSensitivityParameters(ns);
+				solver.SetSensitivityParametersInitialValues(p0);
+				solver.SetOption("ParallelSensitivityRhs", sensitivityRhsCase.Parallel);
+				solver.SetOption("SensitivityMethod", sensitivityRhsCase.SensitivityMethod);
+
+				solver.Init();
+
+				double tret;
+				resultFlag = solver.PerformSolverStepContiguous(solverCaller.EndTime(), &solution[0], NULL, tret, SimModelSolverBase::NORMAL);
+
+				solver.Terminate();
+
+				double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (r == 0 || wallTimeMs < best)
+					best = wallTimeMs;
+				rhsEvaluations = solverCaller.NumberOfRhsEvaluations;
+			}
+
+			if (resultFlag != 0)
+				success = false;
+
+			if (csv)
+				printf("%s,%d,%d,%.3f,%ld\n", name.c_str(), ns, resultFlag, best, rhsEvaluations);
+			else
+				printf("%-45s %4d %6d %12.3f %10ld\n", name.c_str(), ns, resultFlag, best, rhsEvaluations);
+		}
+	}
+
+	return success;
+}
+
+//---- least squares benchmarks
+//venous concentration measured at 24 time points
+//output: all states and sensitivities at the measurement times, objective and gradient reduced here
+//forward/adjoint: ComputeLeastSquaresObjective
+//hessian_vector: ComputeLeastSquaresObjective with the Hessian-vector product in the direction (1,...,1)
+static bool RunLeastSquaresBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	const int numberOfOrgans[] = { 10, 40, 160 };
+	const char * modes[] = { "output", "forward", "adjoint", "hessian_vector" };
+	const int numberOfMeasurements = 24;
+
+	if (csv)
+		printf("configuration,ns,result,wall_time_ms,objective\n");
+	else
+		printf("\n%-45s %4s %6s %12s %14s\n", "configuration", "Ns", "result", "best [ms]", "objective");
+
+	bool success = true;
+
+	for (int organs : numberOfOrgans)
+	{
+		for (int mode = 0; mode < 4; mode++)
+		{
+			std::string name = std::string("LeastSquares/PBPK/") + modes[mode] + "/" + std::to_string(organs) + "_organs";
+			if (!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			TestSolverCaller_PBPK solverCaller(organs);
+			solverCaller.SetPermeabilitySensitivities(true);
+
+			int n = solverCaller.ProblemSize();
+			std::vector<double> p0 = solverCaller.SensitivityParameterValues();
+			int ns = (int)p0.size();
+
+			std::vector<double> measurementTimes(numberOfMeasurements), observedValues(numberOfMeasurements);
+			for (int k = 0; k < numberOfMeasurements; k++)
+			{
+				measurementTimes[k] = solverCaller.EndTime() * (k + 1) / numberOfMeasurements;
+				observedValues[k] = 10.0 * exp(-measurementTimes[k] / 60.0);
+			}
+			std::vector<int> stateIndices(1, (int)TestSolverCaller_PBPK::VENOUS);
+
+			std::vector<double> solution((size_t)numberOfMeasurements * n), gradient(ns), hessianVector(ns);
+			std::vector<double> sensitivities;
+			if (mode == 0)
+				sensitivities.resize((size_t)numberOfMeasurements * n * ns);
+
+			double best = 0.0, objective = 0.0;
+			int resultFlag = 0;
+
+			for (int r = 0; r < repeat; r++)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				SimModelSolver_CVODES solver(&solverCaller, n, ns);
+
+				solver.SetAbsTol(solverCaller.AbsoluteTolerances());
+				solver.SetRelTol(solverCaller.RelativeTolerance());
+				solver.SetInitialTime(0.0);
+				solver.SetMxStep(1000000);
+				solver.SetInitialValues(solverCaller.InitialValues());
+				solver.SetNumberOfSensitivityParameters(ns);
+				solver.SetSensitivityParametersInitialValues(p0);
+				solver.SetOption("AdjointSensitivities", mode >= 2);
+				if (mode == 3)
+					solver.SetHessianDirection(std::vector<double>(ns, 1.0));
+
+				solver.Init();
+
+				if (mode == 0)
+				{
+					int numberOfOutputTimesReached;
+					resultFlag = solver.PerformSolverSteps(&measurementTimes[0], numberOfMeasurements, &solution[0], &sensitivities[0], numberOfOutputTimesReached);
+
+					objective = 0.0;
+					std::fill(gradient.begin(), gradient.end(), 0.0);
+
+					for (int k = 0; k < numberOfMeasurements; k++)
+					{
+						int i = stateIndices[0];
+						double residual = solution[(size_t)k * n + i] - observedValues[k];
+						objective += residual * residual;
+
+						const double * ySki = &sensitivities[((size_t)k * n + i) * ns];
+						for (int j = 0; j < ns; j++)
+							gradient[j] += 2.0 * residual * ySki[j];
+					}
+				}
+				else
+					resultFlag = solver.ComputeLeastSquaresObjective(measurementTimes, stateIndices, &observedValues[0], NULL, objective, &gradient[0],
+						                                             mode == 3 ? &hessianVector[0] : NULL);
+
+				solver.Terminate();
+
+				double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (r == 0 || wallTimeMs < best)
+					best = wallTimeMs;
+			}
+
+			if (resultFlag != 0)
+				success = false;
+
+			if (csv)
+				printf("%s,%d,%d,%.3f,%.6g\n", name.c_str(), ns, resultFlag, best, objective);
+			else
+				printf("%-45s %4d %6d %12.3f %14.6g\n", name.c_str(), ns, resultFlag, best, objective);
+		}
+	}
+
+	return success;
+}
+
+static bool RunParameterUpdateBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	const int numberOfOrgans[] = { 10, 40 };
+	const char * modes[] = { "init", "update" };
+	const int numberOfIterations = 20;
+	const int numberOfMeasurements = 24;
+
+	if (csv)
+		printf("configuration,ns,result,wall_time_ms,ms_per_iteration\n");
+	else
+		printf("\n%-45s %4s %6s %12s %12s\n", "configuration", "Ns", "result", "best [ms]", "ms/iter");
+
+	bool success = true;
+
+	for (int organs : numberOfOrgans)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			std::string name = std::string("ParameterUpdate/PBPK/") + modes[mode] + "/" + std::to_string(organs) + "_organs";
+			if (!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			TestSolverCaller_PBPK solverCaller(organs);
+			solverCaller.SetPermeabilitySensitivities(true);
+
+			int n = solverCaller.ProblemSize();
+			std::vector<double> p0 = solverCaller.SensitivityParameterValues();
+			int ns = (int)p0.size();
+
+			std::vector<double> measurementTimes(numberOfMeasurements), observedValues(numberOfMeasurements);
+			for (int k = 0; k < numberOfMeasurements; k++)
+			{
+				measurementTimes[k] = solverCaller.EndTime() * (k + 1) / numberOfMeasurements;
+				observedValues[k] = 10.0 * exp(-measurementTimes[k] / 60.0);
+			}
+			std::vector<int> stateIndices(1, (int)TestSolverCaller_PBPK::VENOUS);
+			std::vector<double> gradient(ns), p(ns);
+
+			double best = 0.0;
+			int resultFlag = 0;
+
+			for (int r = 0; r < repeat; r++)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				SimModelSolver_CVODES solver(&solverCaller, n, ns);
+
+				solver.SetAbsTol(solverCaller.AbsoluteTolerances());
+				solver.SetRelTol(solverCaller.RelativeTolerance());
+				solver.SetInitialTime(0.0);
+				solver.SetMxStep(1000000);
+				solver.SetInitialValues(solverCaller.InitialValues());
+				solver.SetNumberOfSensitivityParameters(ns);
+
+				//optimization loop: one objective/gradient evaluation per parameter set
+				for (int iteration = 0; (iteration < numberOfIterations) && (resultFlag == 0); iteration++)
+				{
+					for (int j = 0; j < ns; j++)
+						p[j] = p0[j] * (1.0 + 0.01 * iteration);
+
+					if ((mode == 1) && (iteration > 0))
+						resultFlag = solver.UpdateSensitivityParameters(p);
+					else
+					{
+						if (iteration > 0)
+							solver.Terminate();
+						solver.SetSensitivityParametersInitialValues(p);
+						solver.Init();
+					}
+
+					double objective;
+					if (resultFlag == 0)
+						resultFlag = solver.ComputeLeastSquaresObjective(measurementTimes, stateIndices, &observedValues[0], NULL, objective, &gradient[0]);
+				}
+
+				solver.Terminate();
+
+				double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (r == 0 || wallTimeMs < best)
+					best = wallTimeMs;
+			}
+
+			if (resultFlag != 0)
+				success = false;
+
+			if (csv)
+				printf("%s,%d,%d,%.3f,%.3f\n", name.c_str(), ns, resultFlag, best, best / numberOfIterations);
+			else
+				printf("%-45s %4d %6d %12.3f %12.3f\n", name.c_str(), ns, resultFlag, best, best / numberOfIterations);
+		}
+	}
+
+	return success;
+}
+
+static bool RunInstrumentationBenchmarks(int repeat, const std::string & filter, bool csv)
+{
+	const int numberOfOrgans[] = { 10, 160 };
+	const char * modes[] = { "off", "on" };
+
+	if (csv)
+		printf("configuration,result,wall_time_ms,overhead_percent\n");
+	else
+		printf("\n%-45s %6s %12s %10s\n", "configuration", "result", "best [ms]", "overhead");
+
+	bool success = true;
+
+	for (int organs : numberOfOrgans)
+	{
+		double bestOff = 0.0;
+
+		for (int mode = 0; mode < 2; mode++)
+		{
+			std::string name = std::string("Instrumentation/PBPK/") + modes[mode] + "/" + std::to_string(organs) + "_organs";
+			if (!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			TestSolverCaller_PBPK solverCaller(organs);
+			solverCaller.SetPermeabilitySensitivities(true);
+
+			int n = solverCaller.ProblemSize();
+			std::vector<double> p0 = solverCaller.SensitivityParameterValues();
+			int ns = (int)p0.size();
+			std::vector<double> outputTimes = solverCaller.OutputTimes();
+			std::vector<double> solution(n), sensitivities((size_t)n * ns);
+
+			double best = 0.0;
+			int resultFlag = 0;
+			std::string report;
+
+			for (int r = 0; r < repeat; r++)
+			{
+				auto start = std::chrono::steady_clock::now();
+
+				SimModelSolver_CVODES solver(&solverCaller, n, ns);
+
+				solver.SetAbsTol(solverCaller.AbsoluteTolerances());
+				solver.SetRelTol(solverCaller.RelativeTolerance());
+				solver.SetInitialTime(0.0);
+				solver.SetMxStep(1000000);
+				solver.SetInitialValues(solverCaller.InitialValues());
+				solver.SetNumberOfSensitivityParameters(ns);
+				solver.SetSensitivityParametersInitialValues(p0);
+				solver.SetOption("Instrumentation", mode);
+
+				solver.Init();
+
+				for (size_t k = 1; (k < outputTimes.size()) && (resultFlag == 0); k++)
+				{
+					double tret;
+					resultFlag = solver.PerformSolverStepContiguous(outputTimes[k], &solution[0], &sensitivities[0], tret, SimModelSolverBase::NORMAL);
+				}
+
+				if (solver.GetInstrumentation())
+					report = solver.GetInstrumentation()->GetReport(true);
+
+				solver.Terminate();
+
+				double wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (r == 0 || wallTimeMs < best)
+					best = wallTimeMs;
+			}
+
+			if (resultFlag != 0)
+				success = false;
+
+			if (mode == 0)
+				bestOff = best;
+			double overhead = ((mode == 1) && (bestOff > 0.0)) ? 100.0 * (best - bestOff) / bestOff : 0.0;
+
+			if (csv)
+				printf("%s,%d,%.3f,%.1f\n", name.c_str(), resultFlag, best, overhead);
+			else
+			{
+				printf("%-45s %6d %12.3f %9.1f%%\n", name.c_str(), resultFlag, best, overhead);
+
+				//timings of the last repetition
+				if (!report.empty())
+					printf("%s", report.c_str());
+			}
+		}
+	}
+
+	return success;
+}
+
+int main(int argc, char * argv[])
+{
+	int repeat = 3;
+	std::string filter;
+	bool csv = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+			repeat = std::max(atoi(argv[++i]), 1);
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (strcmp(argv[i], "--csv") == 0)
+			csv = true;
+		else
+		{
+			fprintf(stderr, "Usage: %s [--repeat N] [--filter SUBSTRING] [--csv]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (csv)
+		printf("configuration,n,ns,result,wall_time_ms,steps,rhs_evals,jac_evals,err_test_fails,conv_fails,steps_per_s\n");
+	else
+		printf("%-45s %6s %3s %6s %12s %9s %10s %9s %9s %10s %12s\n", "configuration", "N", "Ns", "result", "best [ms]", "steps", "RHS evals", "Jac evals",
+			"ETF", "conv fails", "steps/s");
+
+	int exitCode = 0;
+
+	for (BenchmarkConfiguration & configuration : CreateConfigurations())
+	{
+		if (!filter.empty() && configuration.Name.find(filter) == std::string::npos)
+			continue;
+
+		std::unique_ptr<BenchmarkSolverCallerBase> solverCaller(configuration.CreateSolverCaller());
+		int ns = configuration.WithSensitivities ? (int)solverCaller->SensitivityParameterValues().size() : 0;
+
+		BenchmarkResult best = { 0, 0.0, 0, 0, 0, 0, 0 };
+		try
+		{
+			//report the fastest of all repetitions (counters are identical for all runs)
+			for (int r = 0; r < repeat; r++)
+			{
+				BenchmarkResult result = RunBenchmark(*solverCaller, configuration);
+				if (r == 0 || result.WallTimeMs < best.WallTimeMs)
+					best = result;
+			}
+		}
+		catch (SimModelSolverErrorData & ED)
+		{
+			fprintf(stderr, "%s: %s\n", configuration.Name.c_str(), ED.GetDescription().c_str());
+			exitCode = 1;
+			continue;
+		}
+
+		if (best.ResultFlag != 0)
+			exitCode = 1;
+
+		double stepsPerSecond = best.WallTimeMs > 0.0 ? best.Steps / (best.WallTimeMs * 1e-3) : 0.0;
+
+		if (csv)
+			printf("%s,%d,%d,%d,%.3f,%ld,%ld,%ld,%ld,%ld,%.0f\n", configuration.Name.c_str(), solverCaller->ProblemSize(), ns,
+				best.ResultFlag, best.WallTimeMs, best.Steps, best.RhsEvaluations, best.JacobianEvaluations,
+				best.ErrorTestFailures, best.NonlinearConvergenceFailures, stepsPerSecond);
+		else
+			printf("%-45s %6d %3d %6d %12.3f %9ld %10ld %9ld %9ld %10ld %12.0f\n", configuration.Name.c_str(), solverCaller->ProblemSize(), ns,
+				best.ResultFlag, best.WallTimeMs, best.Steps, best.RhsEvaluations, best.JacobianEvaluations,
+				best.ErrorTestFailures, best.NonlinearConvergenceFailures, stepsPerSecond);
+	}
+
+	try
+	{
+		if (!RunReInitBenchmarks(filter, csv))
+			exitCode = 1;
+		if (!RunPopulationBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+		if (!RunGradientBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+		if (!RunSensitivityRhsBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+		if (!RunLeastSquaresBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+		if (!RunParameterUpdateBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+		if (!RunInstrumentationBenchmarks(repeat, filter, csv))
+			exitCode = 1;
+	}
+	catch (SimModelSolverErrorData & ED)
+	{
+		fprintf(stderr, "%s\n", ED.GetDescription().c_str());
+		exitCode = 1;
+	}
+
+	return exitCode;
+}
@@ -1,5 +1,9 @@
 #include "SimModelSolverBase/SimModelSolverBase.h"
 #include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolver_CVODES/ISolverCaller_CVODES.h"
+#include "SimModelSolver_CVODES/JacobianSparsityDetector.h"
+#include "SimModelSolver_CVODES/PopulationSolver.h"
+#include "SimModelSolver_CVODES/SimModelSolver_CVODES.h"
 #include "SimModelSolver_CVODESSpecs/ExceptionHelper.h"
 
 #include <vector>
@@ -18,7 +22,7 @@ namespace UnitTests
 	using namespace NUnit::Framework;
 
 
-	class TestSolverCallerBase : public ISolverCaller
+	class TestSolverCallerBase : public ISolverCaller_CVODES
 	{
 	protected:
 		bool UseJacobian;
@@ -91,6 +95,29 @@ namespace UnitTests
 		}
 	};
 
+	class TestSolverCallerWithoutJacobian :public TestSolverCaller
+	{
+	public:
+		TestSolverCallerWithoutJacobian()
+		{
+			UseJacobian = false;
+		}
+	};
+
+	//example system with the root function g = y0 - 3
+	class TestSolverCallerWithRootFunction :public TestSolverCaller
+	{
+	public:
+		int GetNumberOfRootFunctions() { return 1; }
+
+		Root_Return_Value ODERootFunction(double t, const double * y, const double * p, double * g, void * Root_data)
+		{
+			g[0] = y[0] - 3.0;
+
+			return ROOT_OK;
+		}
+	};
+
 	class TestSolverCallerNonrecoverableError : public TestSolverCallerBase
 	{
 	public:
@@ -259,6 +286,220 @@ namespace UnitTests
 	};
 
 
+	// Testsystem with 2 variables and 2 sensitivity parameters:
+	//
+	//  y0' = P1*y1
+	//  y1' = P2*y0
+	//
+	// y0(0) = 2  y1(0) = 0  P1 = P2 = 1
+	//
+	// Analytical solution is y0 = 2*cosh(w*t) with w = sqrt(P1*P2), so
+	// dy0/dP1 = t*sinh(w*t)*P2/w and dy0/dP2 = t*sinh(w*t)*P1/w
+	class TestSolverCallerWithParameters : public TestSolverCallerBase
+	{
+	public:
+		Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+		{
+			double p1 = p ? p[0] : 1.0, p2 = p ? p[1] : 1.0;
+
+			ydot[0] = p1*y[1];
+			ydot[1] = p2*y[0];
+
+			return RHS_OK;
+		}
+
+		//Jacobian[j][i] = df_i/dy_j
+		Jacobian_Return_Value ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data)
+		{
+			double p1 = p ? p[0] : 1.0, p2 = p ? p[1] : 1.0;
+
+			Jacobian[0][0] = 0;
+			Jacobian[0][1] = p2;
+			Jacobian[1][0] = p1;
+			Jacobian[1][1] = 0;
+
+			return JACOBIAN_OK;
+		}
+	};
+
+	// TestSolverCallerWithParameters with the quadrature (AUC of y0)
+	//
+	//  q' = y0,  q(0) = 0
+	//
+	// Analytical solution is q = 2*sinh(w*t)/w
+	class TestSolverCallerWithParametersAndQuadrature : public TestSolverCallerWithParameters
+	{
+	public:
+		int GetNumberOfQuadratures() { return 1; }
+
+		Rhs_Return_Value ODEQuadratureRhsFunction(double t, const double * y, const double * p, double * qdot, void * f_data)
+		{
+			qdot[0] = y[0];
+
+			return RHS_OK;
+		}
+	};
+
+	// Testsystem with N variables (diffusion chain, tridiagonal jacobian):
+	//
+	//  yi' = y(i-1) - 2*yi + y(i+1)   (y(-1) = y(N) = 0)
+	class TestSolverCallerDiffusionChain : public TestSolverCallerBase
+	{
+	public:
+		static const int N = 20;
+
+		TestSolverCallerDiffusionChain()
+		{
+			UseJacobian = false;
+		}
+
+		Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+		{
+			for (int i = 0; i < N; i++)
+				ydot[i] = (i > 0 ? y[i - 1] : 0.0) - 2.0*y[i] + (i < N - 1 ? y[i + 1] : 0.0);
+
+			return RHS_OK;
+		}
+	};
+
+	// Testsystem with N variables and 2 sensitivity parameters (diffusion chain with decay, shuffled numbering):
+	//
+	//  y(s(k))' = P1*(y(s(k-1)) - 2*y(s(k)) + y(s(k+1))) - P2*y(s(k))   (y(s(-1)) = y(s(N)) = 0)
+	//
+	// with the chain position k stored in the state s(k) = 7*k mod N, so the jacobian is not banded
+	// in the caller numbering, but becomes tridiagonal again after the Reverse Cuthill-McKee ordering
+	class TestSolverCallerShuffledDiffusionChain : public TestSolverCallerBase
+	{
+	public:
+		static const int N = 20;
+
+		TestSolverCallerShuffledDiffusionChain()
+		{
+			UseJacobian = false;
+		}
+
+		static int StateIndex(int k)
+		{
+			return (7 * k) % N;
+		}
+
+		Rhs_Return_Value ODERhsFunction(double t, const double * y, const double * p, double * ydot, void * f_data)
+		{
+			double p1 = p ? p[0] : 1.0, p2 = p ? p[1] : 0.1;
+
+			for (int k = 0; k < N; k++)
+			{
+				double left = (k > 0 ? y[StateIndex(k - 1)] : 0.0), right = (k < N - 1 ? y[StateIndex(k + 1)] : 0.0);
+				ydot[StateIndex(k)] = p1*(left - 2.0*y[StateIndex(k)] + right) - p2*y[StateIndex(k)];
+			}
+
+			return RHS_OK;
+		}
+	};
+
+	// Nonlinear test systems with N variables for the colored difference quotient jacobian:
+	//
+	//  banded (tridiagonal):  fi = y(i-1) - 2*yi^2 + y(i+1)              (y(-1) = y(N) = 0)
+	//  arrow:                 f0 = sum_j yj^2,  fi = y0*yi - yi  (i > 0)
+	class ColoredJacobianTestSystem
+	{
+	public:
+		static const int N = 10;
+
+		bool Arrow;
+
+		ColoredJacobianTestSystem(bool arrow)
+		{
+			Arrow = arrow;
+		}
+
+		Rhs_Return_Value Rhs(const double * y, double * ydot) const
+		{
+			if (Arrow)
+			{
+				ydot[0] = 0.0;
+				for (int j = 0; j < N; j++)
+					ydot[0] += y[j] * y[j];
+				for (int i = 1; i < N; i++)
+					ydot[i] = y[0] * y[i] - y[i];
+			}
+			else
+			{
+				for (int i = 0; i < N; i++)
+					ydot[i] = (i > 0 ? y[i - 1] : 0.0) - 2.0*y[i] * y[i] + (i < N - 1 ? y[i + 1] : 0.0);
+			}
+
+			return RHS_OK;
+		}
+
+		//analytic df_i/dy_j
+		double Jacobian(const double * y, int i, int j) const
+		{
+			if (Arrow)
+			{
+				if (i == 0)
+					return 2.0*y[j];
+				if (j == 0)
+					return y[i];
+				return (i == j) ? y[0] - 1.0 : 0.0;
+			}
+
+			if (i == j)
+				return -4.0*y[i];
+			return ((i == j - 1) || (i == j + 1)) ? 1.0 : 0.0;
+		}
+
+		//CSC pattern; rows within a column in descending order
+		SparsityPattern Pattern() const
+		{
+			SparsityPattern pattern(N, SparsityPattern::CSC);
+
+			for (int j = 0; j < N; j++)
+			{
+				for (int i = N - 1; i >= 0; i--)
+				{
+					bool nonZero = Arrow ? ((i == 0) || (j == 0) || (i == j)) : ((i >= j - 1) && (i <= j + 1));
+					if (nonZero)
+						pattern.IndexValues.push_back(i);
+				}
+				pattern.IndexPointers[j + 1] = pattern.GetNumberOfNonZeros();
+			}
+
+			return pattern;
+		}
+
+		//colored difference quotients and analytic values of all nonzeros of the pattern at yi = 2 + i/N
+		int EvaluateColoredJacobian(int & numberOfColors, std::vector<double> & coloredValues, std::vector<double> & analyticValues) const
+		{
+			SparsityPattern pattern = Pattern();
+
+			ColoredFiniteDifferenceJacobian coloredJacobian;
+			coloredJacobian.Init(pattern);
+			numberOfColors = coloredJacobian.GetNumberOfColors();
+
+			std::vector<double> y(N), fy(N), increments(N), yWork(N), fWork(N);
+			for (int i = 0; i < N; i++)
+			{
+				y[i] = 2.0 + (double)i / N;
+				increments[i] = 1e-7*y[i];
+			}
+			Rhs(&y[0], &fy[0]);
+
+			coloredValues.assign(pattern.GetNumberOfNonZeros(), 0.0);
+			analyticValues.assign(pattern.GetNumberOfNonZeros(), 0.0);
+
+			const ColoredJacobianTestSystem * system = this;
+			Rhs_Return_Value RetVal = coloredJacobian.Evaluate([system](const double * yPerturbed, double * ydot) { return system->Rhs(yPerturbed, ydot); },
+				                                               &y[0], &fy[0], &increments[0], &yWork[0], &fWork[0], &coloredValues[0]);
+
+			for (int j = 0; j < N; j++)
+				for (int k = pattern.IndexPointers[j]; k < pattern.IndexPointers[j + 1]; k++)
+					analyticValues[k] = Jacobian(&y[0], pattern.IndexValues[k], j);
+
+			return (int)RetVal;
+		}
+	};
+
 	public ref class concern_for_simmodel_solver_cvodes abstract : ContextSpecification<double>
 	{
 	protected:
@@ -357,6 +598,8 @@ namespace UnitTests
 					pCVODES->SetSensitivityParametersInitialValues(InitialSensitivityParameterValues());
 				}
 
+				SetSolverOptions(pCVODES);
+
 				pCVODES->Init();
 
 				Solution = new double[NumberOfUnknowns()];
@@ -437,6 +680,9 @@ namespace UnitTests
 
 		virtual array<double, 3>^ FillExpectedSensitivities() = 0;
 		virtual std::vector<double> InitialSensitivityParameterValues() = 0;
+
+		//additional solver options (set before Init)
+		virtual void SetSolverOptions(SimModelSolverBase * pCVODES) {}
 	};
 
 	public ref class when_solving_simpleSystem_with_sensitivity_Jacobian_not_set_Sensitivity_RHS_function_not_set : public concern_for_simmodel_solver_cvodes_with_sensitivity
@@ -579,6 +825,18 @@ namespace UnitTests
 
 	};
 
+	public ref class when_solving_simpleSystem_with_sensitivity_and_automatic_sensitivity_method : public when_solving_simpleSystem_with_sensitivity_Jacobian_not_set_Sensitivity_RHS_function_not_set
+	{
+	protected:
+
+		//sensitivity method selected by trial integrations, sensitivities included in the error test
+		virtual void SetSolverOptions(SimModelSolverBase * pCVODES) override
+		{
+			pCVODES->SetOption("SensitivityMethod", 0);
+			pCVODES->SetOption("SensitivityErrorControl", 1);
+		}
+	};
+
 	public ref class when_solving_cvsRoberts_FSA_dns_with_sensitivity_Sensitivity_RHS_function_not_set : public concern_for_simmodel_solver_cvodes_with_sensitivity
 	{
 	protected:
@@ -749,6 +1007,8 @@ namespace UnitTests
 
 				pCVODES->SetInitialValues(y0);
 
+				SetSolverOptions(pCVODES);
+
 				pCVODES->Init();
 
 				double Solution[2];
@@ -788,6 +1048,11 @@ namespace UnitTests
 			ReleaseSolver();
 		}
 
+		//additional solver options (called before Init)
+		virtual void SetSolverOptions(SimModelSolverBase * pCVODES)
+		{
+		}
+
 		virtual int NumberOfUnknowns() override
 		{
 			return 2;
@@ -984,5 +1249,1929 @@ namespace UnitTests
 
 	};
 
+	public ref class when_solving_example_system_with_krylov_linear_solver : public concern_for_simmodel_solver_cvodes_without_sensitivity
+	{
+	protected:
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCaller();
+		}
+
+		virtual void SetSolverOptions(SimModelSolverBase * pCVODES) override
+		{
+			pCVODES->SetOption("LinearSolver", 1); //SPGMR
+		}
+
+		//solve given system for y0=2; y1=0
+		//analytical solution is:
+		// y0 = exp(t)+exp(-t)
+		// y1 = exp(t)-exp(-t)
+		virtual void Because() override
+		{
+			concern_for_simmodel_solver_cvodes_without_sensitivity::Because();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_solve_example_system_and_return_correct_solution()
+		{
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			for (int i = 1; i <= _numberOfTimesteps; i++)
+			{
+				double time = _time[i - 1], y0 = _y0[i - 1], y1 = _y1[i - 1];
+
+				//solver output time should be i*dt
+				BDDExtensions::ShouldBeEqualTo(time, _dt*i);
+
+				//compare y0 with analytical solution within tolerance
+				BDDExtensions::ShouldBeEqualTo(y0, exp(time) + exp(-time), relTol);
+
+				//compare y1 with analytical solution within tolerance
+				BDDExtensions::ShouldBeEqualTo(y1, exp(time) - exp(-time), relTol);
+			}
+		}
+
+	};
+
+	public ref class when_detecting_the_jacobian_sparsity_pattern_of_a_diffusion_chain : public concern_for_simmodel_solver_cvodes
+	{
+	protected:
+		static const int N = TestSolverCallerDiffusionChain::N;
+
+		bool _detected;
+		int _format;
+		int _numberOfNonZeros;
+		array<int>^ _indexPointers;
+		array<int>^ _indexValues;
+		int _matrixType;
+		int _CVODE_Result;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerDiffusionChain();
+		}
+
+		virtual int NumberOfUnknowns() override
+		{
+			return N;
+		}
+
+		virtual int NumberOfSensitivityParameters() override
+		{
+			return 0;
+		}
+
+		//detects the pattern directly and initializes a solver with the option JacobianSparsityDetection
+		virtual void Because() override
+		{
+			try
+			{
+				std::vector<double> y0;
+				for (int i = 0; i < N; i++)
+					y0.push_back(i + 1.0);
+
+				TestSolverCallerDiffusionChain solverCaller;
+				SparsityPattern pattern;
+				_detected = JacobianSparsityDetector::Detect(&solverCaller, 0.0, y0, NULL, pattern);
+
+				_format = (int)pattern.PatternFormat;
+				_numberOfNonZeros = pattern.GetNumberOfNonZeros();
+				_indexPointers = gcnew array<int>((int)pattern.IndexPointers.size());
+				for (int k = 0; k < _indexPointers->Length; k++)
+					_indexPointers[k] = pattern.IndexPointers[k];
+				_indexValues = gcnew array<int>((int)pattern.IndexValues.size());
+				for (int k = 0; k < _indexValues->Length; k++)
+					_indexValues[k] = pattern.IndexValues[k];
+
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetInitialTime(0.0);
+				pCVODES->SetInitialValues(y0);
+				pCVODES->SetOption("JacobianSparsityDetection", 1);
+				pCVODES->Init();
+
+				_matrixType = pCVODES->GetLinearSolverMatrixType();
+
+				std::vector<double> solution(N);
+				double tret;
+				_CVODE_Result = pCVODES->PerformSolverStep(1.0, &solution[0], NULL, tret, SimModelSolverBase::NORMAL);
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_detect_the_tridiagonal_pattern()
+		{
+			BDDExtensions::ShouldBeEqualTo(_detected, true);
+			BDDExtensions::ShouldBeEqualTo(_format, (int)SparsityPattern::CSC);
+			BDDExtensions::ShouldBeEqualTo(_numberOfNonZeros, 3 * N - 2);
+			BDDExtensions::ShouldBeEqualTo(_indexPointers->Length, N + 1);
+
+			//column j: rows j-1, j, j+1 (within the matrix)
+			for (int j = 0; j < N; j++)
+			{
+				int expectedRows = (j > 0 ? 1 : 0) + 1 + (j < N - 1 ? 1 : 0);
+				BDDExtensions::ShouldBeEqualTo(_indexPointers[j + 1] - _indexPointers[j], expectedRows);
+
+				for (int k = _indexPointers[j]; k < _indexPointers[j + 1]; k++)
+				{
+					int i = _indexValues[k];
+					BDDExtensions::ShouldBeEqualTo((i >= j - 1) && (i <= j + 1), true);
+				}
+			}
+		}
+
+		[TestAttribute]
+		void should_select_the_band_matrix_and_solve_the_system()
+		{
+			BDDExtensions::ShouldBeEqualTo(_matrixType, (int)SUNMATRIX_BAND);
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+		}
+
+	};
+
+	//all individuals share the example system, only the initial values differ
+	class TestPopulationModelFactory : public IPopulationModelFactory
+	{
+	public:
+		ISolverCaller * CreateSolverCaller() { return new TestSolverCaller(); }
+		void SetParameterValues(ISolverCaller * solverCaller, const double * parameterValues, int numberOfParameters) {}
+	};
+
+	public ref class when_solving_population_of_example_system : public ContextSpecification<double>
+	{
+	protected:
+		static const int _numberOfIndividuals = 20;
+		static const int _numberOfTimesteps = 10;
+		static const double _dt = 0.1;
+
+		int _numberOfFailures;
+		array<double>^ _results;
+		array<int>^ _resultFlags;
+
+		virtual void Context() override
+		{
+			sut = 5;
+		}
+
+		//individual i: y0=i+1; y1=0 (solved on 4 threads)
+		virtual void Because() override
+		{
+			_results = gcnew array<double>(_numberOfIndividuals * (_numberOfTimesteps + 1) * 2);
+			_resultFlags = gcnew array<int>(_numberOfIndividuals);
+
+			HINSTANCE hLib = NULL;
+
+			try
+			{
+				typedef PopulationSolver * (*GetPopulationSolverFnType)(IPopulationModelFactory *, int, int);
+
+				std::string LibName = "OSPSuite.SimModelSolver_CVODES.dll";
+				hLib = LoadLibrary(LibName.c_str());
+				if (!hLib)
+					throw "Cannot load library " + LibName;
+
+				GetPopulationSolverFnType pGetPopulationSolver = (GetPopulationSolverFnType)GetProcAddress(hLib, "GetPopulationSolver");
+				if (!pGetPopulationSolver)
+					throw LibName + " does not provide a population solver";
+
+				TestPopulationModelFactory modelFactory;
+				PopulationSolver * populationSolver = (pGetPopulationSolver)(&modelFactory, 2, 4);
+
+				populationSolver->SetAbsTol(1e-12);
+
+				std::vector<double> initialValues, outputTimes;
+				for (int i = 0; i < _numberOfIndividuals; i++)
+				{
+					initialValues.push_back(i + 1.0);
+					initialValues.push_back(0.0);
+				}
+				for (int k = 0; k <= _numberOfTimesteps; k++)
+					outputTimes.push_back(_dt*k);
+
+				std::vector<double> results(_results->Length);
+				std::vector<int> resultFlags(_numberOfIndividuals);
+
+				_numberOfFailures = populationSolver->Solve(_numberOfIndividuals, NULL, 0, &initialValues[0], outputTimes, &results[0], &resultFlags[0]);
+
+				delete populationSolver;
+
+				for (int i = 0; i < _results->Length; i++)
+					_results[i] = results[i];
+				for (int i = 0; i < _numberOfIndividuals; i++)
+					_resultFlags[i] = resultFlags[i];
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			if (hLib)
+				FreeLibrary(hLib);
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_solve_all_individuals_and_return_correct_solutions()
+		{
+			BDDExtensions::ShouldBeEqualTo(_numberOfFailures, 0);
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			for (int i = 0; i < _numberOfIndividuals; i++)
+			{
+				BDDExtensions::ShouldBeEqualTo(_resultFlags[i], 0);
+
+				//analytical solution for y0=a; y1=0:
+				// y0 = a/2*(exp(t)+exp(-t))
+				// y1 = a/2*(exp(t)-exp(-t))
+				double a = i + 1.0;
+
+				for (int k = 1; k <= _numberOfTimesteps; k++)
+				{
+					double time = _dt*k;
+					int offset = (i * (_numberOfTimesteps + 1) + k) * 2;
+
+					BDDExtensions::ShouldBeEqualTo(_results[offset], a / 2 * (exp(time) + exp(-time)), relTol);
+					BDDExtensions::ShouldBeEqualTo(_results[offset + 1], a / 2 * (exp(time) - exp(-time)), relTol);
+				}
+			}
+		}
+
+	};
+
+	public ref class when_solving_example_system_with_root_function : public concern_for_simmodel_solver_cvodes_without_sensitivity
+	{
+	protected:
+		int _rootResult;
+		double _rootTime;
+		double _rootY0;
+		double _tret;
+		double _solutionY0;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerWithRootFunction();
+		}
+
+		//solve given system for y0=2; y1=0 up to t=1
+		//analytical solution is y0 = exp(t)+exp(-t), so the root y0=3 is at t=acosh(1.5)
+		virtual void Because() override
+		{
+			try
+			{
+				SimModelSolverBase * pCVODES = CreateSolver();
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+
+				pCVODES->SetInitialValues(y0);
+				pCVODES->Init();
+
+				double Solution[2];
+
+				//stops at the root
+				_rootResult = pCVODES->PerformSolverStep(1.0, Solution, NULL, _rootTime, SimModelSolverBase::NORMAL);
+				_rootY0 = Solution[0];
+
+				//continues to tout
+				_CVODE_Result = pCVODES->PerformSolverStep(1.0, Solution, NULL, _tret, SimModelSolverBase::NORMAL);
+				_solutionY0 = Solution[0];
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_stop_at_the_root_and_continue_afterwards()
+		{
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			BDDExtensions::ShouldBeEqualTo(_rootResult, CV_ROOT_RETURN);
+			BDDExtensions::ShouldBeEqualTo(_rootTime, log(1.5 + sqrt(1.25)), relTol);
+			BDDExtensions::ShouldBeEqualTo(_rootY0, 3.0, relTol);
+
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+			BDDExtensions::ShouldBeEqualTo(_tret, 1.0);
+			BDDExtensions::ShouldBeEqualTo(_solutionY0, exp(1.0) + exp(-1.0), relTol);
+		}
+
+	};
+
+	public ref class when_solving_example_system_with_consecutive_perform_solver_steps_calls : public concern_for_simmodel_solver_cvodes_without_sensitivity
+	{
+	protected:
+		int _firstResult;
+		int _firstOutputTimesReached;
+		int _secondOutputTimesReached;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCaller();
+		}
+
+		//solve given system for y0=2; y1=0 with output times 0.1..0.5 and 0.6..1.0 in two calls
+		//the internal steps of the first call usually pass 0.6 already
+		virtual void Because() override
+		{
+			_time = gcnew array<double>(_numberOfTimesteps);
+			_y0 = gcnew array<double>(_numberOfTimesteps);
+			_y1 = gcnew array<double>(_numberOfTimesteps);
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+
+				pCVODES->SetInitialValues(y0);
+				pCVODES->Init();
+
+				const int half = _numberOfTimesteps / 2;
+				std::vector<double> outputTimes(_numberOfTimesteps), solution(_numberOfTimesteps * 2);
+
+				for (int i = 0; i < _numberOfTimesteps; i++)
+					outputTimes[i] = _dt*(i + 1);
+
+				_firstResult = pCVODES->PerformSolverSteps(&outputTimes[0], half, &solution[0], NULL, _firstOutputTimesReached);
+				_CVODE_Result = pCVODES->PerformSolverSteps(&outputTimes[half], _numberOfTimesteps - half, &solution[half * 2], NULL, _secondOutputTimesReached);
+
+				for (int i = 0; i < _numberOfTimesteps; i++)
+				{
+					_time[i] = outputTimes[i];
+					_y0[i] = solution[i * 2];
+					_y1[i] = solution[i * 2 + 1];
+				}
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_fill_the_output_times_of_both_calls_with_the_correct_solution()
+		{
+			BDDExtensions::ShouldBeEqualTo(_firstResult, 0);
+			BDDExtensions::ShouldBeEqualTo(_firstOutputTimesReached, (int)(_numberOfTimesteps / 2));
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+			BDDExtensions::ShouldBeEqualTo(_secondOutputTimesReached, (int)(_numberOfTimesteps - _numberOfTimesteps / 2));
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			for (int i = 0; i < _numberOfTimesteps; i++)
+			{
+				double time = _time[i];
+
+				BDDExtensions::ShouldBeEqualTo(_y0[i], exp(time) + exp(-time), relTol);
+				BDDExtensions::ShouldBeEqualTo(_y1[i], exp(time) - exp(-time), relTol);
+			}
+		}
+
+	};
+
+	public ref class when_continuing_perform_solver_steps_after_a_root : public concern_for_simmodel_solver_cvodes_without_sensitivity
+	{
+	protected:
+		static const int _numberOfOutputTimes = 100;
+
+		int _rootResult;
+		int _rootOutputTimesReached;
+		int _outputTimesReached;
+		array<double>^ _solutionY0;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerWithRootFunction();
+		}
+
+		//solve given system for y0=2; y1=0 with output times 0.01..1.0
+		//analytical solution is y0 = exp(t)+exp(-t), so the root y0=3 is at t=acosh(1.5)=0.9624
+		//the first call stops at the root (output times up to 0.96 filled), the second call requests
+		//the remaining output times, which are partly within the internal step containing the root
+		virtual void Because() override
+		{
+			_solutionY0 = gcnew array<double>(_numberOfOutputTimes);
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+
+				pCVODES->SetInitialValues(y0);
+				pCVODES->Init();
+
+				std::vector<double> outputTimes(_numberOfOutputTimes), solution(_numberOfOutputTimes * 2);
+
+				for (int i = 0; i < _numberOfOutputTimes; i++)
+					outputTimes[i] = 0.01*(i + 1);
+
+				_rootResult = pCVODES->PerformSolverSteps(&outputTimes[0], _numberOfOutputTimes, &solution[0], NULL, _rootOutputTimesReached);
+
+				_CVODE_Result = pCVODES->PerformSolverSteps(&outputTimes[_rootOutputTimesReached], _numberOfOutputTimes - _rootOutputTimesReached,
+					                                        &solution[_rootOutputTimesReached * 2], NULL, _outputTimesReached);
+
+				for (int i = 0; i < _numberOfOutputTimes; i++)
+					_solutionY0[i] = solution[i * 2];
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_stop_at_the_root_and_fill_the_remaining_output_times_afterwards()
+		{
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			BDDExtensions::ShouldBeEqualTo(_rootResult, CV_ROOT_RETURN);
+			BDDExtensions::ShouldBeEqualTo(_rootOutputTimesReached, 96);
+
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+			BDDExtensions::ShouldBeEqualTo(_outputTimesReached, _numberOfOutputTimes - 96);
+
+			for (int i = 0; i < _numberOfOutputTimes; i++)
+			{
+				double time = 0.01*(i + 1);
+				BDDExtensions::ShouldBeEqualTo(_solutionY0[i], exp(time) + exp(-time), relTol);
+			}
+		}
+
+	};
+
+	//least squares objective sum_k (y0(t_k)-1)^2 of TestSolverCallerWithParameters at the measurement times 0.25, 0.5, 0.75, 1
+	//(each measurement is a jump of the adjoint variables in the backward solve)
+	public ref class concern_for_least_squares_objective abstract : concern_for_simmodel_solver_cvodes
+	{
+	protected:
+		static const int _numberOfMeasurements = 4;
+		static const double _observedValue = 1.0;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerWithParameters();
+		}
+
+		virtual int NumberOfUnknowns() override
+		{
+			return 2;
+		}
+
+		virtual int NumberOfSensitivityParameters() override
+		{
+			return 2;
+		}
+
+		static double MeasurementTime(int k)
+		{
+			return 0.25*(k + 1);
+		}
+
+		//analytical gradient of the objective at the parameter values p1, p2
+		static void AnalyticalGradient(double p1, double p2, double * gradient)
+		{
+			double w = sqrt(p1*p2);
+
+			gradient[0] = 0.0;
+			gradient[1] = 0.0;
+
+			for (int k = 0; k < _numberOfMeasurements; k++)
+			{
+				double t = MeasurementTime(k);
+				double residual = 2.0*cosh(w*t) - _observedValue;
+
+				gradient[0] += 2.0*residual*t*sinh(w*t)*p2 / w;
+				gradient[1] += 2.0*residual*t*sinh(w*t)*p1 / w;
+			}
+		}
+
+		//computes the objective with the forward or adjoint sensitivities
+		//(hessianDirection: not empty for the Hessian-vector product)
+		int ComputeObjective(bool adjoint, const std::vector<double> & hessianDirection, double & objective, double * gradient, double * hessianVector)
+		{
+			int resultFlag = -1;
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetRelTol(1e-9);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+				pCVODES->SetInitialValues(y0);
+
+				pCVODES->SetNumberOfSensitivityParameters(2);
+				pCVODES->SetSensitivityParametersInitialValues(std::vector<double>(2, 1.0));
+				pCVODES->SetOption("AdjointSensitivities", adjoint ? 1 : 0);
+				if (!hessianDirection.empty())
+					pCVODES->SetHessianDirection(hessianDirection);
+
+				pCVODES->Init();
+
+				std::vector<double> measurementTimes, observedValues(_numberOfMeasurements, _observedValue);
+				for (int k = 0; k < _numberOfMeasurements; k++)
+					measurementTimes.push_back(MeasurementTime(k));
+				std::vector<int> stateIndices(1, 0);
+
+				resultFlag = pCVODES->ComputeLeastSquaresObjective(measurementTimes, stateIndices, &observedValues[0], NULL,
+					                                               objective, gradient, hessianVector);
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+
+			return resultFlag;
+		}
+	};
+
+	public ref class when_computing_least_squares_gradient_with_adjoint_sensitivities : public concern_for_least_squares_objective
+	{
+	protected:
+		int _forwardResult;
+		int _adjointResult;
+		double _forwardObjective;
+		double _adjointObjective;
+		array<double>^ _forwardGradient;
+		array<double>^ _adjointGradient;
+
+		virtual void Because() override
+		{
+			double forwardGradient[2], adjointGradient[2];
+
+			_forwardResult = ComputeObjective(false, std::vector<double>(), _forwardObjective, forwardGradient, NULL);
+			_adjointResult = ComputeObjective(true, std::vector<double>(), _adjointObjective, adjointGradient, NULL);
+
+			_forwardGradient = gcnew array<double>(2);
+			_adjointGradient = gcnew array<double>(2);
+			for (int j = 0; j < 2; j++)
+			{
+				_forwardGradient[j] = forwardGradient[j];
+				_adjointGradient[j] = adjointGradient[j];
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_the_gradient_of_the_forward_sensitivities()
+		{
+			BDDExtensions::ShouldBeEqualTo(_forwardResult, 0);
+			BDDExtensions::ShouldBeEqualTo(_adjointResult, 0);
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			double expectedObjective = 0.0;
+			for (int k = 0; k < _numberOfMeasurements; k++)
+				expectedObjective += pow(2.0*cosh(MeasurementTime(k)) - _observedValue, 2);
+
+			double expectedGradient[2];
+			AnalyticalGradient(1.0, 1.0, expectedGradient);
+
+			BDDExtensions::ShouldBeEqualTo(_forwardObjective, expectedObjective, relTol);
+			BDDExtensions::ShouldBeEqualTo(_adjointObjective, expectedObjective, relTol);
+
+			for (int j = 0; j < 2; j++)
+			{
+				BDDExtensions::ShouldBeEqualTo(_forwardGradient[j], expectedGradient[j], relTol);
+				BDDExtensions::ShouldBeEqualTo(_adjointGradient[j], _forwardGradient[j], relTol);
+			}
+		}
+
+	};
+
+	public ref class when_computing_hessian_vector_product_with_second_order_adjoint_sensitivities : public concern_for_least_squares_objective
+	{
+	protected:
+		int _CVODE_Result;
+		array<double>^ _direction;
+		array<double>^ _hessianVector;
+
+		virtual void Because() override
+		{
+			std::vector<double> direction;
+			direction.push_back(1.0);
+			direction.push_back(0.5);
+
+			double objective, gradient[2], hessianVector[2];
+			_CVODE_Result = ComputeObjective(true, direction, objective, gradient, hessianVector);
+
+			_direction = gcnew array<double>(2);
+			_hessianVector = gcnew array<double>(2);
+			for (int j = 0; j < 2; j++)
+			{
+				_direction[j] = direction[j];
+				_hessianVector[j] = hessianVector[j];
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_the_finite_difference_of_the_gradient_in_the_hessian_direction()
+		{
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+
+			const double relTol = 1e-4; //max. allowed relative deviation 0.01%
+
+			//central difference (g(p+h*u)-g(p-h*u))/(2h) of the analytical gradient at p=(1,1)
+			const double h = 1e-5;
+			double gradientPlus[2], gradientMinus[2];
+			AnalyticalGradient(1.0 + h*_direction[0], 1.0 + h*_direction[1], gradientPlus);
+			AnalyticalGradient(1.0 - h*_direction[0], 1.0 - h*_direction[1], gradientMinus);
+
+			for (int j = 0; j < 2; j++)
+				BDDExtensions::ShouldBeEqualTo(_hessianVector[j], (gradientPlus[j] - gradientMinus[j]) / (2.0*h), relTol);
+		}
+
+	};
+
+	public ref class when_the_instrumentation_report_cannot_be_written : public concern_for_simmodel_solver_cvodes_without_sensitivity
+	{
+	protected:
+		bool _reportErrorSet;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCaller();
+		}
+
+		virtual void Because() override
+		{
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+				pCVODES->SetInitialValues(y0);
+
+				//directory does not exist
+				pCVODES->SetInstrumentationOutput("NonExistingDirectory\\SolverReport.json");
+				pCVODES->Init();
+
+				double Solution[2];
+				double tret;
+				_CVODE_Result = pCVODES->PerformSolverStep(1.0, Solution, NULL, tret, SimModelSolverBase::NORMAL);
+
+				pCVODES->Terminate();
+
+				_reportErrorSet = !pCVODES->GetInstrumentationReportError().empty();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_report_the_failure_after_terminate()
+		{
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+			BDDExtensions::ShouldBeEqualTo(_reportErrorSet, true);
+		}
+
+	};
+
+	//the shuffled diffusion chain is solved with and without the internal state reordering;
+	//outputs are compared element-wise for a subset of observed states and sensitivity parameters
+	public ref class when_solving_a_shuffled_diffusion_chain_with_state_reordering : public concern_for_simmodel_solver_cvodes
+	{
+	protected:
+		static const int N = TestSolverCallerShuffledDiffusionChain::N;
+		static const int _numberOfOutputTimes = 4;
+		static const double _notWritten = -999.0;
+
+		int _reorderedResult;
+		int _originalResult;
+		int _reorderedMatrixType;
+		int _originalMatrixType;
+		array<double>^ _reorderedY;
+		array<double>^ _originalY;
+		array<double>^ _reorderedYS;
+		array<double>^ _originalYS;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerShuffledDiffusionChain();
+		}
+
+		virtual int NumberOfUnknowns() override
+		{
+			return N;
+		}
+
+		virtual int NumberOfSensitivityParameters() override
+		{
+			return 2;
+		}
+
+		static bool IsObservedState(int i)
+		{
+			return (i == TestSolverCallerShuffledDiffusionChain::StateIndex(2)) || (i == TestSolverCallerShuffledDiffusionChain::StateIndex(9)) ||
+				   (i == TestSolverCallerShuffledDiffusionChain::StateIndex(17));
+		}
+
+		//solution y[k*N+i] and sensitivities yS[(k*N+i)*2+j] at the output times 0.5, 1, 1.5, 2
+		//(entries not observed keep the value _notWritten)
+		int Solve(bool stateReordering, std::vector<double> & y, std::vector<double> & yS, int & matrixType)
+		{
+			int resultFlag = -1;
+
+			y.assign(_numberOfOutputTimes * N, _notWritten);
+			yS.assign(_numberOfOutputTimes * N * 2, _notWritten);
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetRelTol(1e-9);
+				pCVODES->SetInitialTime(0.0);
+
+				std::vector<double> y0(N);
+				for (int k = 0; k < N; k++)
+					y0[TestSolverCallerShuffledDiffusionChain::StateIndex(k)] = k + 1.0;
+				pCVODES->SetInitialValues(y0);
+
+				std::vector<double> p;
+				p.push_back(1.0);
+				p.push_back(0.1);
+				pCVODES->SetNumberOfSensitivityParameters(2);
+				pCVODES->SetSensitivityParametersInitialValues(p);
+
+				std::vector<int> observedStates;
+				for (int i = 0; i < N; i++)
+					if (IsObservedState(i))
+						observedStates.push_back(i);
+				pCVODES->SetObservedStates(observedStates);
+				pCVODES->SetObservedSensitivityParameters(std::vector<int>(1, 1));
+
+				pCVODES->SetOption("StateReordering", stateReordering ? 1 : 0);
+				pCVODES->Init();
+
+				matrixType = pCVODES->GetLinearSolverMatrixType();
+
+				std::vector<double *> sensitivityRows(N);
+				for (int k = 0; k < _numberOfOutputTimes; k++)
+				{
+					for (int i = 0; i < N; i++)
+						sensitivityRows[i] = &yS[(k * N + i) * 2];
+
+					double tret;
+					resultFlag = pCVODES->PerformSolverStep(0.5*(k + 1), &y[k * N], &sensitivityRows[0], tret, SimModelSolverBase::NORMAL);
+					if (resultFlag != 0)
+						break;
+				}
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+
+			return resultFlag;
+		}
+
+		static array<double>^ ToArray(const std::vector<double> & values)
+		{
+			array<double>^ result = gcnew array<double>((int)values.size());
+			for (int k = 0; k < result->Length; k++)
+				result[k] = values[k];
+
+			return result;
+		}
+
+		virtual void Because() override
+		{
+			std::vector<double> y, yS;
+
+			_reorderedResult = Solve(true, y, yS, _reorderedMatrixType);
+			_reorderedY = ToArray(y);
+			_reorderedYS = ToArray(yS);
+
+			_originalResult = Solve(false, y, yS, _originalMatrixType);
+			_originalY = ToArray(y);
+			_originalYS = ToArray(yS);
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_use_the_band_solver_only_with_the_state_reordering()
+		{
+			BDDExtensions::ShouldBeEqualTo(_reorderedResult, 0);
+			BDDExtensions::ShouldBeEqualTo(_originalResult, 0);
+
+			BDDExtensions::ShouldBeEqualTo(_reorderedMatrixType, (int)SUNMATRIX_BAND);
+			BDDExtensions::ShouldBeEqualTo(_originalMatrixType, (int)SUNMATRIX_DENSE);
+		}
+
+		[TestAttribute]
+		void should_return_the_same_observed_states_and_sensitivities_in_the_caller_numbering()
+		{
+			const double relTol = 1e-6; //max. allowed relative deviation 0.0001%
+
+			for (int k = 0; k < _numberOfOutputTimes; k++)
+			{
+				for (int i = 0; i < N; i++)
+				{
+					int index = k * N + i;
+
+					if (!IsObservedState(i))
+					{
+						BDDExtensions::ShouldBeEqualTo(_reorderedY[index], _notWritten);
+						BDDExtensions::ShouldBeEqualTo(_reorderedYS[index * 2 + 1], _notWritten);
+						continue;
+					}
+
+					BDDExtensions::ShouldBeEqualTo(_reorderedY[index], _originalY[index], relTol);
+					BDDExtensions::ShouldBeEqualTo(_reorderedYS[index * 2 + 1], _originalYS[index * 2 + 1], relTol);
+
+					//parameter 0 not observed
+					BDDExtensions::ShouldBeEqualTo(_reorderedYS[index * 2], _notWritten);
+					BDDExtensions::ShouldBeEqualTo(_originalYS[index * 2], _notWritten);
+				}
+			}
+		}
+
+	};
+
+	public ref class when_evaluating_the_colored_difference_quotient_jacobian : public ContextSpecification<double>
+	{
+	protected:
+		static const int N = ColoredJacobianTestSystem::N;
+
+		array<int>^ _results;
+		array<int>^ _numberOfColors;
+		array<array<double>^>^ _coloredValues;
+		array<array<double>^>^ _analyticValues;
+
+		virtual void Context() override
+		{
+			sut = 5;
+		}
+
+		//[0]: banded, [1]: arrow
+		virtual void Because() override
+		{
+			_results = gcnew array<int>(2);
+			_numberOfColors = gcnew array<int>(2);
+			_coloredValues = gcnew array<array<double>^>(2);
+			_analyticValues = gcnew array<array<double>^>(2);
+
+			for (int s = 0; s < 2; s++)
+			{
+				ColoredJacobianTestSystem system(s == 1);
+				std::vector<double> coloredValues, analyticValues;
+				int numberOfColors;
+
+				_results[s] = system.EvaluateColoredJacobian(numberOfColors, coloredValues, analyticValues);
+				_numberOfColors[s] = numberOfColors;
+
+				_coloredValues[s] = gcnew array<double>((int)coloredValues.size());
+				_analyticValues[s] = gcnew array<double>((int)analyticValues.size());
+				for (int k = 0; k < (int)coloredValues.size(); k++)
+				{
+					_coloredValues[s][k] = coloredValues[k];
+					_analyticValues[s][k] = analyticValues[k];
+				}
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_perturb_structurally_orthogonal_columns_together()
+		{
+			//tridiagonal: columns j, j+3, j+6, ... share a color
+			BDDExtensions::ShouldBeEqualTo(_numberOfColors[0], 3);
+
+			//arrow: every column shares the first row with all others
+			BDDExtensions::ShouldBeEqualTo(_numberOfColors[1], N);
+		}
+
+		[TestAttribute]
+		void should_approximate_the_analytic_jacobian_of_the_banded_and_the_arrow_pattern()
+		{
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			for (int s = 0; s < 2; s++)
+			{
+				BDDExtensions::ShouldBeEqualTo(_results[s], (int)RHS_OK);
+				BDDExtensions::ShouldBeEqualTo(_coloredValues[s]->Length, 3 * N - 2);
+
+				for (int k = 0; k < _coloredValues[s]->Length; k++)
+					BDDExtensions::ShouldBeEqualTo(_coloredValues[s][k], _analyticValues[s][k], relTol);
+			}
+		}
+
+	};
+
+	public ref class when_normalizing_permuting_and_reordering_sparsity_patterns : public ContextSpecification<double>
+	{
+	protected:
+		static const int N = ColoredJacobianTestSystem::N;
+
+		array<int>^ _normalizedIndexPointers;
+		array<int>^ _normalizedIndexValues;
+		array<int>^ _valueMap;
+		int _valueMapSizeOfNormalizedPattern;
+		int _valueMapSizeOfDescendingPattern;
+		bool _descendingPatternSorted;
+
+		int _permutedNumberOfNonZeros;
+		bool _permutedEntriesFound;
+
+		bool _shuffledPermutationValid;
+		int _shuffledLowerHalfBandWidth;
+		int _reorderedLowerHalfBandWidth;
+		int _reorderedUpperHalfBandWidth;
+
+		bool _arrowPermutationValid;
+		int _arrowBandWidth;
+		int _reorderedArrowBandWidth;
+
+		virtual void Context() override
+		{
+			sut = 5;
+		}
+
+		static bool IsPermutation(const std::vector<int> & permutation)
+		{
+			std::vector<bool> found(N, false);
+			if ((int)permutation.size() != N)
+				return false;
+
+			for (int k = 0; k < N; k++)
+			{
+				if ((permutation[k] < 0) || (permutation[k] >= N) || found[permutation[k]])
+					return false;
+				found[permutation[k]] = true;
+			}
+
+			return true;
+		}
+
+		static bool ContainsEntry(const SparsityPattern & pattern, int i, int j)
+		{
+			for (int k = pattern.IndexPointers[j]; k < pattern.IndexPointers[j + 1]; k++)
+				if (pattern.IndexValues[k] == i)
+					return true;
+
+			return false;
+		}
+
+		virtual void Because() override
+		{
+			int ml, mu;
+			std::vector<int> valueMap;
+
+			//---- 4x4 CSC pattern with duplicates, unsorted rows and missing diagonal entries:
+			//column 0: rows 2, 2   column 1: row 0   column 2: -   column 3: rows 3, 1
+			SparsityPattern pattern(4, SparsityPattern::CSC);
+			int indexPointers[] = { 0, 2, 3, 3, 5 };
+			int indexValues[] = { 2, 2, 0, 3, 1 };
+			pattern.IndexPointers.assign(indexPointers, indexPointers + 5);
+			pattern.IndexValues.assign(indexValues, indexValues + 5);
+
+			SparsityPattern normalized = pattern.Normalized(valueMap);
+
+			_normalizedIndexPointers = gcnew array<int>((int)normalized.IndexPointers.size());
+			for (int k = 0; k < _normalizedIndexPointers->Length; k++)
+				_normalizedIndexPointers[k] = normalized.IndexPointers[k];
+			_normalizedIndexValues = gcnew array<int>(normalized.GetNumberOfNonZeros());
+			for (int k = 0; k < _normalizedIndexValues->Length; k++)
+				_normalizedIndexValues[k] = normalized.IndexValues[k];
+			_valueMap = gcnew array<int>((int)valueMap.size());
+			for (int k = 0; k < _valueMap->Length; k++)
+				_valueMap[k] = valueMap[k];
+
+			normalized.Normalized(valueMap);
+			_valueMapSizeOfNormalizedPattern = (int)valueMap.size();
+
+			//---- banded pattern with the rows of each column in descending order
+			SparsityPattern banded = ColoredJacobianTestSystem(false).Pattern();
+			SparsityPattern sortedBanded = banded.Normalized(valueMap);
+			_valueMapSizeOfDescendingPattern = (int)valueMap.size();
+
+			_descendingPatternSorted = (sortedBanded.GetNumberOfNonZeros() == banded.GetNumberOfNonZeros());
+			for (int j = 0; j < N; j++)
+				for (int k = sortedBanded.IndexPointers[j] + 1; k < sortedBanded.IndexPointers[j + 1]; k++)
+					_descendingPatternSorted = _descendingPatternSorted && (sortedBanded.IndexValues[k - 1] < sortedBanded.IndexValues[k]);
+
+			//---- shuffled numbering: state 3*k mod N is the k-th state of the chain
+			std::vector<int> shuffle(N), inverseShuffle(N);
+			for (int k = 0; k < N; k++)
+			{
+				shuffle[k] = (3 * k) % N;
+				inverseShuffle[shuffle[k]] = k;
+			}
+
+			//P*A*P^T with the inverse shuffle: chain position k becomes state shuffle[k],
+			//so entry (i,j) of the banded pattern is entry (shuffle[i],shuffle[j]) of the shuffled one
+			SparsityPattern shuffled = sortedBanded.Permuted(inverseShuffle);
+			_permutedNumberOfNonZeros = shuffled.GetNumberOfNonZeros();
+			_permutedEntriesFound = true;
+			for (int j = 0; j < N; j++)
+				for (int k = sortedBanded.IndexPointers[j]; k < sortedBanded.IndexPointers[j + 1]; k++)
+					_permutedEntriesFound = _permutedEntriesFound && ContainsEntry(shuffled, shuffle[sortedBanded.IndexValues[k]], shuffle[j]);
+
+			shuffled.GetHalfBandWidths(ml, mu);
+			_shuffledLowerHalfBandWidth = ml;
+
+			//---- reverse Cuthill-McKee restores the tridiagonal structure of the shuffled chain
+			std::vector<int> permutation = shuffled.ReverseCuthillMcKee();
+			_shuffledPermutationValid = IsPermutation(permutation);
+
+			shuffled.Permuted(permutation).GetHalfBandWidths(ml, mu);
+			_reorderedLowerHalfBandWidth = ml;
+			_reorderedUpperHalfBandWidth = mu;
+
+			//---- arrow pattern: the ordering must not increase the bandwidth
+			SparsityPattern arrow = ColoredJacobianTestSystem(true).Pattern();
+			arrow.GetHalfBandWidths(ml, mu);
+			_arrowBandWidth = ml + mu;
+
+			permutation = arrow.ReverseCuthillMcKee();
+			_arrowPermutationValid = IsPermutation(permutation);
+
+			arrow.Permuted(permutation).GetHalfBandWidths(ml, mu);
+			_reorderedArrowBandWidth = ml + mu;
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_sort_merge_and_complete_the_diagonal_of_a_pattern()
+		{
+			//column 0: rows 0, 2   column 1: rows 0, 1   column 2: row 2   column 3: rows 1, 3
+			int expectedIndexPointers[] = { 0, 2, 4, 5, 7 };
+			int expectedIndexValues[] = { 0, 2, 0, 1, 2, 1, 3 };
+			int expectedValueMap[] = { 1, 1, 2, 6, 5 };
+
+			BDDExtensions::ShouldBeEqualTo(_normalizedIndexPointers->Length, 5);
+			for (int k = 0; k < 5; k++)
+				BDDExtensions::ShouldBeEqualTo(_normalizedIndexPointers[k], expectedIndexPointers[k]);
+
+			BDDExtensions::ShouldBeEqualTo(_normalizedIndexValues->Length, 7);
+			for (int k = 0; k < 7; k++)
+				BDDExtensions::ShouldBeEqualTo(_normalizedIndexValues[k], expectedIndexValues[k]);
+
+			//duplicates are mapped to the same entry
+			BDDExtensions::ShouldBeEqualTo(_valueMap->Length, 5);
+			for (int k = 0; k < 5; k++)
+				BDDExtensions::ShouldBeEqualTo(_valueMap[k], expectedValueMap[k]);
+		}
+
+		[TestAttribute]
+		void should_return_an_empty_value_map_only_for_a_normalized_pattern()
+		{
+			BDDExtensions::ShouldBeEqualTo(_valueMapSizeOfNormalizedPattern, 0);
+
+			BDDExtensions::ShouldBeEqualTo(_valueMapSizeOfDescendingPattern, 3 * N - 2);
+			BDDExtensions::ShouldBeEqualTo(_descendingPatternSorted, true);
+		}
+
+		[TestAttribute]
+		void should_permute_rows_and_columns_symmetrically()
+		{
+			BDDExtensions::ShouldBeEqualTo(_permutedNumberOfNonZeros, 3 * N - 2);
+			BDDExtensions::ShouldBeEqualTo(_permutedEntriesFound, true);
+			BDDExtensions::ShouldBeEqualTo(_shuffledLowerHalfBandWidth > 1, true);
+		}
+
+		[TestAttribute]
+		void should_reduce_the_bandwidth_with_the_reverse_cuthill_mckee_ordering()
+		{
+			BDDExtensions::ShouldBeEqualTo(_shuffledPermutationValid, true);
+			BDDExtensions::ShouldBeEqualTo(_reorderedLowerHalfBandWidth, 1);
+			BDDExtensions::ShouldBeEqualTo(_reorderedUpperHalfBandWidth, 1);
+
+			BDDExtensions::ShouldBeEqualTo(_arrowPermutationValid, true);
+			BDDExtensions::ShouldBeEqualTo(_reorderedArrowBandWidth <= _arrowBandWidth, true);
+		}
+
+	};
+
+	//TestSolverCallerWithParameters (autonomous) with the AUC quadrature is solved up to the stop time 1 and continued
+	// - without ReInit
+	// - by ReInit at t0 = 1 (sensitivities and quadrature interpolated at t0)
+	// - by ReInit at t0 = 1.5 with the states at 1: t0 is beyond the last internal step (CV_BAD_T), so the
+	//   sensitivities and the quadrature at the last output time 1 are continued. The solution after t0 is
+	//   the uninterrupted one shifted by 0.5
+	public ref class when_continuing_sensitivities_and_quadratures_with_reinit : public concern_for_simmodel_solver_cvodes
+	{
+	protected:
+		static const int _numberOfOutputTimes = 8;
+		static const int _reInitOutputIndex = 4;
+
+		//per output time: y0, y1, dy0/dP1, dy0/dP2, dy1/dP1, dy1/dP2, q
+		static const int _numberOfValues = 7;
+
+		array<int>^ _results;
+		array<array<double>^>^ _values;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerWithParametersAndQuadrature();
+		}
+
+		virtual int NumberOfUnknowns() override
+		{
+			return 2;
+		}
+
+		virtual int NumberOfSensitivityParameters() override
+		{
+			return 2;
+		}
+
+		static double OutputTime(int k)
+		{
+			return 0.25*(k + 1);
+		}
+
+		//values at the output times (reInitTime 0: without ReInit)
+		int Solve(double reInitTime, std::vector<double> & values)
+		{
+			int resultFlag = -1;
+			values.assign(_numberOfOutputTimes * _numberOfValues, 0.0);
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetRelTol(1e-9);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+				pCVODES->SetInitialValues(y0);
+
+				pCVODES->SetNumberOfSensitivityParameters(2);
+				pCVODES->SetSensitivityParametersInitialValues(std::vector<double>(2, 1.0));
+				pCVODES->SetStopTimes(std::vector<double>(1, OutputTime(_reInitOutputIndex - 1)));
+
+				pCVODES->Init();
+
+				double y[2], sensitivities[2][2], q[1];
+				double * yS[2] = { sensitivities[0], sensitivities[1] };
+				double shift = 0.0;
+
+				for (int k = 0; k < _numberOfOutputTimes; k++)
+				{
+					if ((k == _reInitOutputIndex) && (reInitTime > 0.0))
+					{
+						shift = reInitTime - OutputTime(k - 1);
+
+						std::vector<double> yReInit(y, y + 2);
+						resultFlag = pCVODES->ReInit(reInitTime, yReInit);
+						if (resultFlag != 0)
+							break;
+					}
+
+					double tret;
+					resultFlag = pCVODES->PerformSolverStep(OutputTime(k) + shift, y, yS, tret, SimModelSolverBase::NORMAL);
+					if ((resultFlag != 0) && (resultFlag != CV_TSTOP_RETURN))
+						break;
+					resultFlag = 0;
+
+					pCVODES->GetQuadratures(q);
+
+					double * outputValues = &values[k * _numberOfValues];
+					outputValues[0] = y[0];
+					outputValues[1] = y[1];
+					outputValues[2] = sensitivities[0][0];
+					outputValues[3] = sensitivities[0][1];
+					outputValues[4] = sensitivities[1][0];
+					outputValues[5] = sensitivities[1][1];
+					outputValues[6] = q[0];
+				}
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+
+			return resultFlag;
+		}
+
+		//[0]: without ReInit, [1]: ReInit at 1, [2]: ReInit at 1.5
+		virtual void Because() override
+		{
+			double reInitTimes[] = { 0.0, 1.0, 1.5 };
+
+			_results = gcnew array<int>(3);
+			_values = gcnew array<array<double>^>(3);
+
+			for (int run = 0; run < 3; run++)
+			{
+				std::vector<double> values;
+				_results[run] = Solve(reInitTimes[run], values);
+
+				_values[run] = gcnew array<double>((int)values.size());
+				for (int k = 0; k < (int)values.size(); k++)
+					_values[run][k] = values[k];
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_the_analytical_solution_without_reinit()
+		{
+			BDDExtensions::ShouldBeEqualTo(_results[0], 0);
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			//P1 = P2 = 1: w = 1
+			for (int k = 0; k < _numberOfOutputTimes; k++)
+			{
+				double t = OutputTime(k);
+				int offset = k * _numberOfValues;
+
+				BDDExtensions::ShouldBeEqualTo(_values[0][offset], 2.0*cosh(t), relTol);
+				BDDExtensions::ShouldBeEqualTo(_values[0][offset + 2], t*sinh(t), relTol);
+				BDDExtensions::ShouldBeEqualTo(_values[0][offset + 3], t*sinh(t), relTol);
+				BDDExtensions::ShouldBeEqualTo(_values[0][offset + 6], 2.0*sinh(t), relTol);
+			}
+		}
+
+		[TestAttribute]
+		void should_continue_the_sensitivities_and_the_quadrature_at_the_reinit_time()
+		{
+			BDDExtensions::ShouldBeEqualTo(_results[1], 0);
+
+			const double relTol = 1e-6; //max. allowed relative deviation 0.0001%
+
+			for (int k = 0; k < _values[0]->Length; k++)
+				BDDExtensions::ShouldBeEqualTo(_values[1][k], _values[0][k], relTol);
+		}
+
+		[TestAttribute]
+		void should_continue_the_values_of_the_last_output_time_if_the_reinit_time_is_beyond_the_last_step()
+		{
+			BDDExtensions::ShouldBeEqualTo(_results[2], 0);
+
+			const double relTol = 1e-6; //max. allowed relative deviation 0.0001%
+
+			for (int k = 0; k < _values[0]->Length; k++)
+				BDDExtensions::ShouldBeEqualTo(_values[2][k], _values[0][k], relTol);
+		}
+
+	};
+
+	//TestSolverCallerWithParameters (P1 = P2 = 1, y0(0) = 2, y1(0) = 0) with forward sensitivities, solved to the
+	//output times 0.25, 0.5, ..., 2 by the different output functions of the solver
+	public ref class concern_for_solver_output abstract : concern_for_simmodel_solver_cvodes
+	{
+	protected:
+		static const int _numberOfOutputTimes = 8;
+
+		//per output time: y0, y1, dy0/dP1, dy0/dP2, dy1/dP1, dy1/dP2
+		static const int _numberOfValues = 6;
+
+		//initial value of the outputs (entries not written keep it)
+		static const double _notWritten = -999.0;
+
+		//output function: PerformSolverStep, PerformSolverStepContiguous or
+		//PerformSolverStepContiguous without sensitivity buffer and GetSensitivityValues
+		static const int _performSolverStep = 0;
+		static const int _performSolverStepContiguous = 1;
+		static const int _getSensitivityValues = 2;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			return new TestSolverCallerWithParameters();
+		}
+
+		virtual int NumberOfUnknowns() override
+		{
+			return 2;
+		}
+
+		virtual int NumberOfSensitivityParameters() override
+		{
+			return 2;
+		}
+
+		static double OutputTime(int k)
+		{
+			return 0.25*(k + 1);
+		}
+
+		//analytical solution at P1 = P2 = 1 in the layout of the output values
+		static void AnalyticalSolution(double t, double * values)
+		{
+			values[0] = 2.0*cosh(t);
+			values[1] = 2.0*sinh(t);
+			values[2] = t*sinh(t);
+			values[3] = t*sinh(t);
+			values[4] = t*cosh(t) - sinh(t);
+			values[5] = t*cosh(t) + sinh(t);
+		}
+
+		//additional solver options (set before Init)
+		virtual void SetSolverOptions(SimModelSolver_CVODES * pCVODES) {}
+
+		//output values (and the quadratures, if any) at the output times
+		int Solve(int outputFunction, std::vector<double> & values, std::vector<double> & quadratures)
+		{
+			int resultFlag = -1;
+
+			values.assign(_numberOfOutputTimes * _numberOfValues, _notWritten);
+			quadratures.clear();
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetRelTol(1e-9);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+				pCVODES->SetInitialValues(y0);
+
+				pCVODES->SetNumberOfSensitivityParameters(2);
+				pCVODES->SetSensitivityParametersInitialValues(std::vector<double>(2, 1.0));
+
+				SetSolverOptions(pCVODES);
+
+				pCVODES->Init();
+
+				int numberOfQuadratures = pCVODES->GetNumberOfQuadratures();
+				quadratures.assign(_numberOfOutputTimes * numberOfQuadratures, 0.0);
+
+				for (int k = 0; k < _numberOfOutputTimes; k++)
+				{
+					double * y = &values[k * _numberOfValues];
+					double yS[4] = { _notWritten, _notWritten, _notWritten, _notWritten };
+					double tret;
+
+					if (outputFunction == _performSolverStep)
+					{
+						//yS[i][j]=dy_i/dp_j
+						double * rows[2] = { &yS[0], &yS[2] };
+						resultFlag = pCVODES->PerformSolverStep(OutputTime(k), y, rows, tret, SimModelSolverBase::NORMAL);
+
+						for (int m = 0; m < 4; m++)
+							y[2 + m] = yS[m];
+					}
+					else
+					{
+						//yS[j*N+i]=dy_i/dp_j
+						double * contiguousYS = (outputFunction == _performSolverStepContiguous) ? yS : NULL;
+						resultFlag = pCVODES->PerformSolverStepContiguous(OutputTime(k), y, contiguousYS, tret, SimModelSolverBase::NORMAL);
+
+						for (int j = 0; j < 2; j++)
+						{
+							const double * ySj = (outputFunction == _getSensitivityValues) ? pCVODES->GetSensitivityValues(j) : &yS[j * 2];
+							if (ySj == NULL)
+								continue;
+
+							for (int i = 0; i < 2; i++)
+								y[2 + i * 2 + j] = ySj[i];
+						}
+					}
+
+					if (resultFlag != 0)
+						break;
+
+					if (numberOfQuadratures > 0)
+						pCVODES->GetQuadratures(&quadratures[k * numberOfQuadratures]);
+				}
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+
+			return resultFlag;
+		}
+
+		static array<double>^ ToArray(const std::vector<double> & values)
+		{
+			array<double>^ result = gcnew array<double>((int)values.size());
+			for (int k = 0; k < result->Length; k++)
+				result[k] = values[k];
+
+			return result;
+		}
+	};
+
+	public ref class when_returning_the_sensitivities_contiguously_or_as_a_view : public concern_for_solver_output
+	{
+	protected:
+		array<int>^ _results;
+		array<array<double>^>^ _values;
+
+		//[0]: PerformSolverStep, [1]: PerformSolverStepContiguous, [2]: GetSensitivityValues
+		virtual void Because() override
+		{
+			_results = gcnew array<int>(3);
+			_values = gcnew array<array<double>^>(3);
+
+			for (int outputFunction = 0; outputFunction < 3; outputFunction++)
+			{
+				std::vector<double> values, quadratures;
+				_results[outputFunction] = Solve(outputFunction, values, quadratures);
+				_values[outputFunction] = ToArray(values);
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_the_analytical_solution_with_perform_solver_step()
+		{
+			BDDExtensions::ShouldBeEqualTo(_results[_performSolverStep], 0);
+
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			std::vector<double> expectedValues(_numberOfValues);
+			for (int k = 0; k < _numberOfOutputTimes; k++)
+			{
+				AnalyticalSolution(OutputTime(k), &expectedValues[0]);
+
+				for (int m = 0; m < _numberOfValues; m++)
+					BDDExtensions::ShouldBeEqualTo(_values[_performSolverStep][k * _numberOfValues + m], expectedValues[m], relTol);
+			}
+		}
+
+		[TestAttribute]
+		void should_return_the_same_sensitivities_as_perform_solver_step()
+		{
+			BDDExtensions::ShouldBeEqualTo(_results[_performSolverStepContiguous], 0);
+			BDDExtensions::ShouldBeEqualTo(_results[_getSensitivityValues], 0);
+
+			const double relTol = 1e-10;
+
+			for (int k = 0; k < _values[_performSolverStep]->Length; k++)
+			{
+				BDDExtensions::ShouldBeEqualTo(_values[_performSolverStepContiguous][k], _values[_performSolverStep][k], relTol);
+				BDDExtensions::ShouldBeEqualTo(_values[_getSensitivityValues][k], _values[_performSolverStep][k], relTol);
+			}
+		}
+
+	};
+
+	public ref class when_restricting_the_output_to_observed_states_and_parameters : public concern_for_solver_output
+	{
+	protected:
+		bool _observedSubset;
+
+		array<int>^ _results;
+		array<array<double>^>^ _values;
+
+		//observed: state y1 and parameter P2
+		virtual void SetSolverOptions(SimModelSolver_CVODES * pCVODES) override
+		{
+			if (!_observedSubset)
+				return;
+
+			pCVODES->SetObservedStates(std::vector<int>(1, 1));
+			pCVODES->SetObservedSensitivityParameters(std::vector<int>(1, 1));
+		}
+
+		static bool IsObserved(int m)
+		{
+			//y1, dy1/dP2
+			return (m == 1) || (m == 5);
+		}
+
+		//[0]: all outputs (PerformSolverStep), [1]: subset (PerformSolverStep), [2]: subset (PerformSolverStepContiguous)
+		virtual void Because() override
+		{
+			int outputFunctions[] = { _performSolverStep, _performSolverStep, _performSolverStepContiguous };
+
+			_results = gcnew array<int>(3);
+			_values = gcnew array<array<double>^>(3);
+
+			for (int run = 0; run < 3; run++)
+			{
+				std::vector<double> values, quadratures;
+
+				_observedSubset = (run > 0);
+				_results[run] = Solve(outputFunctions[run], values, quadratures);
+				_values[run] = ToArray(values);
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_write_the_observed_outputs_of_the_full_solution()
+		{
+			const double relTol = 1e-10;
+
+			for (int run = 0; run < 3; run++)
+				BDDExtensions::ShouldBeEqualTo(_results[run], 0);
+
+			for (int k = 0; k < _numberOfOutputTimes; k++)
+			{
+				for (int m = 0; m < _numberOfValues; m++)
+				{
+					if (!IsObserved(m))
+						continue;
+
+					int index = k * _numberOfValues + m;
+					BDDExtensions::ShouldBeEqualTo(_values[1][index], _values[0][index], relTol);
+					BDDExtensions::ShouldBeEqualTo(_values[2][index], _values[0][index], relTol);
+				}
+			}
+		}
+
+		[TestAttribute]
+		void should_not_write_the_outputs_not_observed()
+		{
+			for (int k = 0; k < _numberOfOutputTimes; k++)
+			{
+				for (int m = 0; m < _numberOfValues; m++)
+				{
+					if (IsObserved(m))
+						continue;
+
+					int index = k * _numberOfValues + m;
+					BDDExtensions::ShouldBeEqualTo(_values[0][index] != _notWritten, true);
+					BDDExtensions::ShouldBeEqualTo(_values[1][index], _notWritten);
+					BDDExtensions::ShouldBeEqualTo(_values[2][index], _notWritten);
+				}
+			}
+		}
+
+	};
+
+	//stop times 0.6 and 1.3 between the output times: each output time is reached by repeated PerformSolverStep calls
+	public ref class when_stopping_at_known_event_times : public concern_for_solver_output
+	{
+	protected:
+		static const int _numberOfStopTimes = 2;
+
+		int _fullResult;
+		int _CVODE_Result;
+		array<double>^ _fullValues;
+		array<double>^ _values;
+		array<double>^ _stopTimes;
+		array<double>^ _stopTimesReached;
+		array<double>^ _stopTimeValues;
+
+		virtual void Because() override
+		{
+			std::vector<double> fullValues, quadratures;
+			_fullResult = Solve(_performSolverStep, fullValues, quadratures);
+			_fullValues = ToArray(fullValues);
+
+			std::vector<double> stopTimes;
+			stopTimes.push_back(0.6);
+			stopTimes.push_back(1.3);
+
+			std::vector<double> values(_numberOfOutputTimes * _numberOfValues), stopTimesReached, stopTimeValues;
+
+			try
+			{
+				SimModelSolver_CVODES * pCVODES = dynamic_cast<SimModelSolver_CVODES *>(CreateSolver());
+
+				pCVODES->SetAbsTol(1e-12);
+				pCVODES->SetRelTol(1e-9);
+				pCVODES->SetInitialTime(0.0);
+				std::vector<double> y0;
+				y0.push_back(2.0);
+				y0.push_back(0.0);
+				pCVODES->SetInitialValues(y0);
+
+				pCVODES->SetNumberOfSensitivityParameters(2);
+				pCVODES->SetSensitivityParametersInitialValues(std::vector<double>(2, 1.0));
+				pCVODES->SetStopTimes(stopTimes);
+
+				pCVODES->Init();
+
+				for (int k = 0; k < _numberOfOutputTimes; k++)
+				{
+					double * y = &values[k * _numberOfValues];
+					double * rows[2] = { y + 2, y + 4 };
+					double tret = 0.0;
+
+					do
+					{
+						_CVODE_Result = pCVODES->PerformSolverStep(OutputTime(k), y, rows, tret, SimModelSolverBase::NORMAL);
+
+						if (_CVODE_Result == CV_TSTOP_RETURN)
+						{
+							stopTimesReached.push_back(tret);
+							stopTimeValues.insert(stopTimeValues.end(), y, y + _numberOfValues);
+						}
+					} while ((_CVODE_Result == CV_TSTOP_RETURN) && (tret < OutputTime(k)));
+
+					if (_CVODE_Result == CV_TSTOP_RETURN)
+						_CVODE_Result = 0;
+
+					if (_CVODE_Result != 0)
+						break;
+				}
+
+				pCVODES->Terminate();
+			}
+			catch (std::string & str)
+			{
+				ExceptionHelper::ThrowExceptionFrom(str);
+			}
+			catch (SimModelSolverErrorData & ED)
+			{
+				ExceptionHelper::ThrowExceptionFrom(ED);
+			}
+			catch (...)
+			{
+				ExceptionHelper::ThrowExceptionFromUnknown();
+			}
+
+			ReleaseSolver();
+
+			_values = ToArray(values);
+			_stopTimes = ToArray(stopTimes);
+			_stopTimesReached = ToArray(stopTimesReached);
+			_stopTimeValues = ToArray(stopTimeValues);
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_exactly_at_each_stop_time()
+		{
+			BDDExtensions::ShouldBeEqualTo(_CVODE_Result, 0);
+			BDDExtensions::ShouldBeEqualTo(_stopTimesReached->Length, _numberOfStopTimes);
+
+			for (int s = 0; s < _numberOfStopTimes; s++)
+				BDDExtensions::ShouldBeEqualTo(_stopTimesReached[s], _stopTimes[s]);
+		}
+
+		[TestAttribute]
+		void should_return_the_analytical_solution_at_the_stop_times()
+		{
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			std::vector<double> expectedValues(_numberOfValues);
+			for (int s = 0; s < _stopTimesReached->Length; s++)
+			{
+				AnalyticalSolution(_stopTimes[s], &expectedValues[0]);
+
+				for (int m = 0; m < _numberOfValues; m++)
+					BDDExtensions::ShouldBeEqualTo(_stopTimeValues[s * _numberOfValues + m], expectedValues[m], relTol);
+			}
+		}
+
+		[TestAttribute]
+		void should_return_the_output_of_the_solution_without_stop_times()
+		{
+			BDDExtensions::ShouldBeEqualTo(_fullResult, 0);
+
+			const double relTol = 1e-6; //max. allowed relative deviation 0.0001%
+
+			for (int k = 0; k < _fullValues->Length; k++)
+				BDDExtensions::ShouldBeEqualTo(_values[k], _fullValues[k], relTol);
+		}
+
+	};
+
+	public ref class when_integrating_the_auc_as_quadrature : public concern_for_solver_output
+	{
+	protected:
+		bool _withQuadrature;
+
+		//run 1: quadrature included in the local error test
+		int _run;
+
+		int _fullResult;
+		array<int>^ _results;
+		array<double>^ _fullValues;
+		array<array<double>^>^ _values;
+		array<array<double>^>^ _quadratures;
+
+		virtual TestSolverCallerBase * CreateSolverCaller() override
+		{
+			if (_withQuadrature)
+				return new TestSolverCallerWithParametersAndQuadrature();
+
+			return new TestSolverCallerWithParameters();
+		}
+
+		virtual void SetSolverOptions(SimModelSolver_CVODES * pCVODES) override
+		{
+			pCVODES->SetOption("QuadratureErrorControl", _run);
+		}
+
+		//full solution without quadrature; [0]: quadrature without, [1]: with error control
+		virtual void Because() override
+		{
+			std::vector<double> values, quadratures;
+
+			_run = 0;
+			_withQuadrature = false;
+			_fullResult = Solve(_performSolverStep, values, quadratures);
+			_fullValues = ToArray(values);
+
+			_results = gcnew array<int>(2);
+			_values = gcnew array<array<double>^>(2);
+			_quadratures = gcnew array<array<double>^>(2);
+
+			_withQuadrature = true;
+			for (_run = 0; _run < 2; _run++)
+			{
+				_results[_run] = Solve(_performSolverStep, values, quadratures);
+				_values[_run] = ToArray(values);
+				_quadratures[_run] = ToArray(quadratures);
+			}
+		}
+
+	public:
+
+		[TestAttribute]
+		void should_return_the_analytical_auc()
+		{
+			const double relTol = 1e-5; //max. allowed relative deviation 0.001%
+
+			//P1 = P2 = 1: AUC of y0 = 2*cosh(t) is 2*sinh(t)
+			for (int run = 0; run < 2; run++)
+			{
+				BDDExtensions::ShouldBeEqualTo(_results[run], 0);
+				BDDExtensions::ShouldBeEqualTo(_quadratures[run]->Length, _numberOfOutputTimes);
+
+				for (int k = 0; k < _numberOfOutputTimes; k++)
+					BDDExtensions::ShouldBeEqualTo(_quadratures[run][k], 2.0*sinh(OutputTime(k)), relTol);
+			}
+		}
+
+		[TestAttribute]
+		void should_return_the_states_and_sensitivities_of_the_solution_without_quadrature()
+		{
+			BDDExtensions::ShouldBeEqualTo(_fullResult, 0);
+
+			//without error control the quadrature does not change the steps
+			const double relTol = 1e-10;
+			for (int k = 0; k < _fullValues->Length; k++)
+				BDDExtensions::ShouldBeEqualTo(_values[0][k], _fullValues[k], relTol);
+
+			const double relTolErrorControl = 1e-6; //max. allowed relative deviation 0.0001%
+			for (int k = 0; k < _fullValues->Length; k++)
+				BDDExtensions::ShouldBeEqualTo(_values[1][k], _fullValues[k], relTolErrorControl);
+		}
+
+	};
 
 }
\ No newline at end of file